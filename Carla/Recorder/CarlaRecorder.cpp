@@ -27,6 +27,29 @@
 #include <ctime>
 #include <sstream>
 
+static CarlaRecorderActorDescription MakeRecorderActorDescription(const FActorDescription &ActorDescription)
+{
+  CarlaRecorderActorDescription Description;
+  Description.UId = ActorDescription.UId;
+  Description.Id = ActorDescription.Id;
+
+  // attributes
+  Description.Attributes.reserve(ActorDescription.Variations.Num());
+  for (const auto &item : ActorDescription.Variations)
+  {
+    CarlaRecorderActorAttribute Attr;
+    Attr.Type = static_cast<uint8_t>(item.Value.Type);
+    Attr.Id = item.Value.Id;
+    Attr.Value = item.Value.Value;
+    // check for empty attributes
+    if (!Attr.Id.IsEmpty())
+    {
+      Description.Attributes.emplace_back(std::move(Attr));
+    }
+  }
+  return Description;
+}
+
 ACarlaRecorder::ACarlaRecorder(void)
 {
   PrimaryActorTick.TickGroup = TG_PrePhysics;
@@ -55,6 +78,20 @@ std::string ACarlaRecorder::ShowFileActorsBlocked(std::string Name, double MinTi
   return Query.QueryBlocked(Name, MinTime, MinDistance);
 }
 
+std::string ACarlaRecorder::ExportFile(std::string Name, std::string OutDir)
+{
+  return Query.QueryExport(Name, OutDir);
+}
+
+DReyeVR::BatchResult ACarlaRecorder::QueryFiles(const std::vector<std::string> &Names, const DReyeVR::QueryFilter &Filter)
+{
+  std::vector<std::string> Filenames;
+  Filenames.reserve(Names.size());
+  for (const std::string &Name : Names)
+    Filenames.push_back(GetRecorderFilename(Name));
+  return DReyeVR::BatchQuery::Run(Filenames, Filter);
+}
+
 std::string ACarlaRecorder::ReplayFile(std::string Name, double TimeStart, double Duration,
     uint32_t FollowId, bool ReplaySensors)
 {
@@ -86,7 +123,15 @@ void ACarlaRecorder::Ticking(float DeltaSeconds)
     return;
 
   // check if recording
-  if (Enabled)
+  if (Enabled && bDropFramesWhenBusy && Writer.IsFull())
+  {
+    // the writer thread is behind, fold this tick into the next frame (pending events are kept until then)
+    DroppedFrames++;
+    DroppedSeconds += DeltaSeconds;
+    // but keep the eye samples of this tick so the high-rate gaze stream has no holes
+    AddEyeSamples();
+  }
+  else if (Enabled)
   {
     PlatformTime.UpdateTime();
     const FActorRegistry &Registry = Episode->GetActorRegistry();
@@ -137,7 +182,8 @@ void ACarlaRecorder::Ticking(float DeltaSeconds)
     AddDReyeVRData();
 
     // write all data for this frame
-    Write(DeltaSeconds);
+    Write(DeltaSeconds + DroppedSeconds);
+    DroppedSeconds = 0.0;
   }
   else if (Episode->GetReplayer()->IsEnabled())
   {
@@ -275,10 +321,27 @@ void ACarlaRecorder::AddActorBoundingBox(FCarlaActor *CarlaActor)
   AddBoundingBox(BoundingBox);
 }
 
+void ACarlaRecorder::AddEyeSamples()
+{
+  // all the eye tracker samples taken since the last tick (see AEgoSensor::RunEyeSampler) and the gaze events in them
+  const ADReyeVRSensor *Sensor = ADReyeVRSensor::GetDReyeVRSensor(Episode->GetWorld());
+  if (Sensor != nullptr)
+  {
+    EyeSamples.Add(Sensor->GetData()->GetEyeSamples());
+    GazeEvents.Add(Sensor->GetData()->GetGazeEvents());
+  }
+}
+
 void ACarlaRecorder::AddDReyeVRData()
 {
-  // Add the latest instance of the DReyeVR snapshot to our data
-  DReyeVRAggData.Add(DReyeVRDataRecorder<DReyeVR::AggregateData>(ADReyeVRSensor::Data));
+  // Add the latest DReyeVR snapshot to our data (it does not change until the frame is written in this same tick)
+  const ADReyeVRSensor *Sensor = ADReyeVRSensor::GetDReyeVRSensor(Episode->GetWorld());
+  if (Sensor != nullptr)
+  {
+    DReyeVRAggData.Add(Sensor->GetData());
+    Attention.Set(Sensor->GetData()->GetAttention());
+  }
+  AddEyeSamples();
 
   TArray<AActor *> FoundActors;
   if (Episode != nullptr && Episode->GetWorld() != nullptr)
@@ -290,7 +353,7 @@ void ACarlaRecorder::AddDReyeVRData()
     ADReyeVRCustomActor *CustomActor = Cast<ADReyeVRCustomActor>(A);
     if (CustomActor != nullptr && CustomActor->IsActive())
     {
-      DReyeVRCustomActorData.Add(DReyeVRDataRecorder<DReyeVR::CustomActorData>(&(CustomActor->GetInternals())));
+      DReyeVRCustomActorData.Add(&(CustomActor->GetInternals()));
     }
   }
 }
@@ -347,6 +410,7 @@ void ACarlaRecorder::AddWeather(const FWeatherParameters& WeatherParams)
   CarlaRecorderWeather Weather;
   Weather.Params = WeatherParams;
   Weathers.Add(Weather);
+  FrameFlags |= DReyeVR::FRAME_HAS_WEATHER;
 }
 
 std::string ACarlaRecorder::Start(std::string Name, FString MapName, bool AdditionalData)
@@ -364,12 +428,13 @@ std::string ACarlaRecorder::Start(std::string Name, FString MapName, bool Additi
   // get the final path + filename
   std::string Filename = GetRecorderFilename(Name);
 
-  // binary file
-  File.open(Filename, std::ios::binary);
-  if (!File.is_open())
+  // binary file (written asynchronously, the recorder only serializes to memory)
+  if (!Writer.Open(Filename, File))
   {
     return "";
   }
+  DroppedFrames = 0;
+  DroppedSeconds = 0.0;
 
   // save info
   Info.Version = 1;
@@ -381,6 +446,13 @@ std::string ACarlaRecorder::Start(std::string Name, FString MapName, bool Additi
   Info.Write(File);
 
   Frames.Reset();
+  FrameIndex.Reset();
+  FrameFlags = DReyeVR::FRAME_NONE;
+  TimeSinceKeyframe = 0.0;
+  bCompact = bCompactMode;
+  bFirstFrame = true;
+  PositionEncoder.Reset();
+  DataEncoder.Reset();
   PlatformTime.SetStartTime();
 
   Enable();
@@ -400,9 +472,22 @@ void ACarlaRecorder::Stop(void)
 {
   Disable();
 
-  if (File)
+  if (Writer.IsOpen())
   {
-    File.close();
+    // append the frame index after the last frame so the replayer can seek without scanning
+    FrameIndex.Write(File);
+    FrameIndex.Reset();
+    Writer.Close(File);
+
+    if (DroppedFrames > 0 || Writer.GetStalls() > 0)
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Recorder writer could not keep up: %d frames dropped, %llu frames stalled"),
+          DroppedFrames, Writer.GetStalls());
+    }
+    if (Writer.HasFailed())
+    {
+      UE_LOG(LogCarla, Error, TEXT("Recorder failed writing to disk, the recording is incomplete!"));
+    }
   }
 
   Clear();
@@ -415,6 +500,7 @@ void ACarlaRecorder::Clear(void)
   EventsParent.Clear();
   Collisions.Clear();
   Positions.Clear();
+  CompactPositions.clear();
   States.Clear();
   Vehicles.Clear();
   Walkers.Clear();
@@ -427,17 +513,46 @@ void ACarlaRecorder::Clear(void)
   TrafficLightTimes.Clear();
   DReyeVRAggData.Clear();
   DReyeVRCustomActorData.Clear();
+  EyeSamples.Clear();
+  Attention.Clear();
+  GazeEvents.Clear();
   Weathers.Clear();
 }
 
 void ACarlaRecorder::Write(double DeltaSeconds)
 {
+  // keyframes are only taken on frames without events/weather so they hold for the whole frame
+  TimeSinceKeyframe += DeltaSeconds;
+  const bool bWriteKeyframe = (KeyframeInterval > 0.0 && TimeSinceKeyframe >= KeyframeInterval &&
+                               !(FrameFlags & (DReyeVR::FRAME_HAS_EVENTS | DReyeVR::FRAME_HAS_WEATHER)));
+  if (bWriteKeyframe)
+  {
+    AddKeyframe();
+    FrameFlags |= DReyeVR::FRAME_KEYFRAME;
+    TimeSinceKeyframe = 0.0;
+  }
+  // in compact mode keyframes (and the very first frame) are intra-coded, everything else depends on the last frame
+  const bool bIntra = bWriteKeyframe || bFirstFrame;
+  bFirstFrame = false;
+  if (bCompact && !bIntra)
+    FrameFlags |= DReyeVR::FRAME_DELTA;
+
   // update this frame data
   Frames.SetFrame(DeltaSeconds);
+  const uint64_t FrameOffset = static_cast<uint64_t>(File.tellp());
+  FrameIndex.AddFrame(DeltaSeconds, FrameOffset, FrameFlags);
+  FrameFlags = DReyeVR::FRAME_NONE;
 
   // start
   Frames.WriteStart(File);
 
+  // full-state snapshot (must come before anything else in the frame)
+  if (bWriteKeyframe)
+  {
+    Keyframe.Write(File);
+    Keyframe.Clear();
+  }
+
   // events
   EventsAdd.Write(File);
   EventsDel.Write(File);
@@ -445,7 +560,10 @@ void ACarlaRecorder::Write(double DeltaSeconds)
   Collisions.Write(File);
 
   // positions and states
-  Positions.Write(File);
+  if (bCompact)
+    PositionEncoder.Write(CompactPositions, bIntra, File);
+  else
+    Positions.Write(File);
   States.Write(File);
 
   // animations
@@ -465,7 +583,26 @@ void ACarlaRecorder::Write(double DeltaSeconds)
     TrafficLightTimes.Write(File);
   }
   // custom DReyeVR data
-  DReyeVRAggData.Write(File);
+  if (bCompact)
+  {
+    DataWriter.Clear();
+    DReyeVRAggData.Write(DataWriter);
+    DataEncoder.Write(DataWriter.GetBytes(), bIntra, File);
+  }
+  else
+    DReyeVRAggData.Write(File);
+
+  // every eye tracker sample of this frame (the DReyeVR packet only holds the latest one)
+  if (!EyeSamples.IsEmpty())
+    EyeSamples.Write(File);
+
+  // attention weights of the gaze cone (if enabled and anything was in it)
+  if (!Attention.IsEmpty())
+    Attention.Write(File);
+
+  // fixations/saccades detected in the eye samples of this frame
+  if (!GazeEvents.IsEmpty())
+    GazeEvents.Write(File);
 
   // custom DReyeVR Actor data write
   DReyeVRCustomActorData.Write(File);
@@ -476,6 +613,9 @@ void ACarlaRecorder::Write(double DeltaSeconds)
   // end
   Frames.WriteEnd(File);
 
+  // everything before this frame is final now (this frame's duration gets patched by the next FrameStart)
+  Writer.Commit(FrameOffset);
+
   Clear();
 }
 
@@ -483,7 +623,10 @@ void ACarlaRecorder::AddPosition(const CarlaRecorderPosition &Position)
 {
   if (Enabled)
   {
-    Positions.Add(Position);
+    if (bCompact)
+      CompactPositions.push_back(Position);
+    else
+      Positions.Add(Position);
   }
 }
 
@@ -492,6 +635,7 @@ void ACarlaRecorder::AddEvent(const CarlaRecorderEventAdd &Event)
   if (Enabled)
   {
     EventsAdd.Add(std::move(Event));
+    FrameFlags |= DReyeVR::FRAME_HAS_EVENTS;
   }
 }
 
@@ -500,6 +644,7 @@ void ACarlaRecorder::AddEvent(const CarlaRecorderEventDel &Event)
   if (Enabled)
   {
     EventsDel.Add(std::move(Event));
+    FrameFlags |= DReyeVR::FRAME_HAS_EVENTS;
   }
 }
 
@@ -508,6 +653,7 @@ void ACarlaRecorder::AddEvent(const CarlaRecorderEventParent &Event)
   if (Enabled)
   {
     EventsParent.Add(std::move(Event));
+    FrameFlags |= DReyeVR::FRAME_HAS_EVENTS;
   }
 }
 
@@ -653,6 +799,64 @@ void ACarlaRecorder::AddExistingActors(void)
 
 }
 
+void ACarlaRecorder::AddKeyframe()
+{
+  Keyframe.Clear();
+
+  // snapshot of all the live actors (same as what AddExistingActors records on the first frame)
+  const FActorRegistry &Registry = Episode->GetActorRegistry();
+  for (auto It = Registry.begin(); It != Registry.end(); ++It)
+  {
+    const FCarlaActor* CarlaActor = It.Value().Get();
+    if (CarlaActor == nullptr)
+      continue;
+
+    const FTransform Transform = CarlaActor->GetActorGlobalTransform();
+    Keyframe.Actors.emplace_back(CarlaRecorderEventAdd
+    {
+      CarlaActor->GetActorId(),
+      static_cast<uint8_t>(CarlaActor->GetActorType()),
+      Transform.GetTranslation(),
+      Transform.GetRotation().Euler(),
+      MakeRecorderActorDescription(CarlaActor->GetActorInfo()->Description)
+    });
+
+    if (CarlaActor->GetParent() != 0)
+    {
+      Keyframe.Parents.emplace_back(CarlaRecorderEventParent
+      {
+        CarlaActor->GetActorId(),
+        CarlaActor->GetParent()
+      });
+    }
+  }
+
+  UWorld *World = GetWorld();
+  if (World)
+  {
+    UCarlaLightSubsystem* CarlaLightSubsystem = World->GetSubsystem<UCarlaLightSubsystem>();
+    for (const auto& LightPair : CarlaLightSubsystem->GetLights())
+    {
+      const UCarlaLight* Light = LightPair.Value;
+      Keyframe.Lights.emplace_back(CarlaRecorderLightScene
+      {
+        Light->GetId(),
+        Light->GetLightIntensity(),
+        Light->GetLightColor(),
+        Light->GetLightOn(),
+        static_cast<uint8>(Light->GetLightType())
+      });
+    }
+  }
+
+  AWeather *Weather = AWeather::FindWeatherInstance(Episode->GetWorld());
+  if (Weather)
+  {
+    Keyframe.bHasWeather = true;
+    Keyframe.Weather.Params = Weather->GetCurrentWeather();
+  }
+}
+
 void ACarlaRecorder::AddStartingWeather(void)
 {
   AWeather *Weather = AWeather::FindWeatherInstance(Episode->GetWorld());
@@ -668,25 +872,6 @@ void ACarlaRecorder::CreateRecorderEventAdd(
     const FTransform &Transform,
     FActorDescription ActorDescription)
 {
-  CarlaRecorderActorDescription Description;
-  Description.UId = ActorDescription.UId;
-  Description.Id = ActorDescription.Id;
-
-  // attributes
-  Description.Attributes.reserve(ActorDescription.Variations.Num());
-  for (const auto &item : ActorDescription.Variations)
-  {
-    CarlaRecorderActorAttribute Attr;
-    Attr.Type = static_cast<uint8_t>(item.Value.Type);
-    Attr.Id = item.Value.Id;
-    Attr.Value = item.Value.Value;
-    // check for empty attributes
-    if (!Attr.Id.IsEmpty())
-    {
-      Description.Attributes.emplace_back(std::move(Attr));
-    }
-  }
-
   // recorder event
   CarlaRecorderEventAdd RecEvent
   {
@@ -694,7 +879,7 @@ void ACarlaRecorder::CreateRecorderEventAdd(
     Type,
     Transform.GetTranslation(),
     Transform.GetRotation().Euler(),
-    std::move(Description)
+    MakeRecorderActorDescription(ActorDescription)
   };
   AddEvent(std::move(RecEvent));
 
@@ -34,6 +34,15 @@
 
 // DReyeVR includes
 #include "DReyeVRRecorder.h"
+#include "DReyeVRAsyncWriter.h"
+#include "DReyeVRAttention.h"
+#include "DReyeVRBinaryIO.h"
+#include "DReyeVRBatchQuery.h"
+#include "DReyeVRCompact.h"
+#include "DReyeVREyeSamples.h"
+#include "DReyeVRGazeEvents.h"
+#include "DReyeVRFrameIndex.h"
+#include "DReyeVRKeyframe.h"
 #include "Carla/Sensor/DReyeVRData.h"
 
 #include "CarlaRecorder.generated.h"
@@ -70,8 +79,15 @@ enum class CarlaRecorderPacketId : uint8_t
   TriggerVolume,
   Weather,
   // "We suggest to use id over 100 for user custom packets, because this list will keep growing in the future"
-  DReyeVR = DREYEVR_PACKET_ID,                        // our custom DReyeVR packet (for raw sensor data)
-  DReyeVRCustomActor = DREYEVR_CUSTOM_ACTOR_PACKET_ID // custom DReyeVR actors (not raw sensor data)
+  DReyeVR = DREYEVR_PACKET_ID,                         // our custom DReyeVR packet (for raw sensor data)
+  DReyeVRCustomActor = DREYEVR_CUSTOM_ACTOR_PACKET_ID, // custom DReyeVR actors (not raw sensor data)
+  DReyeVRFrameIndex = DREYEVR_FRAME_INDEX_PACKET_ID,   // frame index written once at the end of the file
+  DReyeVRKeyframe = DREYEVR_KEYFRAME_PACKET_ID,        // periodic full-state snapshot for random access
+  DReyeVREyeSamples = DREYEVR_EYE_SAMPLES_PACKET_ID,   // all the eye tracker samples of a frame
+  DReyeVRCompactPositions = DREYEVR_COMPACT_POSITIONS_PACKET_ID, // delta/quantized positions (compact mode)
+  DReyeVRCompactData = DREYEVR_COMPACT_DATA_PACKET_ID,           // delta-coded DReyeVR packet (compact mode)
+  DReyeVRAttention = DREYEVR_ATTENTION_PACKET_ID,                // per-actor attention weights of the gaze cone
+  DReyeVRGazeEvents = DREYEVR_GAZE_EVENTS_PACKET_ID              // fixations/saccades detected on the eye samples
 };
 
 /// Recorder for the simulation
@@ -136,6 +152,24 @@ public:
 
   void AddWeather(const FWeatherParameters& WeatherParams);
 
+  // seconds between full-state keyframes (0 to disable)
+  void SetKeyframeInterval(double Interval)
+  {
+    KeyframeInterval = Interval;
+  }
+
+  // skip recording ticks (instead of blocking the game thread) when the writer thread falls behind
+  void SetDropFramesWhenBusy(bool bDrop)
+  {
+    bDropFramesWhenBusy = bDrop;
+  }
+
+  // delta-code & quantize the positions and DReyeVR data (see DReyeVRCompact.h), takes effect on the next Start
+  void SetCompactMode(bool bCompact)
+  {
+    bCompactMode = bCompact;
+  }
+
   // set episode
   void SetEpisode(UCarlaEpisode *ThisEpisode)
   {
@@ -159,6 +193,9 @@ public:
   std::string ShowFileInfo(std::string Name, bool bShowAll = false);
   std::string ShowFileCollisions(std::string Name, char Type1, char Type2);
   std::string ShowFileActorsBlocked(std::string Name, double MinTime = 30, double MinDistance = 10);
+  std::string ExportFile(std::string Name, std::string OutDir = "");
+  // structured collisions/blocked actors/statistics of many recordings at once (scanned in parallel)
+  DReyeVR::BatchResult QueryFiles(const std::vector<std::string> &Names, const DReyeVR::QueryFilter &Filter);
 
   // replayer
   std::string ReplayFile(std::string Name, double TimeStart, double Duration,
@@ -178,8 +215,12 @@ private:
 
   uint32_t NextCollisionId = 0;
 
-  // files
+  // files (File only serializes to memory, Writer does the actual disk I/O on its own thread)
   std::ofstream File;
+  DReyeVR::AsyncWriter Writer;
+  bool bDropFramesWhenBusy = false;
+  int DroppedFrames = 0;
+  double DroppedSeconds = 0.0;
 
   UCarlaEpisode *Episode = nullptr;
 
@@ -205,6 +246,27 @@ private:
   CarlaRecorderWeathers Weathers;
   DReyeVRDataRecorders<DReyeVR::AggregateData, DREYEVR_PACKET_ID> DReyeVRAggData;
   DReyeVRDataRecorders<DReyeVR::CustomActorData, DREYEVR_CUSTOM_ACTOR_PACKET_ID> DReyeVRCustomActorData;
+  DReyeVR::EyeSampleRecorder EyeSamples;
+  DReyeVR::AttentionRecorder Attention;
+  DReyeVR::GazeEventRecorder GazeEvents;
+
+  // frame index (written as a trailer on Stop) and the flags of the frame currently being recorded
+  DReyeVR::FrameIndex FrameIndex;
+  uint8_t FrameFlags = DReyeVR::FRAME_NONE;
+
+  // periodic keyframes
+  DReyeVR::Keyframe Keyframe;
+  double KeyframeInterval = 0.0;
+  double TimeSinceKeyframe = 0.0;
+
+  // compact mode
+  bool bCompactMode = false;
+  bool bCompact = false; // mode of the recording in progress
+  bool bFirstFrame = true;
+  std::vector<CarlaRecorderPosition> CompactPositions;
+  DReyeVR::CompactPositionEncoder PositionEncoder;
+  DReyeVR::CompactDataEncoder DataEncoder;
+  DReyeVR::BinaryWriter DataWriter;
 
   // replayer
   CarlaReplayer Replayer;
@@ -222,4 +284,6 @@ private:
   void AddActorKinematics(FCarlaActor *CarlaActor);
   void AddActorBoundingBox(FCarlaActor *CarlaActor);
   void AddDReyeVRData();
+  void AddEyeSamples();
+  void AddKeyframe();
 };
@@ -8,9 +8,11 @@
 
 #include "UnrealString.h"
 #include "CarlaRecorderHelpers.h"
+#include "DReyeVRMappedFile.h"
 
 // create a temporal buffer to convert from and to FString and bytes
-static std::vector<uint8_t> CarlaRecorderHelperBuffer;
+// (one per thread, the batch queries read recordings on several worker threads at once)
+static thread_local std::vector<uint8_t> CarlaRecorderHelperBuffer;
 
 // get the final path + filename
 std::string GetRecorderFilename(std::string Filename)
@@ -33,36 +35,81 @@ std::string GetRecorderFilename(std::string Filename)
 // write
 // ------
 
+// the same layout is written to the file and to memory
+template <typename OutT>
+static void WriteFVectorImpl(OutT &Out, const FVector &InObj)
+{
+  WriteValue<float>(Out, InObj.X);
+  WriteValue<float>(Out, InObj.Y);
+  WriteValue<float>(Out, InObj.Z);
+}
+
+template <typename OutT>
+static void WriteFRotatorImpl(OutT &Out, const FRotator &InObj)
+{
+  WriteValue<float>(Out, InObj.Pitch);
+  WriteValue<float>(Out, InObj.Roll);
+  WriteValue<float>(Out, InObj.Yaw);
+}
+
+template <typename OutT>
+static void WriteFVector2DImpl(OutT &Out, const FVector2D &InObj)
+{
+  WriteValue<float>(Out, InObj.X);
+  WriteValue<float>(Out, InObj.Y);
+}
+
+template <typename OutT>
+static void WriteFLinearColorImpl(OutT &Out, const FLinearColor &InObj)
+{
+  WriteValue<float>(Out, InObj.A);
+  WriteValue<float>(Out, InObj.B);
+  WriteValue<float>(Out, InObj.G);
+  WriteValue<float>(Out, InObj.R);
+}
+
 // write binary data from FVector
 void WriteFVector(std::ofstream &OutFile, const FVector &InObj)
 {
-  WriteValue<float>(OutFile, InObj.X);
-  WriteValue<float>(OutFile, InObj.Y);
-  WriteValue<float>(OutFile, InObj.Z);
+  WriteFVectorImpl(OutFile, InObj);
+}
+
+void WriteFVector(DReyeVR::BinaryWriter &Out, const FVector &InObj)
+{
+  WriteFVectorImpl(Out, InObj);
 }
 
 // write binary data from FRotator
 void WriteFRotator(std::ofstream &OutFile, const FRotator &InObj)
 {
-  WriteValue<float>(OutFile, InObj.Pitch);
-  WriteValue<float>(OutFile, InObj.Roll);
-  WriteValue<float>(OutFile, InObj.Yaw);
+  WriteFRotatorImpl(OutFile, InObj);
+}
+
+void WriteFRotator(DReyeVR::BinaryWriter &Out, const FRotator &InObj)
+{
+  WriteFRotatorImpl(Out, InObj);
 }
 
 // write binary data from FVector2D
 void WriteFVector2D(std::ofstream &OutFile, const FVector2D &InObj)
 {
-  WriteValue<float>(OutFile, InObj.X);
-  WriteValue<float>(OutFile, InObj.Y);
+  WriteFVector2DImpl(OutFile, InObj);
+}
+
+void WriteFVector2D(DReyeVR::BinaryWriter &Out, const FVector2D &InObj)
+{
+  WriteFVector2DImpl(Out, InObj);
 }
 
 // write binary data to FLinearColor
-void WriteFLinearColor(std::ofstream &InFile, const FLinearColor &InObj)
+void WriteFLinearColor(std::ofstream &OutFile, const FLinearColor &InObj)
 {
-  WriteValue<float>(InFile, InObj.A);
-  WriteValue<float>(InFile, InObj.B);
-  WriteValue<float>(InFile, InObj.G);
-  WriteValue<float>(InFile, InObj.R);
+  WriteFLinearColorImpl(OutFile, InObj);
+}
+
+void WriteFLinearColor(DReyeVR::BinaryWriter &Out, const FLinearColor &InObj)
+{
+  WriteFLinearColorImpl(Out, InObj);
 }
 
 // write binary data from FTransform
@@ -82,40 +129,92 @@ void WriteFString(std::ofstream &OutFile, const FString &InObj)
   OutFile.write(reinterpret_cast<char *>(TCHAR_TO_UTF8(*InObj)), Length);
 }
 
+void WriteFString(DReyeVR::BinaryWriter &Out, const FString &InObj)
+{
+  FTCHARToUTF8 EncodedString(*InObj);
+  const uint16_t Length = static_cast<uint16_t>(EncodedString.Length());
+  WriteValue<uint16_t>(Out, Length);
+  Out.WriteBytes(EncodedString.Get(), Length);
+}
+
 // -----
 // read
 // -----
 
+template <typename InT>
+static void ReadFVectorImpl(InT &In, FVector &OutObj)
+{
+  ReadValue<float>(In, OutObj.X);
+  ReadValue<float>(In, OutObj.Y);
+  ReadValue<float>(In, OutObj.Z);
+}
+
+template <typename InT>
+static void ReadFRotatorImpl(InT &In, FRotator &OutObj)
+{
+  ReadValue<float>(In, OutObj.Pitch);
+  ReadValue<float>(In, OutObj.Roll);
+  ReadValue<float>(In, OutObj.Yaw);
+}
+
+template <typename InT>
+static void ReadFVector2DImpl(InT &In, FVector2D &OutObj)
+{
+  ReadValue<float>(In, OutObj.X);
+  ReadValue<float>(In, OutObj.Y);
+}
+
+template <typename InT>
+static void ReadFLinearColorImpl(InT &In, FLinearColor &OutObj)
+{
+  ReadValue<float>(In, OutObj.A);
+  ReadValue<float>(In, OutObj.B);
+  ReadValue<float>(In, OutObj.G);
+  ReadValue<float>(In, OutObj.R);
+}
+
 // read binary data to FVector
 void ReadFVector(std::ifstream &InFile, FVector &OutObj)
 {
-  ReadValue<float>(InFile, OutObj.X);
-  ReadValue<float>(InFile, OutObj.Y);
-  ReadValue<float>(InFile, OutObj.Z);
+  ReadFVectorImpl(InFile, OutObj);
+}
+
+void ReadFVector(DReyeVR::BinaryReader &In, FVector &OutObj)
+{
+  ReadFVectorImpl(In, OutObj);
 }
 
 // read binary data to FRotator
 void ReadFRotator(std::ifstream &InFile, FRotator &OutObj)
 {
-  ReadValue<float>(InFile, OutObj.Pitch);
-  ReadValue<float>(InFile, OutObj.Roll);
-  ReadValue<float>(InFile, OutObj.Yaw);
+  ReadFRotatorImpl(InFile, OutObj);
+}
+
+void ReadFRotator(DReyeVR::BinaryReader &In, FRotator &OutObj)
+{
+  ReadFRotatorImpl(In, OutObj);
 }
 
 // read binary data to FVector2D
 void ReadFVector2D(std::ifstream &InFile, FVector2D &OutObj)
 {
-  ReadValue<float>(InFile, OutObj.X);
-  ReadValue<float>(InFile, OutObj.Y);
+  ReadFVector2DImpl(InFile, OutObj);
+}
+
+void ReadFVector2D(DReyeVR::BinaryReader &In, FVector2D &OutObj)
+{
+  ReadFVector2DImpl(In, OutObj);
 }
 
 // read binary data to FLinearColor
 void ReadFLinearColor(std::ifstream &InFile, FLinearColor &OutObj)
 {
-  ReadValue<float>(InFile, OutObj.A);
-  ReadValue<float>(InFile, OutObj.B);
-  ReadValue<float>(InFile, OutObj.G);
-  ReadValue<float>(InFile, OutObj.R);
+  ReadFLinearColorImpl(InFile, OutObj);
+}
+
+void ReadFLinearColor(DReyeVR::BinaryReader &In, FLinearColor &OutObj)
+{
+  ReadFLinearColorImpl(In, OutObj);
 }
 
 // read binary data to FTransform
@@ -132,6 +231,14 @@ void ReadFString(std::ifstream &InFile, FString &OutObj)
 {
   uint16_t Length;
   ReadValue<uint16_t>(InFile, Length);
+  // decode straight from the mapped file if possible (no intermediate buffer)
+  const char *View = DReyeVR::ReadView(InFile, Length);
+  if (View != nullptr)
+  {
+    FUTF8ToTCHAR Converted(View, Length);
+    OutObj = FString(Converted.Length(), Converted.Get());
+    return;
+  }
   // make room in vector buffer
   if (CarlaRecorderHelperBuffer.capacity() < Length + 1)
   {
@@ -145,3 +252,18 @@ void ReadFString(std::ifstream &InFile, FString &OutObj)
   // convert from UTF8 to FString
   OutObj = FString(UTF8_TO_TCHAR(CarlaRecorderHelperBuffer.data()));
 }
+
+void ReadFString(DReyeVR::BinaryReader &In, FString &OutObj)
+{
+  uint16_t Length = 0;
+  ReadValue<uint16_t>(In, Length);
+  // decoded in place, the reader already points at the bytes
+  const char *View = In.View(Length);
+  if (View == nullptr)
+  {
+    OutObj.Empty();
+    return;
+  }
+  FUTF8ToTCHAR Converted(View, Length);
+  OutObj = FString(Converted.Length(), Converted.Get());
+}
@@ -6,9 +6,13 @@
 
 #pragma once
 
+#include <cstring>
 #include <fstream>
+#include <type_traits>
 #include <vector>
 
+#include "DReyeVRBinaryIO.h"
+
 // get the final path + filename
 std::string GetRecorderFilename(std::string Filename);
 
@@ -27,6 +31,12 @@ template <typename T>
 void WriteStdVector(std::ofstream &OutFile, const std::vector<T> &InVec)
 {
   WriteValue<uint32_t>(OutFile, InVec.size());
+  if (std::is_trivially_copyable<T>::value)
+  {
+    // all at once
+    OutFile.write(reinterpret_cast<const char *>(InVec.data()), InVec.size() * sizeof(T));
+    return;
+  }
   for (const auto& InObj : InVec)
   {
     WriteValue<T>(OutFile, InObj);
@@ -37,6 +47,12 @@ template <typename T>
 void WriteTArray(std::ofstream &OutFile, const TArray<T> &InVec)
 {
   WriteValue<uint32_t>(OutFile, InVec.Num());
+  if (std::is_trivially_copyable<T>::value)
+  {
+    // all at once
+    OutFile.write(reinterpret_cast<const char *>(InVec.GetData()), InVec.Num() * sizeof(T));
+    return;
+  }
   for (const auto& InObj : InVec)
   {
     WriteValue<T>(OutFile, InObj);
@@ -77,6 +93,13 @@ void ReadStdVector(std::ifstream &InFile, std::vector<T> &OutVec)
   uint32_t VecSize;
   ReadValue<uint32_t>(InFile, VecSize);
   OutVec.clear();
+  if (std::is_trivially_copyable<T>::value)
+  {
+    // all at once
+    OutVec.resize(VecSize);
+    InFile.read(reinterpret_cast<char *>(OutVec.data()), VecSize * sizeof(T));
+    return;
+  }
   for (uint32_t i = 0; i < VecSize; ++i)
   {
     T InObj;
@@ -91,6 +114,13 @@ void ReadTArray(std::ifstream &InFile, TArray<T> &OutVec)
   uint32_t VecSize;
   ReadValue<uint32_t>(InFile, VecSize);
   OutVec.Empty();
+  if (std::is_trivially_copyable<T>::value)
+  {
+    // all at once
+    OutVec.SetNumUninitialized(VecSize);
+    InFile.read(reinterpret_cast<char *>(OutVec.GetData()), VecSize * sizeof(T));
+    return;
+  }
   for (uint32_t i = 0; i < VecSize; ++i)
   {
     T InObj;
@@ -116,3 +146,70 @@ void ReadFLinearColor(std::ifstream &OutFile, FLinearColor &OutObj);
 // void ReadTransform(std::ifstream &InFile, FTransform &OutObj);
 // read binary data from FString (length + text)
 void ReadFString(std::ifstream &InFile, FString &OutObj);
+
+// ------------------------------------------------------
+// same for the in-memory writer/reader (DReyeVRBinaryIO)
+// ------------------------------------------------------
+
+template <typename T>
+void WriteValue(DReyeVR::BinaryWriter &Out, const T &InObj)
+{
+  Out.Write<T>(InObj);
+}
+
+template <typename T>
+void WriteStdVector(DReyeVR::BinaryWriter &Out, const std::vector<T> &InVec)
+{
+  WriteValue<uint32_t>(Out, InVec.size());
+  Out.WriteArray<T>(InVec.data(), InVec.size());
+}
+
+template <typename T>
+void WriteTArray(DReyeVR::BinaryWriter &Out, const TArray<T> &InVec)
+{
+  WriteValue<uint32_t>(Out, InVec.Num());
+  Out.WriteArray<T>(InVec.GetData(), InVec.Num());
+}
+
+void WriteFVector(DReyeVR::BinaryWriter &Out, const FVector &InObj);
+void WriteFRotator(DReyeVR::BinaryWriter &Out, const FRotator &InObj);
+void WriteFVector2D(DReyeVR::BinaryWriter &Out, const FVector2D &InObj);
+void WriteFLinearColor(DReyeVR::BinaryWriter &Out, const FLinearColor &InObj);
+void WriteFString(DReyeVR::BinaryWriter &Out, const FString &InObj);
+
+template <typename T>
+void ReadValue(DReyeVR::BinaryReader &In, T &OutObj)
+{
+  In.Read<T>(OutObj);
+}
+
+template <typename T>
+void ReadStdVector(DReyeVR::BinaryReader &In, std::vector<T> &OutVec)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "ReadStdVector: T must be trivially copyable");
+  uint32_t VecSize = 0;
+  ReadValue<uint32_t>(In, VecSize);
+  // the count is only trusted if the bytes are actually there
+  const char *Data = In.View(VecSize * sizeof(T));
+  OutVec.resize(Data != nullptr ? VecSize : 0);
+  if (Data != nullptr)
+    std::memcpy(OutVec.data(), Data, VecSize * sizeof(T));
+}
+
+template <typename T>
+void ReadTArray(DReyeVR::BinaryReader &In, TArray<T> &OutVec)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "ReadTArray: T must be trivially copyable");
+  uint32_t VecSize = 0;
+  ReadValue<uint32_t>(In, VecSize);
+  const char *Data = In.View(VecSize * sizeof(T));
+  OutVec.SetNumUninitialized(Data != nullptr ? VecSize : 0);
+  if (Data != nullptr)
+    std::memcpy(OutVec.GetData(), Data, VecSize * sizeof(T));
+}
+
+void ReadFVector(DReyeVR::BinaryReader &In, FVector &OutObj);
+void ReadFRotator(DReyeVR::BinaryReader &In, FRotator &OutObj);
+void ReadFVector2D(DReyeVR::BinaryReader &In, FVector2D &OutObj);
+void ReadFLinearColor(DReyeVR::BinaryReader &In, FLinearColor &OutObj);
+void ReadFString(DReyeVR::BinaryReader &In, FString &OutObj);
@@ -5,6 +5,7 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "CarlaRecorderHelpers.h"
+#include "DReyeVRColumnExport.h"
 
 #include <ctime>
 #include <sstream>
@@ -37,6 +38,8 @@ inline bool CarlaRecorderQuery::CheckFileInfo(std::stringstream &Info)
 {
   // read Info
   RecInfo.Read(File);
+  PositionDecoder.Reset();
+  DataDecoder.Reset();
 
   // check magic string
   if (RecInfo.Magic != "CARLA_RECORDER")
@@ -56,6 +59,61 @@ inline bool CarlaRecorderQuery::CheckFileInfo(std::stringstream &Info)
   return true;
 }
 
+DReyeVR::BinaryReader CarlaRecorderQuery::ReadCompactData(void)
+{
+  DReyeVR::BinaryReader In(DataDecoder.Read(File, Header.Size));
+  // skip the header of the original packet
+  In.Skip(sizeof(char) + sizeof(uint32_t));
+  return In;
+}
+
+void CarlaRecorderQuery::AddGaze(const DReyeVR::AggregateData &Data)
+{
+  // same as the default MaxTraceLenM of the EgoSensor
+  constexpr float MaxGazeDistance = 1000.f * 100.f;
+  const FRotator &Rotation = Data.GetCameraRotationAbs();
+  const FVector Start = Data.GetCameraLocationAbs() + Rotation.RotateVector(Data.GetGazeOrigin());
+  const FVector End = Start + MaxGazeDistance * Rotation.RotateVector(Data.GetGazeDir()).GetSafeNormal();
+  FrameGazes.emplace_back(Start, End);
+}
+
+void CarlaRecorderQuery::AttributeGaze(DReyeVR::ColumnExporter &Exporter)
+{
+  if (!FrameGazes.empty())
+  {
+    // only the actors that moved are updated, so this is cheap even in crowded recordings
+    ActorIndex.BeginUpdate();
+    for (const CarlaRecorderPosition &Pos : FramePositions)
+    {
+      auto Box = ActorBoxes.find(Pos.DatabaseId);
+      if (Box == ActorBoxes.end())
+        continue;
+      ActorIndex.UpdateActor(Pos.DatabaseId, Pos.Location, FQuat::MakeFromEuler(Pos.Rotation),
+          Box->second.BoundingBox.Origin, Box->second.BoundingBox.Extension);
+    }
+    ActorIndex.EndUpdate();
+
+    for (const auto &Gaze : FrameGazes)
+    {
+      // the ego vehicle contains the start of the gaze, so it is skipped
+      DReyeVR::ActorBoxIndex::Hit Hit;
+      if (ActorIndex.Raycast(Gaze.first, Gaze.second, Hit))
+      {
+        auto Type = ActorTypes.find(Hit.Id);
+        Exporter.AddGazeHit(Frame.Id, Frame.Elapsed, Hit.Id, Type != ActorTypes.end() ? Type->second : FString("None"),
+            Hit.Distance, Hit.Location);
+      }
+      else
+      {
+        Exporter.AddGazeHit(Frame.Id, Frame.Elapsed, 0, FString("None"), (Gaze.second - Gaze.first).Size(),
+            Gaze.second);
+      }
+    }
+  }
+  FramePositions.clear();
+  FrameGazes.clear();
+}
+
 std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
 {
   std::stringstream Info;
@@ -64,14 +122,14 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
   std::string Filename2 = GetRecorderFilename(Filename);
 
   // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  if (!Mapped.Open(File, Filename2))
   {
     Info << "File " << Filename2 << " not found on server\n";
     return Info.str();
   }
 
   uint16_t i, Total;
+  const CarlaRecorderPosition *Positions = nullptr;
   bool bFramePrinted = false;
 
   // lambda for repeating task
@@ -194,9 +252,13 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
             bFramePrinted = true;
           }
           Info << " Positions: " << Total << std::endl;
+          Positions = DReyeVR::ReadSpan<CarlaRecorderPosition>(File, Total);
           for (i = 0; i < Total; ++i)
           {
-            Position.Read(File);
+            if (Positions != nullptr)
+              Position = Positions[i];
+            else
+              Position.Read(File);
             Info << "  Id: " << Position.DatabaseId << " Location: (" << Position.Location.X << ", " << Position.Location.Y << ", " << Position.Location.Z << ") Rotation (" <<  Position.Rotation.X << ", " << Position.Rotation.Y << ", " << Position.Rotation.Z << ")" << std::endl;
           }
         }
@@ -204,6 +266,26 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
           SkipPacket();
         break;
 
+      // delta/quantized positions (compact mode)
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVRCompactPositions):
+        if (bShowAll)
+        {
+          PositionDecoder.Read(File, Header.Size, CompactPositions);
+          if (CompactPositions.size() > 0 && !bFramePrinted)
+          {
+            PrintFrame(Info);
+            bFramePrinted = true;
+          }
+          Info << " Positions: " << CompactPositions.size() << std::endl;
+          for (const auto &Pos : CompactPositions)
+          {
+            Info << "  Id: " << Pos.DatabaseId << " Location: (" << Pos.Location.X << ", " << Pos.Location.Y << ", " << Pos.Location.Z << ") Rotation (" <<  Pos.Rotation.X << ", " << Pos.Rotation.Y << ", " << Pos.Rotation.Z << ")" << std::endl;
+          }
+        }
+        else
+          PositionDecoder.Skip(File, Header.Size);
+        break;
+
       // traffic light
       case static_cast<char>(CarlaRecorderPacketId::State):
         if (bShowAll)
@@ -545,7 +627,8 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
         case static_cast<char>(CarlaRecorderPacketId::Weather):
         if (bShowAll)
         {
-          ReadValue<uint16_t>(File, Total);
+          DReyeVR::BinaryReader In = DReyeVR::ReadPacket(File, Header.Size, PacketBuffer);
+          ReadValue<uint16_t>(In, Total);
           if (Total > 0 && !bFramePrinted)
           {
             PrintFrame(Info);
@@ -555,7 +638,7 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
           Info << " Weather events: " << Total << std::endl;
           for (i = 0; i < Total; ++i)
           {
-            Weather.Read(File);
+            Weather.Read(In);
             Info << "  " << Weather.Print() << std::endl;
           }
         }
@@ -567,7 +650,8 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
         case static_cast<char>(CarlaRecorderPacketId::DReyeVR):
         if (bShowAll)
         {
-            ReadValue<uint16_t>(File, Total);
+            DReyeVR::BinaryReader In = DReyeVR::ReadPacket(File, Header.Size, PacketBuffer);
+            ReadValue<uint16_t>(In, Total);
             if (Total > 0 && !bFramePrinted)
             {
                 PrintFrame(Info);
@@ -576,7 +660,7 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
             Info << " DReyeVR sensor data: " << Total << std::endl;
             for (i = 0; i < Total; ++i)
             {
-                DReyeVRAggDataInstance.Read(File);
+                DReyeVRAggDataInstance.Read(In);
                 Info << DReyeVRAggDataInstance.Print() << std::endl;
             }
         }
@@ -588,7 +672,8 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
         case static_cast<char>(CarlaRecorderPacketId::DReyeVRCustomActor):
         if (bShowAll)
         {
-            ReadValue<uint16_t>(File, Total);
+            DReyeVR::BinaryReader In = DReyeVR::ReadPacket(File, Header.Size, PacketBuffer);
+            ReadValue<uint16_t>(In, Total);
             if (Total > 0 && !bFramePrinted)
             {
                 PrintFrame(Info);
@@ -596,14 +681,91 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
             }
             Info << " DReyeVR custom actor data: " << Total << std::endl;
             for (i = 0; i < Total; ++i)
-            { 
-                DReyeVRCustomActorDataInstance.Read(File);
+            {
+                DReyeVRCustomActorDataInstance.Read(In);
                 Info << DReyeVRCustomActorDataInstance.Print() << std::endl;
             }
         }
         else
             SkipPacket();
         break;
+
+        // DReyeVR eye tracker samples
+        case static_cast<char>(CarlaRecorderPacketId::DReyeVREyeSamples):
+        if (bShowAll)
+        {
+            const DReyeVR::PackedEyeSample *Samples = DReyeVR::EyeSampleRecorder::Read(File, Total, EyeSamples);
+            if (Total > 0 && !bFramePrinted)
+            {
+                PrintFrame(Info);
+                bFramePrinted = true;
+            }
+            Info << " DReyeVR eye samples: " << Total << std::endl;
+            for (i = 0; i < Total; ++i)
+                Info << Samples[i].Print() << std::endl;
+        }
+        else
+            SkipPacket();
+        break;
+
+        // DReyeVR attention weights of the gaze cone
+        case static_cast<char>(CarlaRecorderPacketId::DReyeVRAttention):
+        if (bShowAll)
+        {
+            DReyeVR::BinaryReader In = DReyeVR::ReadPacket(File, Header.Size, PacketBuffer);
+            DReyeVR::AttentionRecorder::Read(In, Attention);
+            if (!Attention.empty() && !bFramePrinted)
+            {
+                PrintFrame(Info);
+                bFramePrinted = true;
+            }
+            Info << " DReyeVR attention: " << Attention.size() << std::endl;
+            Info << DReyeVR::AttentionRecorder::Print(Attention);
+        }
+        else
+            SkipPacket();
+        break;
+
+        // DReyeVR fixations/saccades
+        case static_cast<char>(CarlaRecorderPacketId::DReyeVRGazeEvents):
+        if (bShowAll)
+        {
+            DReyeVR::BinaryReader In = DReyeVR::ReadPacket(File, Header.Size, PacketBuffer);
+            GazeEvents.clear();
+            DReyeVR::GazeEventRecorder::Read(In, GazeEvents);
+            if (!GazeEvents.empty() && !bFramePrinted)
+            {
+                PrintFrame(Info);
+                bFramePrinted = true;
+            }
+            Info << " DReyeVR gaze events: " << GazeEvents.size() << std::endl;
+            Info << DReyeVR::GazeEventRecorder::Print(GazeEvents);
+        }
+        else
+            SkipPacket();
+        break;
+
+        // DReyeVR data (compact mode), always decoded since every packet depends on the previous one
+        case static_cast<char>(CarlaRecorderPacketId::DReyeVRCompactData):
+        {
+            DReyeVR::BinaryReader In = ReadCompactData();
+            if (bShowAll)
+            {
+                ReadValue<uint16_t>(In, Total);
+                if (Total > 0 && !bFramePrinted)
+                {
+                    PrintFrame(Info);
+                    bFramePrinted = true;
+                }
+                Info << " DReyeVR sensor data: " << Total << std::endl;
+                for (i = 0; i < Total; ++i)
+                {
+                    DReyeVRAggDataInstance.Read(In);
+                    Info << DReyeVRAggDataInstance.Print() << std::endl;
+                }
+            }
+        }
+        break;
         // frame end
         case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
         // do nothing, it is empty
@@ -618,7 +780,7 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
   Info << "\nFrames: " << Frame.Id << "\n";
   Info << "Duration: " << Frame.Elapsed << " seconds\n";
 
-  File.close();
+  Mapped.Close(File);
 
   return Info.str();
 }
@@ -631,8 +793,7 @@ std::string CarlaRecorderQuery::QueryCollisions(std::string Filename, char Categ
   std::string Filename2 = GetRecorderFilename(Filename);
 
   // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  if (!Mapped.Open(File, Filename2))
   {
     Info << "File " << Filename2 << " not found on server\n";
     return Info.str();
@@ -798,7 +959,7 @@ std::string CarlaRecorderQuery::QueryCollisions(std::string Filename, char Categ
   Info << "\nFrames: " << Frame.Id << "\n";
   Info << "Duration: " << Frame.Elapsed << " seconds\n";
 
-  File.close();
+  Mapped.Close(File);
 
   return Info.str();
 }
@@ -811,8 +972,7 @@ std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTim
   std::string Filename2 = GetRecorderFilename(Filename);
 
   // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  if (!Mapped.Open(File, Filename2))
   {
     Info << "File " << Filename2 << " not found on server\n";
     return Info.str();
@@ -823,6 +983,7 @@ std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTim
 
   // other, vehicle, walkers, trafficLight, hero, any
   uint16_t i, Total;
+  const CarlaRecorderPosition *Positions = nullptr;
   struct ReplayerActorInfo
   {
     uint8_t Type;
@@ -893,11 +1054,25 @@ std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTim
 
       // positions
       case static_cast<char>(CarlaRecorderPacketId::Position):
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVRCompactPositions):
         // read all positions
-        ReadValue<uint16_t>(File, Total);
+        if (Header.Id == static_cast<char>(CarlaRecorderPacketId::DReyeVRCompactPositions))
+        {
+          PositionDecoder.Read(File, Header.Size, CompactPositions);
+          Total = static_cast<uint16_t>(CompactPositions.size());
+          Positions = CompactPositions.data();
+        }
+        else
+        {
+          ReadValue<uint16_t>(File, Total);
+          Positions = DReyeVR::ReadSpan<CarlaRecorderPosition>(File, Total);
+        }
         for (i=0; i<Total; ++i)
         {
-          Position.Read(File);
+          if (Positions != nullptr)
+            Position = Positions[i];
+          else
+            Position.Read(File);
           // check if actor moved less than a distance
           if (FVector::Distance(Actors[Position.DatabaseId].LastPosition, Position.Location) < MinDistance)
           {
@@ -967,7 +1142,211 @@ std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTim
   Info << "\nFrames: " << Frame.Id << "\n";
   Info << "Duration: " << Frame.Elapsed << " seconds\n";
 
-  File.close();
+  Mapped.Close(File);
+
+  return Info.str();
+}
+
+std::string CarlaRecorderQuery::QueryExport(std::string Filename, std::string OutDir)
+{
+  std::stringstream Info;
+
+  // get the final path + filename
+  std::string Filename2 = GetRecorderFilename(Filename);
+
+  // try to open
+  if (!Mapped.Open(File, Filename2))
+  {
+    Info << "File " << Filename2 << " not found on server\n";
+    return Info.str();
+  }
+
+  if (!CheckFileInfo(Info))
+    return Info.str();
+
+  // default to a directory next to the recording
+  if (OutDir.empty())
+    OutDir = Filename2.substr(0, Filename2.find_last_of('.')) + "_columns";
+
+  DReyeVR::ColumnExporter Exporter;
+  if (!Exporter.Open(OutDir))
+  {
+    Info << "Unable to create the export directory " << OutDir << "\n";
+    Mapped.Close(File);
+    return Info.str();
+  }
+
+  uint16_t i, Total;
+  const CarlaRecorderPosition *Positions = nullptr;
+  ActorIndex.Clear();
+  ActorBoxes.clear();
+  ActorTypes.clear();
+  FramePositions.clear();
+  FrameGazes.clear();
+
+  // parse only the packets that are exported (one pass, nothing is kept in memory)
+  while (File)
+  {
+
+    // get header
+    if (!ReadHeader())
+    {
+      break;
+    }
+
+    switch (Header.Id)
+    {
+      // frame
+      case static_cast<char>(CarlaRecorderPacketId::FrameStart):
+        Frame.Read(File);
+        break;
+
+      // events add (for the names of the actors the gaze is attributed to)
+      case static_cast<char>(CarlaRecorderPacketId::EventAdd):
+        ReadValue<uint16_t>(File, Total);
+        for (i = 0; i < Total; ++i)
+        {
+          EventAdd.Read(File);
+          ActorTypes[EventAdd.DatabaseId] = EventAdd.Description.Id;
+        }
+        break;
+
+      // events del
+      case static_cast<char>(CarlaRecorderPacketId::EventDel):
+        ReadValue<uint16_t>(File, Total);
+        for (i = 0; i < Total; ++i)
+        {
+          EventDel.Read(File);
+          ActorTypes.erase(EventDel.DatabaseId);
+          ActorBoxes.erase(EventDel.DatabaseId);
+        }
+        break;
+
+      // actors bounding boxes (local space, recorded once per actor)
+      case static_cast<char>(CarlaRecorderPacketId::BoundingBox):
+        ReadValue<uint16_t>(File, Total);
+        for (i = 0; i < Total; ++i)
+        {
+          ActorBoundingBox.Read(File);
+          ActorBoxes[ActorBoundingBox.DatabaseId] = ActorBoundingBox;
+        }
+        break;
+
+      // positions
+      case static_cast<char>(CarlaRecorderPacketId::Position):
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVRCompactPositions):
+        if (Header.Id == static_cast<char>(CarlaRecorderPacketId::DReyeVRCompactPositions))
+        {
+          PositionDecoder.Read(File, Header.Size, CompactPositions);
+          Total = static_cast<uint16_t>(CompactPositions.size());
+          Positions = CompactPositions.data();
+        }
+        else
+        {
+          ReadValue<uint16_t>(File, Total);
+          Positions = DReyeVR::ReadSpan<CarlaRecorderPosition>(File, Total);
+        }
+        for (i = 0; i < Total; ++i)
+        {
+          if (Positions != nullptr)
+            Position = Positions[i];
+          else
+            Position.Read(File);
+          Exporter.AddPosition(Frame.Id, Frame.Elapsed, Position.DatabaseId, Position.Location, Position.Rotation);
+          FramePositions.push_back(Position);
+        }
+        break;
+
+      // DReyeVR sensor data
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVR):
+      {
+        DReyeVR::BinaryReader In = DReyeVR::ReadPacket(File, Header.Size, PacketBuffer);
+        ReadValue<uint16_t>(In, Total);
+        for (i = 0; i < Total; ++i)
+        {
+          DReyeVRAggDataInstance.Read(In);
+          Exporter.AddAggregateData(Frame.Id, Frame.Elapsed, DReyeVRAggDataInstance.Data);
+          AddGaze(DReyeVRAggDataInstance.Data);
+        }
+        break;
+      }
+
+      // DReyeVR sensor data (compact mode)
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVRCompactData):
+      {
+        DReyeVR::BinaryReader In = ReadCompactData();
+        ReadValue<uint16_t>(In, Total);
+        for (i = 0; i < Total; ++i)
+        {
+          DReyeVRAggDataInstance.Read(In);
+          Exporter.AddAggregateData(Frame.Id, Frame.Elapsed, DReyeVRAggDataInstance.Data);
+          AddGaze(DReyeVRAggDataInstance.Data);
+        }
+        break;
+      }
+
+      // DReyeVR custom actors
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVRCustomActor):
+      {
+        DReyeVR::BinaryReader In = DReyeVR::ReadPacket(File, Header.Size, PacketBuffer);
+        ReadValue<uint16_t>(In, Total);
+        for (i = 0; i < Total; ++i)
+        {
+          DReyeVRCustomActorDataInstance.Read(In);
+          Exporter.AddCustomActor(Frame.Id, Frame.Elapsed, DReyeVRCustomActorDataInstance.Data);
+        }
+        break;
+      }
+
+      // DReyeVR eye tracker samples
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVREyeSamples):
+      {
+        const DReyeVR::PackedEyeSample *Samples = DReyeVR::EyeSampleRecorder::Read(File, Total, EyeSamples);
+        for (i = 0; i < Total; ++i)
+          Exporter.AddEyeSample(Frame.Id, Frame.Elapsed, Samples[i]);
+        break;
+      }
+
+      // DReyeVR attention weights of the gaze cone
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVRAttention):
+      {
+        DReyeVR::BinaryReader In = DReyeVR::ReadPacket(File, Header.Size, PacketBuffer);
+        DReyeVR::AttentionRecorder::Read(In, Attention);
+        for (const DReyeVR::ActorAttention &A : Attention)
+          Exporter.AddAttention(Frame.Id, Frame.Elapsed, A);
+        break;
+      }
+
+      // DReyeVR fixations/saccades
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVRGazeEvents):
+      {
+        DReyeVR::BinaryReader In = DReyeVR::ReadPacket(File, Header.Size, PacketBuffer);
+        GazeEvents.clear();
+        DReyeVR::GazeEventRecorder::Read(In, GazeEvents);
+        for (const DReyeVR::GazeEvent &E : GazeEvents)
+          Exporter.AddGazeEvent(Frame.Id, Frame.Elapsed, E);
+        break;
+      }
+
+      // frame end
+      case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
+        // all the positions and boxes of the frame are known by now
+        AttributeGaze(Exporter);
+        break;
+
+      default:
+        SkipPacket();
+        break;
+    }
+  }
+
+  Exporter.Close();
+  Info << Exporter.Summary();
+
+  Info << "\nFrames: " << Frame.Id << "\n";
+  Info << "Duration: " << Frame.Elapsed << " seconds\n";
+
+  Mapped.Close(File);
 
   return Info.str();
 }
@@ -7,6 +7,9 @@
 #pragma once
 
 #include <fstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "CarlaRecorderTraficLightTime.h"
 #include "CarlaRecorderPhysicsControl.h"
@@ -25,7 +28,18 @@
 #include "CarlaRecorderPosition.h"
 #include "CarlaRecorderState.h"
 #include "CarlaRecorderWeather.h"
+#include "DReyeVRCompact.h"
+#include "DReyeVRAttention.h"
+#include "DReyeVREyeSamples.h"
+#include "DReyeVRGazeEvents.h"
 #include "DReyeVRRecorder.h"
+#include "DReyeVRMappedFile.h"
+#include "Carla/Sensor/DReyeVRActorIndex.h"
+
+namespace DReyeVR
+{
+class ColumnExporter;
+};
 
 class CarlaRecorderQuery
 {
@@ -46,10 +60,14 @@ public:
   std::string QueryCollisions(std::string Filename, char Category1 = 'a', char Category2 = 'a');
   // get info about blocked actors
   std::string QueryBlocked(std::string Filename, double MinTime = 30, double MinDistance = 10);
+  // export positions and DReyeVR packets to column files (.npy) in OutDir
+  std::string QueryExport(std::string Filename, std::string OutDir);
 
 private:
 
   std::ifstream File;
+  DReyeVR::MappedFile Mapped;
+  std::vector<char> PacketBuffer; // packets read with DReyeVR::ReadPacket when the file is not memory-mapped
   Header Header;
   CarlaRecorderInfo RecInfo;
   CarlaRecorderFrame Frame;
@@ -72,6 +90,19 @@ private:
   // custom DReyeVR packets
   DReyeVRDataRecorder<DReyeVR::AggregateData> DReyeVRAggDataInstance;
   DReyeVRDataRecorder<DReyeVR::CustomActorData> DReyeVRCustomActorDataInstance;
+  std::vector<DReyeVR::PackedEyeSample> EyeSamples;
+  std::vector<DReyeVR::ActorAttention> Attention;
+  std::vector<DReyeVR::GazeEvent> GazeEvents;
+  // compact mode decoders
+  DReyeVR::CompactPositionDecoder PositionDecoder;
+  DReyeVR::CompactDataDecoder DataDecoder;
+  std::vector<CarlaRecorderPosition> CompactPositions;
+  // gaze re-attribution of QueryExport (the bounding boxes are only recorded with the additional data)
+  DReyeVR::ActorBoxIndex ActorIndex;
+  std::unordered_map<uint32_t, CarlaRecorderActorBoundingBox> ActorBoxes;
+  std::unordered_map<uint32_t, FString> ActorTypes; // description id, e.g. "vehicle.audi.tt"
+  std::vector<CarlaRecorderPosition> FramePositions;
+  std::vector<std::pair<FVector, FVector>> FrameGazes; // start and end of the gaze rays of the frame
 
   // read next header packet
   bool ReadHeader(void);
@@ -81,4 +112,13 @@ private:
 
   // read the start info structure and check the magic string
   bool CheckFileInfo(std::stringstream &Info);
+
+  // decode a compact DReyeVR packet, the returned reader is at the record count of the original DReyeVR packet
+  DReyeVR::BinaryReader ReadCompactData(void);
+
+  // gaze ray of a DReyeVR sample, to be attributed at the end of the frame
+  void AddGaze(const DReyeVR::AggregateData &Data);
+
+  // intersect the gaze rays of the frame with the actor bounding boxes
+  void AttributeGaze(DReyeVR::ColumnExporter &Exporter);
 };
@@ -9,38 +9,38 @@
 #include "CarlaRecorderHelpers.h"
 
 
-void CarlaRecorderWeather::Write(std::ofstream &OutFile) const
+void CarlaRecorderWeather::Write(DReyeVR::BinaryWriter &Out) const
 {
-  WriteValue<float>(OutFile, this->Params.Cloudiness);
-  WriteValue<float>(OutFile, this->Params.Precipitation);
-  WriteValue<float>(OutFile, this->Params.PrecipitationDeposits);
-  WriteValue<float>(OutFile, this->Params.WindIntensity);
-  WriteValue<float>(OutFile, this->Params.SunAzimuthAngle);
-  WriteValue<float>(OutFile, this->Params.SunAltitudeAngle);
-  WriteValue<float>(OutFile, this->Params.FogDensity);
-  WriteValue<float>(OutFile, this->Params.FogDistance);
-  WriteValue<float>(OutFile, this->Params.FogFalloff);
-  WriteValue<float>(OutFile, this->Params.Wetness);
-  WriteValue<float>(OutFile, this->Params.ScatteringIntensity);
-  WriteValue<float>(OutFile, this->Params.MieScatteringScale);
-  WriteValue<float>(OutFile, this->Params.RayleighScatteringScale);
+  WriteValue<float>(Out, this->Params.Cloudiness);
+  WriteValue<float>(Out, this->Params.Precipitation);
+  WriteValue<float>(Out, this->Params.PrecipitationDeposits);
+  WriteValue<float>(Out, this->Params.WindIntensity);
+  WriteValue<float>(Out, this->Params.SunAzimuthAngle);
+  WriteValue<float>(Out, this->Params.SunAltitudeAngle);
+  WriteValue<float>(Out, this->Params.FogDensity);
+  WriteValue<float>(Out, this->Params.FogDistance);
+  WriteValue<float>(Out, this->Params.FogFalloff);
+  WriteValue<float>(Out, this->Params.Wetness);
+  WriteValue<float>(Out, this->Params.ScatteringIntensity);
+  WriteValue<float>(Out, this->Params.MieScatteringScale);
+  WriteValue<float>(Out, this->Params.RayleighScatteringScale);
 }
 
-void CarlaRecorderWeather::Read(std::ifstream &InFile)
+void CarlaRecorderWeather::Read(DReyeVR::BinaryReader &In)
 {
-  ReadValue<float>(InFile, this->Params.Cloudiness);
-  ReadValue<float>(InFile, this->Params.Precipitation);
-  ReadValue<float>(InFile, this->Params.PrecipitationDeposits);
-  ReadValue<float>(InFile, this->Params.WindIntensity);
-  ReadValue<float>(InFile, this->Params.SunAzimuthAngle);
-  ReadValue<float>(InFile, this->Params.SunAltitudeAngle);
-  ReadValue<float>(InFile, this->Params.FogDensity);
-  ReadValue<float>(InFile, this->Params.FogDistance);
-  ReadValue<float>(InFile, this->Params.FogFalloff);
-  ReadValue<float>(InFile, this->Params.Wetness);
-  ReadValue<float>(InFile, this->Params.ScatteringIntensity);
-  ReadValue<float>(InFile, this->Params.MieScatteringScale);
-  ReadValue<float>(InFile, this->Params.RayleighScatteringScale);
+  ReadValue<float>(In, this->Params.Cloudiness);
+  ReadValue<float>(In, this->Params.Precipitation);
+  ReadValue<float>(In, this->Params.PrecipitationDeposits);
+  ReadValue<float>(In, this->Params.WindIntensity);
+  ReadValue<float>(In, this->Params.SunAzimuthAngle);
+  ReadValue<float>(In, this->Params.SunAltitudeAngle);
+  ReadValue<float>(In, this->Params.FogDensity);
+  ReadValue<float>(In, this->Params.FogDistance);
+  ReadValue<float>(In, this->Params.FogFalloff);
+  ReadValue<float>(In, this->Params.Wetness);
+  ReadValue<float>(In, this->Params.ScatteringIntensity);
+  ReadValue<float>(In, this->Params.MieScatteringScale);
+  ReadValue<float>(In, this->Params.RayleighScatteringScale);
 }
 
 std::string CarlaRecorderWeather::Print() const
@@ -62,28 +62,29 @@ void CarlaRecorderWeathers::Add(const CarlaRecorderWeather &Weather)
   Weathers.push_back(Weather);
 }
 
-void CarlaRecorderWeathers::Write(std::ofstream &OutFile) const
+void CarlaRecorderWeathers::Write(DReyeVR::BinaryWriter &Out) const
 {
   if (Weathers.size() == 0)
   {
     return;
   }
-  // write the packet id
-  WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::Weather));
-
-  std::streampos PosStart = OutFile.tellp();
-
-  // write a dummy packet size
-  uint32_t Total = 2 + Weathers.size() * sizeof(CarlaRecorderWeather);
-  WriteValue<uint32_t>(OutFile, Total);
+  const size_t Start = Out.BeginPacket(static_cast<char>(CarlaRecorderPacketId::Weather));
 
   // write total records
-  Total = Weathers.size();
-  WriteValue<uint16_t>(OutFile, Total);
+  WriteValue<uint16_t>(Out, static_cast<uint16_t>(Weathers.size()));
 
   for (auto& Weather : Weathers)
   {
-    Weather.Write(OutFile);
+    Weather.Write(Out);
   }
 
+  Out.EndPacket(Start);
+}
+
+void CarlaRecorderWeathers::Write(std::ofstream &OutFile) const
+{
+  // the size is only known once the packet is serialized in memory
+  DReyeVR::BinaryWriter Packet;
+  Write(Packet);
+  Packet.Flush(OutFile);
 }
@@ -9,6 +9,7 @@
 #include <fstream>
 #include <vector>
 #include "Carla/Weather/WeatherParameters.h"
+#include "DReyeVRBinaryIO.h"
 
 #pragma pack(push, 1)
 struct CarlaRecorderWeather
@@ -16,9 +17,9 @@ struct CarlaRecorderWeather
 
   FWeatherParameters Params;
 
-  void Read(std::ifstream &InFile);
+  void Read(DReyeVR::BinaryReader &In);
 
-  void Write(std::ofstream &OutFile) const;
+  void Write(DReyeVR::BinaryWriter &Out) const;
 
   std::string Print() const;
 };
@@ -32,6 +33,8 @@ public:
 
   void Clear(void);
 
+  void Write(DReyeVR::BinaryWriter &Out) const;
+
   void Write(std::ofstream &OutFile) const;
 
 private:
@@ -12,9 +12,15 @@
 #include "Carla/Actor/DReyeVRCustomActor.h" // ADReyeVRCustomActor::ActiveCustomActors
 #include "Carla/Sensor/DReyeVRSensor.h"     // ADReyeVRSensor
 
+#include <algorithm>
 #include <ctime>
+#include <limits>
 #include <sstream>
 
+// positions are read in place from the mapped file, so the struct must match the recorded layout exactly
+static_assert(sizeof(CarlaRecorderPosition) == sizeof(uint32_t) + 6 * sizeof(float),
+              "CarlaRecorderPosition must be packed to be read in place");
+
 // structure to save replaying info when need to load a new map (static member by now)
 CarlaReplayer::PlayAfterLoadMap CarlaReplayer::Autoplay { false, "", "", 0.0, 0.0, 0, 1.0, false };
 
@@ -34,7 +40,7 @@ void CarlaReplayer::Stop(bool bKeepActors)
     Helper.ProcessReplayerFinish(bKeepActors, IgnoreHero, IsHeroMap);
   }
 
-  File.close();
+  Mapped.Close(File);
 }
 
 bool CarlaReplayer::ReadHeader()
@@ -70,6 +76,8 @@ void CarlaReplayer::Rewind(void)
 
   MappedId.clear();
   IsHeroMap.clear();
+  PositionDecoder.Reset();
+  DataDecoder.Reset();
 
   // read geneal Info
   RecInfo.Read(File);
@@ -78,6 +86,11 @@ void CarlaReplayer::Rewind(void)
 // read last frame in File and return the Total time recorded
 double CarlaReplayer::GetTotalTime(void)
 {
+  if (FrameIndex.IsValid())
+  {
+    return FrameIndex.GetTotalTime();
+  }
+
   std::streampos Current = File.tellg();
 
   // parse only frames
@@ -109,6 +122,17 @@ double CarlaReplayer::GetTotalTime(void)
 // Read all the frames and collect their start times
 void CarlaReplayer::GetFrameStartTimes()
 {
+  if (FrameIndex.IsValid())
+  {
+    FrameStartTimes.clear();
+    FrameStartTimes.reserve(FrameIndex.Num());
+    for (size_t i = 0; i < FrameIndex.Num(); ++i)
+    {
+      FrameStartTimes.push_back(FrameIndex[i].Elapsed);
+    }
+    return;
+  }
+
   std::streampos Current = File.tellg();
 
   while (File)
@@ -158,14 +182,18 @@ std::string CarlaReplayer::ReplayFile(std::string Filename, double TimeStart, do
   Info << "Replaying File: " << Filename2 << std::endl;
 
   // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  if (!Mapped.Open(File, Filename2))
   {
     Info << "File " << Filename2 << " not found on server\n";
     Stop();
     return Info.str();
   }
 
+  // look for the frame index trailer (legacy recordings will fall back to scanning)
+  FrameIndex.Read(File);
+  FrameStartTimes.clear();
+  SyncCurrentFrameId = 0;
+
   // from start
   Rewind();
 
@@ -216,13 +244,18 @@ std::string CarlaReplayer::ReplayFile(std::string Filename, double TimeStart, do
   // set the follow Id
   FollowId = ThisFollowId;
 
+  // a synchronized replay starts at the first frame from TimeStart on (and stops before the frames from TimeToStop on
+  // if a duration is given), without interpolating to TimeStart
+  SyncTimeStart = TimeStart;
+  SyncTimeToStop = (Duration > 0.0f) ? TimeToStop : std::numeric_limits<double>::max();
+
   bReplaySensors = ReplaySensors;
   // if we don't need to load a new map, then start
   if (!Autoplay.Enabled)
   {
     Helper.RemoveStaticProps();
     // process all events until the time
-    ProcessToTime(TimeStart, true);
+    ProcessToTime(bReplaySync ? 0.0 : TimeStart, true);
     // mark as enabled
     Enabled = true;
   }
@@ -247,12 +280,16 @@ void CarlaReplayer::CheckPlayAfterMapLoaded(void)
   }
 
   // try to open
-  File.open(Autoplay.Filename, std::ios::binary);
-  if (!File.is_open())
+  if (!Mapped.Open(File, Autoplay.Filename))
   {
     return;
   }
 
+  // look for the frame index trailer (legacy recordings will fall back to scanning)
+  FrameIndex.Read(File);
+  FrameStartTimes.clear();
+  SyncCurrentFrameId = 0;
+
   // from start
   Rewind();
 
@@ -274,6 +311,9 @@ void CarlaReplayer::CheckPlayAfterMapLoaded(void)
   else
     TimeToStop = TotalTime;
 
+  SyncTimeStart = TimeStart;
+  SyncTimeToStop = (Autoplay.Duration > 0.0f) ? TimeToStop : std::numeric_limits<double>::max();
+
   // set the follow Id
   FollowId = Autoplay.FollowId;
 
@@ -285,7 +325,7 @@ void CarlaReplayer::CheckPlayAfterMapLoaded(void)
   Helper.RemoveStaticProps();
 
   // process all events until the time
-  ProcessToTime(TimeStart, true);
+  ProcessToTime(bReplaySync ? 0.0 : TimeStart, true);
 
   // mark as enabled
   Enabled = true;
@@ -306,6 +346,11 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
     bFrameFound = true;
     bExitLoop = true;
   }
+  else
+  {
+    // jump straight to the frame that holds the time we want (if the recording has an index)
+    SeekWithIndex(NewTime);
+  }
 
   // process all frames until time we want or end
   while (!File.eof() && !bExitLoop)
@@ -313,6 +358,9 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
     // get header
     ReadHeader();
 
+    // the frames played through during this tick, not the ones a start or a jump walks over to reach its frame
+    const bool bKeepPlayed = !IsFirstTime && Frame.Elapsed >= CurrentTime;
+
     // check for a frame packet
     switch (Header.Id)
     {
@@ -356,6 +404,14 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
           SkipPacket();
         break;
 
+      // delta/quantized positions (compact mode)
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVRCompactPositions):
+        if (bFrameFound)
+          ProcessCompactPositions(IsFirstTime);
+        else
+          PositionDecoder.Skip(File, Header.Size);
+        break;
+
       // states
       case static_cast<char>(CarlaRecorderPacketId::State):
         if (bFrameFound)
@@ -409,6 +465,11 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
           SkipPacket();
         break;
 
+      // DReyeVR eye logging data (compact mode)
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVRCompactData):
+        ProcessCompactData(Per, bFrameFound);
+        break;
+
       // DReyeVR eye logging data
       case static_cast<char>(CarlaRecorderPacketId::DReyeVRCustomActor):
         if (bFrameFound)
@@ -417,6 +478,31 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
           SkipPacket();
         break;
 
+      // DReyeVR high-rate eye tracker samples
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVREyeSamples):
+        // also keep the samples of the frames that were played through during this tick (not only the last one)
+        if (bFrameFound || bKeepPlayed)
+          ProcessEyeSamples();
+        else
+          SkipPacket();
+        break;
+
+      // DReyeVR attention weights of the gaze cone
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVRAttention):
+        if (bFrameFound)
+          ProcessAttention();
+        else
+          SkipPacket();
+        break;
+
+      // DReyeVR fixations/saccades, like the eye samples they are kept for every frame played in this tick
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVRGazeEvents):
+        if (bFrameFound || bKeepPlayed)
+          ProcessGazeEvents();
+        else
+          SkipPacket();
+        break;
+
       // frame end
       case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
         if (bFrameFound)
@@ -438,6 +524,22 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
     UpdatePositions(Per, Time);
   }
 
+  // hand all the eye samples played in this tick to the sensor and publish the replayed snapshot
+  if (Enabled && bFrameFound)
+  {
+    ADReyeVRSensor *Sensor = ADReyeVRSensor::GetDReyeVRSensor(Episode->GetWorld());
+    if (Sensor != nullptr)
+    {
+      Sensor->GetNextData().UpdateEyeSamples(std::move(EyeSamples));
+      Sensor->GetNextData().UpdateAttention(std::move(Attention));
+      Sensor->GetNextData().UpdateGazeEvents(std::move(GazeEvents));
+      Sensor->PublishData();
+    }
+  }
+  EyeSamples.clear();
+  Attention.clear();
+  GazeEvents.clear();
+
   // save current time
   CurrentTime = NewTime;
 
@@ -449,6 +551,155 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
   }
 }
 
+void CarlaReplayer::SeekWithIndex(double Time)
+{
+  if (!FrameIndex.IsValid() || !File.good())
+  {
+    return;
+  }
+
+  const size_t Target = FrameIndex.FindFrame(Time);
+  const size_t Next = FrameIndex.FindOffset(static_cast<uint64_t>(File.tellg()));
+  const size_t Key = FrameIndex.FindKeyframe(Target);
+  size_t First = Next;
+
+  if (Key < FrameIndex.Num() && (Key > Next || Target < Next))
+  {
+    // the keyframe restores the full state, so only the frames after it need to be visited
+    File.seekg(FrameIndex[Key].Offset, std::ios::beg);
+    ProcessFrameEvents();
+    First = Key + 1;
+  }
+  else if (Next >= Target || Target >= FrameIndex.Num())
+  {
+    // already at the target frame (or it is behind us with no keyframe to go back to)
+    return;
+  }
+
+  // only the frames with events or weather changes (or delta-coded ones) need to be visited on the way to the target
+  for (size_t i = First; i < Target; ++i)
+  {
+    const auto &Entry = FrameIndex[i];
+    if (Entry.Flags & (DReyeVR::FRAME_HAS_EVENTS | DReyeVR::FRAME_HAS_WEATHER | DReyeVR::FRAME_DELTA))
+    {
+      File.seekg(Entry.Offset, std::ios::beg);
+      ProcessFrameEvents();
+    }
+  }
+
+  // continue reading from the start of the target frame
+  File.seekg(FrameIndex[Target].Offset, std::ios::beg);
+}
+
+void CarlaReplayer::ProcessFrameEvents(void)
+{
+  // process a single frame applying only the packets that persist across frames
+  while (!File.eof())
+  {
+    ReadHeader();
+
+    switch (Header.Id)
+    {
+      case static_cast<char>(CarlaRecorderPacketId::FrameStart):
+        Frame.Read(File);
+        break;
+
+      case static_cast<char>(CarlaRecorderPacketId::EventAdd):
+        ProcessEventsAdd();
+        break;
+
+      case static_cast<char>(CarlaRecorderPacketId::EventDel):
+        ProcessEventsDel();
+        break;
+
+      case static_cast<char>(CarlaRecorderPacketId::EventParent):
+        ProcessEventsParent();
+        break;
+
+      case static_cast<char>(CarlaRecorderPacketId::Weather):
+        ProcessWeather();
+        break;
+
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVRKeyframe):
+        ProcessKeyframe();
+        break;
+
+      // not applied, but the decoders need to see every frame
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVRCompactPositions):
+        PositionDecoder.Skip(File, Header.Size);
+        break;
+
+      case static_cast<char>(CarlaRecorderPacketId::DReyeVRCompactData):
+        DataDecoder.Read(File, Header.Size);
+        break;
+
+      case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
+        return;
+
+      default:
+        SkipPacket();
+        break;
+    }
+  }
+}
+
+void CarlaReplayer::ProcessKeyframe(void)
+{
+  DReyeVR::Keyframe Keyframe;
+  DReyeVR::BinaryReader In = DReyeVR::ReadPacket(File, Header.Size, PacketBuffer);
+  Keyframe.Read(In);
+
+  // destroy the replayed actors that do not exist at this keyframe
+  std::unordered_set<uint32_t> Alive;
+  for (const auto &Actor : Keyframe.Actors)
+  {
+    Alive.insert(Actor.DatabaseId);
+  }
+  for (auto It = MappedId.begin(); It != MappedId.end();)
+  {
+    if (Alive.find(It->first) == Alive.end())
+    {
+      Helper.ProcessReplayerEventDel(It->second);
+      It = MappedId.erase(It);
+    }
+    else
+    {
+      ++It;
+    }
+  }
+
+  // create the actors that are missing (the others get placed by the positions of this frame)
+  std::unordered_set<uint32_t> Created;
+  for (const auto &Actor : Keyframe.Actors)
+  {
+    auto It = MappedId.find(Actor.DatabaseId);
+    if (It == MappedId.end() || Episode->FindCarlaActor(It->second) == nullptr)
+    {
+      ProcessEventAdd(Actor);
+      Created.insert(Actor.DatabaseId);
+    }
+  }
+
+  // only the new actors need to be reattached
+  for (const auto &Parent : Keyframe.Parents)
+  {
+    if (Created.find(Parent.DatabaseId) != Created.end())
+    {
+      Helper.ProcessReplayerEventParent(MappedId[Parent.DatabaseId], MappedId[Parent.DatabaseIdParent]);
+    }
+  }
+
+  for (const auto &Light : Keyframe.Lights)
+  {
+    Helper.ProcessReplayerLightScene(Light);
+  }
+
+  if (Keyframe.bHasWeather)
+  {
+    Helper.ProcessReplayerWeather(Keyframe.Weather);
+  }
+}
+
 void CarlaReplayer::ProcessEventsAdd(void)
 {
   uint16_t i, Total;
@@ -459,49 +710,53 @@ void CarlaReplayer::ProcessEventsAdd(void)
   for (i = 0; i < Total; ++i)
   {
     EventAdd.Read(File);
+    ProcessEventAdd(EventAdd);
+  }
+}
 
-    // auto Result = CallbackEventAdd(
-    auto Result = Helper.ProcessReplayerEventAdd(
-        EventAdd.Location,
-        EventAdd.Rotation,
-        EventAdd.Description,
-        EventAdd.DatabaseId,
-        IgnoreHero,
-        bReplaySensors);
-
-    switch (Result.first)
-    {
-      // actor not created
-      case 0:
-        UE_LOG(LogCarla, Log, TEXT("actor could not be created"));
-        break;
+void CarlaReplayer::ProcessEventAdd(const CarlaRecorderEventAdd &EventAdd)
+{
+  // auto Result = CallbackEventAdd(
+  auto Result = Helper.ProcessReplayerEventAdd(
+      EventAdd.Location,
+      EventAdd.Rotation,
+      EventAdd.Description,
+      EventAdd.DatabaseId,
+      IgnoreHero,
+      bReplaySensors);
+
+  switch (Result.first)
+  {
+    // actor not created
+    case 0:
+      UE_LOG(LogCarla, Log, TEXT("actor could not be created"));
+      break;
 
-      // actor created but with different id
-      case 1:
-        // mapping id (recorded Id is a new Id in replayer)
-        MappedId[EventAdd.DatabaseId] = Result.second;
-        break;
+    // actor created but with different id
+    case 1:
+      // mapping id (recorded Id is a new Id in replayer)
+      MappedId[EventAdd.DatabaseId] = Result.second;
+      break;
 
-      // actor reused from existing
-      case 2:
-        // mapping id (say desired Id is mapped to what)
-        MappedId[EventAdd.DatabaseId] = Result.second;
-        break;
-    }
+    // actor reused from existing
+    case 2:
+      // mapping id (say desired Id is mapped to what)
+      MappedId[EventAdd.DatabaseId] = Result.second;
+      break;
+  }
 
-    // check to mark if actor is a hero vehicle or not
-    if (Result.first > 0)
+  // check to mark if actor is a hero vehicle or not
+  if (Result.first > 0)
+  {
+    // init
+    IsHeroMap[Result.second] = false;
+    for (const auto &Item : EventAdd.Description.Attributes)
     {
-      // init
-      IsHeroMap[Result.second] = false;
-      for (const auto &Item : EventAdd.Description.Attributes)
+      if (Item.Id == "role_name" && Item.Value == "hero")
       {
-        if (Item.Id == "role_name" && Item.Value == "hero")
-        {
-          // mark as hero
-          IsHeroMap[Result.second] = true;
-          break;
-        }
+        // mark as hero
+        IsHeroMap[Result.second] = true;
+        break;
       }
     }
   }
@@ -637,12 +892,13 @@ void CarlaReplayer::ProcessWeather(void)
 {
   uint16_t Total;
   CarlaRecorderWeather Weather;
+  DReyeVR::BinaryReader In = DReyeVR::ReadPacket(File, Header.Size, PacketBuffer);
 
   // read Total light events
-  ReadValue<uint16_t>(File, Total);
+  ReadValue<uint16_t>(In, Total);
   for (uint16_t i = 0; i < Total; ++i)
   {
-    Weather.Read(File);
+    Weather.Read(In);
     Helper.ProcessReplayerWeather(Weather);
   }
 }
@@ -651,15 +907,16 @@ template <typename T> void CarlaReplayer::ProcessDReyeVRData(double Per, double
 {
   uint16_t Total;
   // custom DReyeVR packets
+  DReyeVR::BinaryReader In = DReyeVR::ReadPacket(File, Header.Size, PacketBuffer);
 
   // read Total DReyeVR events
-  ReadValue<uint16_t>(File, Total); // read number of events
+  ReadValue<uint16_t>(In, Total); // read number of events
 
   Visited.clear();
   for (uint16_t i = 0; i < Total; ++i)
   {
     T DReyeVRDataInstance;
-    DReyeVRDataInstance.Read(File);
+    DReyeVRDataInstance.Read(In);
     Helper.ProcessReplayerDReyeVRData<T>(DReyeVRDataInstance, Per);
     if (!bShouldBeOnlyOne)
     {
@@ -690,6 +947,30 @@ template <typename T> void CarlaReplayer::ProcessDReyeVRData(double Per, double
   }
 }
 
+void CarlaReplayer::ProcessEyeSamples(void)
+{
+  uint16_t Total;
+  const DReyeVR::PackedEyeSample *Samples = DReyeVR::EyeSampleRecorder::Read(File, Total, PackedEyeSamples);
+  const size_t Start = EyeSamples.size();
+  EyeSamples.resize(Start + Total);
+  for (uint16_t i = 0; i < Total; ++i)
+  {
+    Samples[i].Unpack(EyeSamples[Start + i]);
+  }
+}
+
+void CarlaReplayer::ProcessAttention(void)
+{
+  DReyeVR::BinaryReader In = DReyeVR::ReadPacket(File, Header.Size, PacketBuffer);
+  DReyeVR::AttentionRecorder::Read(In, Attention);
+}
+
+void CarlaReplayer::ProcessGazeEvents(void)
+{
+  DReyeVR::BinaryReader In = DReyeVR::ReadPacket(File, Header.Size, PacketBuffer);
+  DReyeVR::GazeEventRecorder::Read(In, GazeEvents);
+}
+
 void CarlaReplayer::ProcessPositions(bool IsFirstTime)
 {
   uint16_t i, Total;
@@ -697,14 +978,18 @@ void CarlaReplayer::ProcessPositions(bool IsFirstTime)
   // save current as previous
   PrevPos = std::move(CurrPos);
 
-  // read all positions
+  // read all positions (in place if the file is memory-mapped)
   ReadValue<uint16_t>(File, Total);
   CurrPos.clear();
   CurrPos.reserve(Total);
+  const CarlaRecorderPosition *Positions = DReyeVR::ReadSpan<CarlaRecorderPosition>(File, Total);
   for (i = 0; i < Total; ++i)
   {
     CarlaRecorderPosition Pos;
-    Pos.Read(File);
+    if (Positions != nullptr)
+      Pos = Positions[i];
+    else
+      Pos.Read(File);
     // assign mapped Id
     auto NewId = MappedId.find(Pos.DatabaseId);
     if (NewId != MappedId.end())
@@ -723,6 +1008,54 @@ void CarlaReplayer::ProcessPositions(bool IsFirstTime)
   }
 }
 
+void CarlaReplayer::ProcessCompactPositions(bool IsFirstTime)
+{
+  // save current as previous
+  PrevPos = std::move(CurrPos);
+
+  // the decoder always gives back every live actor (the ones that did not move are not in the packet)
+  PositionDecoder.Read(File, Header.Size, CurrPos);
+  for (auto &Pos : CurrPos)
+  {
+    // assign mapped Id
+    auto NewId = MappedId.find(Pos.DatabaseId);
+    if (NewId != MappedId.end())
+    {
+      Pos.DatabaseId = NewId->second;
+    }
+    else
+      UE_LOG(LogCarla, Log, TEXT("Actor not found when trying to move from replayer (id. %d)"), Pos.DatabaseId);
+  }
+
+  // check to copy positions the first time
+  if (IsFirstTime)
+  {
+    PrevPos.clear();
+  }
+}
+
+void CarlaReplayer::ProcessCompactData(double Per, bool bApply)
+{
+  const std::vector<char> &Packet = DataDecoder.Read(File, Header.Size);
+  if (!bApply)
+  {
+    return;
+  }
+
+  // the decoded bytes are the original DReyeVR packet, so it is replayed like a regular one
+  DReyeVR::BinaryReader In(Packet);
+  In.Skip(sizeof(char) + sizeof(uint32_t)); // header of the original packet
+  uint16_t Total;
+  ReadValue<uint16_t>(In, Total);
+  check(Total == 1);
+  for (uint16_t i = 0; i < Total; ++i)
+  {
+    DReyeVRDataRecorder<DReyeVR::AggregateData> DReyeVRDataInstance;
+    DReyeVRDataInstance.Read(In);
+    Helper.ProcessReplayerDReyeVRData<DReyeVRDataRecorder<DReyeVR::AggregateData>>(DReyeVRDataInstance, Per);
+  }
+}
+
 void CarlaReplayer::UpdatePositions(double Per, double DeltaTime)
 {
   unsigned int i;
@@ -815,17 +1148,28 @@ void CarlaReplayer::ProcessFrameByFrame()
   {
     GetFrameStartTimes();
     ensure(FrameStartTimes.size() > 0);
+    // start from the first frame of the requested range (e.g. one shard of a sharded frame capture)
+    SyncCurrentFrameId = std::lower_bound(FrameStartTimes.begin(), FrameStartTimes.end(), SyncTimeStart) -
+        FrameStartTimes.begin();
+    // or later, if the frame capture already has those frames (resumed)
+    if (ADReyeVRSensor::GetDReyeVRSensor(Episode->GetWorld()))
+      SyncCurrentFrameId = ADReyeVRSensor::GetDReyeVRSensor()->BeginFrameCapture(
+          GetRecorderFilename(LastReplay.Filename), SyncCurrentFrameId);
+    SyncFirstFrameId = SyncCurrentFrameId;
+  }
+
+  // end of the requested range?
+  if (SyncCurrentFrameId >= FrameStartTimes.size() || FrameStartTimes[SyncCurrentFrameId] >= SyncTimeToStop)
+  {
+    StopSyncReplay();
+    return;
   }
 
   // process to those times
-  ensure(SyncCurrentFrameId < FrameStartTimes.size());
-  double LastTime = 0.f;
-  if (SyncCurrentFrameId > 0)
-    LastTime = FrameStartTimes[SyncCurrentFrameId - 1];
-  ProcessToTime(FrameStartTimes[SyncCurrentFrameId] - LastTime, (SyncCurrentFrameId == 0));
+  ProcessToTime(FrameStartTimes[SyncCurrentFrameId] - CurrentTime, (SyncCurrentFrameId == SyncFirstFrameId));
   if (ADReyeVRSensor::GetDReyeVRSensor(Episode->GetWorld()))
     // have the vehicle camera take a screenshot to record the replay
-    ADReyeVRSensor::GetDReyeVRSensor()->TakeScreenshot();
+    ADReyeVRSensor::GetDReyeVRSensor()->TakeScreenshot(Frame.Id, SyncCurrentFrameId);
   else
     DReyeVR_LOG_ERROR("No DReyeVR sensor available!");
 
@@ -833,7 +1177,17 @@ void CarlaReplayer::ProcessFrameByFrame()
   if (SyncCurrentFrameId < FrameStartTimes.size() - 1)
     SyncCurrentFrameId++;
   else
-    Stop();
+    StopSyncReplay();
+}
+
+void CarlaReplayer::StopSyncReplay()
+{
+  Stop();
+  if (bExitAfterSyncReplay)
+  {
+    DReyeVR_LOG("Synchronized replay done, exiting");
+    FPlatformMisc::RequestExit(false); // not forced, so the frame capture is flushed on the way out
+  }
 }
 
 void CarlaReplayer::Restart() 
@@ -880,6 +1234,12 @@ void CarlaReplayer::Advance(const float Amnt)
     // UE_LOG(LogTemp, Log, TEXT("Now the time is: %.3f"), Frame.Elapsed);
     // // back to negative
     // ProcessToTime(Amnt, false);
+    if (FrameIndex.FindKeyframe(FrameIndex.FindFrame(DesiredTime)) < FrameIndex.Num())
+    {
+      // there is a keyframe to jump back to, no need to restart from the beginning
+      ProcessToTime(Amnt, true);
+      return;
+    }
     Stop(true); // stops the replaying while keeping actors (dosen't destroy & respawn)
     Restart();
     ProcessToTime(DesiredTime, true);
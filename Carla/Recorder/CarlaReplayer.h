@@ -23,6 +23,13 @@
 #include "CarlaRecorderState.h"
 #include "CarlaRecorderHelpers.h"
 #include "CarlaReplayerHelper.h"
+#include "DReyeVRCompact.h"
+#include "DReyeVRFrameIndex.h"
+#include "DReyeVRAttention.h"
+#include "DReyeVREyeSamples.h"
+#include "DReyeVRGazeEvents.h"
+#include "DReyeVRKeyframe.h"
+#include "DReyeVRMappedFile.h"
 
 class UCarlaEpisode;
 
@@ -108,6 +115,12 @@ public:
   {
     bReplaySync = bSyncModeIn;
   }
+
+  // quit the simulator once a synchronized replay is done (e.g. one process of a sharded frame capture)
+  void SetExitAfterSyncReplay(bool bExitIn)
+  {
+    bExitAfterSyncReplay = bExitIn;
+  }
   
 private:
 
@@ -115,8 +128,10 @@ private:
   bool bReplaySensors = false;
   bool Paused = false;
   UCarlaEpisode *Episode = nullptr;
-  // binary file reader
+  // binary file reader (backed by a memory-mapping when possible)
   std::ifstream File;
+  DReyeVR::MappedFile Mapped;
+  std::vector<char> PacketBuffer; // packets read with DReyeVR::ReadPacket when the file is not memory-mapped
   Header Header;
   CarlaRecorderInfo RecInfo;
   CarlaRecorderFrame Frame;
@@ -148,15 +163,28 @@ private:
 
   void Rewind(void);
 
+  // frame index (from the recording trailer) for seeking without scanning the whole file
+  DReyeVR::FrameIndex FrameIndex;
+  void SeekWithIndex(double Time);
+  void ProcessFrameEvents(void);
+  void ProcessKeyframe(void);
+
   // processing packets
   void ProcessToTime(double Time, bool IsFirstTime = false);
 
   void ProcessEventsAdd(void);
+  void ProcessEventAdd(const CarlaRecorderEventAdd &EventAdd);
   void ProcessEventsDel(void);
   void ProcessEventsParent(void);
 
   void ProcessPositions(bool IsFirstTime = false);
 
+  // compact mode packets, decoded on every frame since they depend on the previous one
+  DReyeVR::CompactPositionDecoder PositionDecoder;
+  DReyeVR::CompactDataDecoder DataDecoder;
+  void ProcessCompactPositions(bool IsFirstTime = false);
+  void ProcessCompactData(double Per, bool bApply);
+
   void ProcessStates(void);
 
   void ProcessAnimVehicle(void);
@@ -171,6 +199,19 @@ private:
   template <typename T> void ProcessDReyeVRData(double Per, double DeltaTime, bool bShouldBeOnlyOne);
   std::unordered_set<std::string> Visited = {};
 
+  // high-rate eye tracker samples of the frames played in the current tick
+  void ProcessEyeSamples(void);
+  std::vector<DReyeVR::EyeTracker> EyeSamples;
+  std::vector<DReyeVR::PackedEyeSample> PackedEyeSamples; // scratch space when the file is not memory-mapped
+
+  // attention weights of the gaze cone of the frame played in the current tick
+  void ProcessAttention(void);
+  std::vector<DReyeVR::ActorAttention> Attention;
+
+  // fixations/saccades of the frames played in the current tick
+  void ProcessGazeEvents(void);
+  std::vector<DReyeVR::GazeEvent> GazeEvents;
+
   // For restarting the recording with the same params
   struct LastReplayStruct
   {
@@ -182,10 +223,16 @@ private:
   LastReplayStruct LastReplay;
 
   bool bReplaySync = false;
+  bool bExitAfterSyncReplay = false;
   std::vector<double> FrameStartTimes;
   size_t SyncCurrentFrameId = 0;
+  size_t SyncFirstFrameId = 0;
+  // a synchronized replay goes through the frames starting in [SyncTimeStart, SyncTimeToStop)
+  double SyncTimeStart = 0.0;
+  double SyncTimeToStop = 0.0;
   void GetFrameStartTimes();
   void ProcessFrameByFrame();
+  void StopSyncReplay();
 
   // positions
   void UpdatePositions(double Per, double DeltaTime);
@@ -0,0 +1,174 @@
+#include "DReyeVRAsyncWriter.h"
+
+#include <chrono>  // std::chrono::milliseconds
+#include <cstring> // std::memcpy
+
+namespace DReyeVR
+{
+
+void FrameStreamBuf::Reset()
+{
+    Buffer.clear();
+    Base = 0;
+    Put = 0;
+}
+
+void FrameStreamBuf::Take(size_t NumBytes, std::vector<char> &Out)
+{
+    Out.assign(Buffer.begin(), Buffer.begin() + NumBytes);
+    // keep the remaining bytes (the frame still being written) at the front, capacity is reused
+    Buffer.erase(Buffer.begin(), Buffer.begin() + NumBytes);
+    Put -= NumBytes;
+    Base += NumBytes;
+}
+
+std::streamsize FrameStreamBuf::xsputn(const char *Data, std::streamsize Count)
+{
+    if (Put + Count > Buffer.size())
+        Buffer.resize(Put + Count);
+    std::memcpy(Buffer.data() + Put, Data, Count);
+    Put += Count;
+    return Count;
+}
+
+FrameStreamBuf::int_type FrameStreamBuf::overflow(int_type Ch)
+{
+    if (traits_type::eq_int_type(Ch, traits_type::eof()))
+        return traits_type::not_eof(Ch);
+    const char C = traits_type::to_char_type(Ch);
+    xsputn(&C, 1);
+    return Ch;
+}
+
+FrameStreamBuf::pos_type FrameStreamBuf::seekoff(off_type Off, std::ios_base::seekdir Dir,
+                                                 std::ios_base::openmode Which)
+{
+    switch (Dir)
+    {
+    case std::ios_base::beg:
+        return seekpos(pos_type(Off), Which);
+    case std::ios_base::cur:
+        return seekpos(pos_type(static_cast<off_type>(Base + Put) + Off), Which);
+    case std::ios_base::end:
+        return seekpos(pos_type(static_cast<off_type>(GetEnd()) + Off), Which);
+    default:
+        return pos_type(off_type(-1));
+    }
+}
+
+FrameStreamBuf::pos_type FrameStreamBuf::seekpos(pos_type Pos, std::ios_base::openmode Which)
+{
+    const off_type Target = static_cast<off_type>(Pos);
+    // can only seek within what is still in memory
+    if (!(Which & std::ios_base::out) || Target < static_cast<off_type>(Base) ||
+        Target > static_cast<off_type>(GetEnd()))
+        return pos_type(off_type(-1));
+    Put = static_cast<size_t>(Target - Base);
+    return Pos;
+}
+
+AsyncWriter::~AsyncWriter()
+{
+    if (Thread.joinable())
+    {
+        bRunning = false;
+        Thread.join();
+    }
+}
+
+bool AsyncWriter::Open(const std::string &Filename, std::ofstream &Stream)
+{
+    OutFile.open(Filename, std::ios::binary);
+    if (!OutFile.is_open())
+        return false;
+
+    Buffer.Reset();
+    Slots.resize(QueueSize);
+    Head = 0;
+    Tail = 0;
+    Stalls = 0;
+    bFailed = false;
+    bRunning = true;
+    Thread = std::thread(&AsyncWriter::Run, this);
+
+    // everything written to Stream now goes to our buffer (ofstream::rdbuf hides the std::ios setter)
+    static_cast<std::ios &>(Stream).rdbuf(&Buffer);
+    return true;
+}
+
+void AsyncWriter::Close(std::ofstream &Stream)
+{
+    if (!bRunning)
+        return;
+
+    Commit(Buffer.GetEnd());
+    bRunning = false;
+    Thread.join();
+    OutFile.close();
+    Buffer.Reset();
+
+    // give the stream back its own (closed) file buffer
+    static_cast<std::ios &>(Stream).rdbuf(Stream.rdbuf());
+}
+
+bool AsyncWriter::IsFull() const
+{
+    return Head.load(std::memory_order_relaxed) - Tail.load(std::memory_order_acquire) >= Slots.size();
+}
+
+void AsyncWriter::Commit(uint64_t Offset)
+{
+    if (Offset <= Buffer.GetBase())
+        return;
+
+    if (IsFull())
+    {
+        // backpressure: wait for the writer thread to free up a slot
+        Stalls++;
+        while (IsFull())
+            std::this_thread::yield();
+    }
+
+    const size_t H = Head.load(std::memory_order_relaxed);
+    Buffer.Take(static_cast<size_t>(Offset - Buffer.GetBase()), Slots[H % Slots.size()]);
+    Head.store(H + 1, std::memory_order_release);
+}
+
+void AsyncWriter::Run()
+{
+    std::vector<char> Chunk;
+    Chunk.reserve(ChunkSize);
+    auto WriteChunk = [&]() {
+        if (Chunk.empty())
+            return;
+        OutFile.write(Chunk.data(), Chunk.size());
+        if (!OutFile)
+            bFailed = true;
+        Chunk.clear();
+    };
+
+    while (true)
+    {
+        // read this first so everything committed before Close is guaranteed to be drained below
+        const bool bStopping = !bRunning.load(std::memory_order_acquire);
+
+        size_t T = Tail.load(std::memory_order_relaxed);
+        while (T != Head.load(std::memory_order_acquire))
+        {
+            std::vector<char> &Slot = Slots[T % Slots.size()];
+            if (Chunk.size() + Slot.size() > ChunkSize)
+                WriteChunk();
+            Chunk.insert(Chunk.end(), Slot.begin(), Slot.end());
+            Slot.clear();
+            Tail.store(++T, std::memory_order_release);
+        }
+        WriteChunk();
+
+        if (bStopping)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    OutFile.flush();
+}
+
+}; // namespace DReyeVR
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Asynchronous backend for the recorder so the game thread never touches the disk.
+//
+// All the recorder packets are written through an std::ofstream (see the many Write(std::ofstream &) functions) so
+// instead of changing all of them, the recorder's stream gets its buffer swapped for an in-memory FrameStreamBuf.
+// Every frame is serialized into this (reused) buffer, including the tellp/seekp size backpatching, and once a frame
+// is complete its bytes are handed to a dedicated writer thread through a bounded lock-free (single-producer,
+// single-consumer) queue. The writer thread coalesces them into large contiguous writes.
+//
+// The bytes that reach the file are exactly the same as writing directly to the std::ofstream. Note that the
+// FrameStart packet of every frame patches the duration of the previous frame, so the latest frame is always kept
+// in the buffer until the next one starts (see ACarlaRecorder::Write).
+
+namespace DReyeVR
+{
+
+// growable in-memory stream buffer that also supports seeking (within what has not been committed yet)
+class CARLA_API FrameStreamBuf : public std::streambuf
+{
+  public:
+    void Reset();
+    uint64_t GetBase() const
+    {
+        return Base;
+    }
+    uint64_t GetEnd() const
+    {
+        return Base + Buffer.size();
+    }
+    // moves the first NumBytes out of the buffer (into Out) and advances the base offset
+    void Take(size_t NumBytes, std::vector<char> &Out);
+
+  protected:
+    std::streamsize xsputn(const char *Data, std::streamsize Count) override;
+    int_type overflow(int_type Ch) override;
+    pos_type seekoff(off_type Off, std::ios_base::seekdir Dir, std::ios_base::openmode Which) override;
+    pos_type seekpos(pos_type Pos, std::ios_base::openmode Which) override;
+
+  private:
+    std::vector<char> Buffer; // bytes that have not been committed to the writer thread
+    uint64_t Base = 0;        // file offset of Buffer[0]
+    size_t Put = 0;           // write position within Buffer
+};
+
+class CARLA_API AsyncWriter
+{
+  public:
+    ~AsyncWriter();
+
+    // opens the file, starts the writer thread, and redirects Stream into the in-memory buffer
+    bool Open(const std::string &Filename, std::ofstream &Stream);
+    // commits everything still in the buffer, waits for the writer thread, and restores Stream
+    void Close(std::ofstream &Stream);
+    bool IsOpen() const
+    {
+        return bRunning;
+    }
+
+    // hand all the bytes before Offset over to the writer thread (blocks while the queue is full)
+    void Commit(uint64_t Offset);
+    // true when the next Commit would block
+    bool IsFull() const;
+
+    uint64_t GetStalls() const
+    {
+        return Stalls;
+    }
+    bool HasFailed() const
+    {
+        return bFailed;
+    }
+
+  private:
+    void Run();
+
+    static constexpr size_t QueueSize = 64;       // max frames in flight
+    static constexpr size_t ChunkSize = 1 << 20;  // writer thread writes in chunks of (up to) this many bytes
+
+    FrameStreamBuf Buffer;
+    std::ofstream OutFile;
+    std::thread Thread;
+
+    // bounded SPSC ring of reusable frame buffers
+    std::vector<std::vector<char>> Slots;
+    std::atomic<size_t> Head{0}; // next slot to fill (game thread)
+    std::atomic<size_t> Tail{0}; // next slot to write (writer thread)
+
+    std::atomic<bool> bRunning{false};
+    std::atomic<bool> bFailed{false};
+    uint64_t Stalls = 0; // number of times the game thread had to wait for the writer
+};
+
+}; // namespace DReyeVR
@@ -0,0 +1,57 @@
+#include "DReyeVRAttention.h"
+#include "CarlaRecorderHelpers.h" // WriteValue, ReadValue, WriteFString, ReadFString
+
+#include <algorithm> // std::min
+#include <sstream>
+
+namespace DReyeVR
+{
+
+void AttentionRecorder::Set(const std::vector<ActorAttention> &NewAttention)
+{
+    Attention = NewAttention;
+}
+
+void AttentionRecorder::Clear()
+{
+    Attention.clear();
+}
+
+void AttentionRecorder::Write(std::ofstream &OutFile)
+{
+    const size_t Offset = Packet.BeginPacket(static_cast<char>(DREYEVR_ATTENTION_PACKET_ID));
+    const uint16_t Total = static_cast<uint16_t>(std::min<size_t>(Attention.size(), UINT16_MAX));
+    WriteValue<uint16_t>(Packet, Total);
+    for (uint16_t i = 0; i < Total; ++i)
+    {
+        WriteFString(Packet, Attention[i].ActorNameTag);
+        WriteValue<float>(Packet, Attention[i].Weight);
+    }
+    Packet.EndPacket(Offset);
+    Packet.Flush(OutFile);
+}
+
+void AttentionRecorder::Read(BinaryReader &In, std::vector<ActorAttention> &Out)
+{
+    uint16_t Total = 0;
+    ReadValue<uint16_t>(In, Total);
+    Out.resize(Total);
+    for (uint16_t i = 0; i < Total && !In.HasFailed(); ++i)
+    {
+        Out[i].Actor = nullptr; // only the name is recorded
+        ReadFString(In, Out[i].ActorNameTag);
+        ReadValue<float>(In, Out[i].Weight);
+    }
+    if (In.HasFailed())
+        Out.clear(); // truncated packet
+}
+
+std::string AttentionRecorder::Print(const std::vector<ActorAttention> &Attention)
+{
+    std::ostringstream oss;
+    for (const ActorAttention &A : Attention)
+        oss << "  " << TCHAR_TO_UTF8(*A.ActorNameTag) << ": " << A.Weight << std::endl;
+    return oss.str();
+}
+
+}; // namespace DReyeVR
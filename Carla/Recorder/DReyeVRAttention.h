@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Carla/Sensor/DReyeVRData.h" // DReyeVR::ActorAttention
+#include "DReyeVRBinaryIO.h"          // DReyeVR::BinaryWriter, DReyeVR::BinaryReader
+
+// Per-actor attention weights of the gaze cone (see AEgoSensor::ComputeAttention), written once per frame after the
+// eye samples as [uint16 Total] then Total times [FString ActorNameTag][float Weight] (largest weight first). Frames
+// without any actor in the cone (or recordings made with the cone disabled) have no such packet, and older readers
+// just skip it.
+
+#define DREYEVR_ATTENTION_PACKET_ID 146
+
+namespace DReyeVR
+{
+
+class CARLA_API AttentionRecorder
+{
+  public:
+    // the latest weights of the frame (they only change once per tick)
+    void Set(const std::vector<ActorAttention> &NewAttention);
+    void Clear();
+    bool IsEmpty() const
+    {
+        return Attention.empty();
+    }
+    void Write(std::ofstream &OutFile);
+
+    // reads the packet contents (after the header)
+    static void Read(BinaryReader &In, std::vector<ActorAttention> &Out);
+    static std::string Print(const std::vector<ActorAttention> &Attention);
+
+  private:
+    std::vector<ActorAttention> Attention;
+    BinaryWriter Packet;
+};
+
+}; // namespace DReyeVR
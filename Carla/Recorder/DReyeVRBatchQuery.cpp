@@ -0,0 +1,451 @@
+#include "DReyeVRBatchQuery.h"
+#include "CarlaRecorder.h"        // CarlaRecorderPacketId
+#include "CarlaRecorderHelpers.h" // ReadValue
+
+#include <algorithm> // std::min, std::max
+#include <atomic>
+#include <iomanip>
+#include <iterator> // std::back_inserter
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace DReyeVR
+{
+
+void SessionStats::Merge(const SessionStats &Other)
+{
+    Frames += Other.Frames;
+    Duration += Other.Duration;
+    Collisions += Other.Collisions;
+    Blocked += Other.Blocked;
+    for (size_t i = 0; i < PacketCount.size(); i++)
+    {
+        PacketCount[i] += Other.PacketCount[i];
+        PacketBytes[i] += Other.PacketBytes[i];
+    }
+}
+
+std::string BatchResult::Summary() const
+{
+    std::ostringstream Info;
+    size_t Failed = 0;
+    for (const SessionStats &Session : Sessions)
+    {
+        if (!Session.Error.empty())
+        {
+            Info << Session.Filename << ": " << Session.Error << std::endl;
+            Failed++;
+        }
+    }
+    Info << "Sessions: " << Sessions.size() - Failed << " (" << Failed << " failed)" << std::endl;
+    Info << "Frames: " << Total.Frames << std::endl;
+    Info << "Duration: " << Total.Duration << " seconds" << std::endl;
+    Info << "Collisions: " << Total.Collisions << std::endl;
+    Info << "Blocked actors: " << Total.Blocked << std::endl;
+    Info << "Packets:" << std::endl;
+    for (size_t i = 0; i < Total.PacketCount.size(); i++)
+    {
+        if (Total.PacketCount[i] > 0)
+            Info << std::setw(5) << i << std::setw(12) << Total.PacketCount[i] << " packets" << std::setw(14)
+                 << Total.PacketBytes[i] << " bytes" << std::endl;
+    }
+    return Info.str();
+}
+
+namespace
+{
+
+struct SessionResult
+{
+    SessionStats Stats;
+    std::vector<CollisionRecord> Collisions;
+    std::vector<BlockedRecord> Blocked;
+};
+
+// scans one recording at a time (every worker thread owns one of these)
+class SessionScanner
+{
+  public:
+    SessionScanner(const QueryFilter &InFilter) : Filter(InFilter)
+    {
+        for (uint8_t Id : Filter.Packets)
+            bCountPacket[Id] = true;
+        if (Filter.Packets.empty())
+            bCountPacket.fill(true);
+    }
+
+    void Scan(const std::string &Filename, uint32_t InSession, SessionResult &Out);
+
+  private:
+    struct ActorInfo
+    {
+        uint8_t Type = 0;
+        std::string Id;
+        // blocked query
+        FVector LastPosition = FVector(0, 0, 0);
+        double Time = 0.0;
+        double Duration = 0.0;
+    };
+
+    struct PairHash
+    {
+        size_t operator()(const std::pair<uint32_t, uint32_t> &P) const
+        {
+            return (static_cast<size_t>(P.first) << 32) ^ P.second;
+        }
+    };
+
+    bool Step(SessionResult &Out); // processes the next packet, false at the end of the file or after TimeEnd
+    void SkipToWindow(const FrameIndex &Index);
+    void SkipFrame(SessionResult &Out);
+    char Category(uint32_t DatabaseId) const;
+    void AddCollision(const CarlaRecorderCollision &Collision, SessionResult &Out);
+    void AddPosition(const CarlaRecorderPosition &Position, SessionResult &Out);
+    void AddBlocked(uint32_t Id, const ActorInfo &Actor, SessionResult &Out) const;
+
+    const QueryFilter &Filter;
+    std::array<bool, 256> bCountPacket = {};
+    std::ifstream File;
+    MappedFile Mapped;
+    std::vector<char> PacketBuffer; // packets read with ReadPacket when the file is not memory-mapped
+    uint32_t Session = 0;
+    char Id = 0;
+    uint32_t Size = 0;
+    CarlaRecorderFrame Frame;
+    bool bInWindow = false;
+    bool bSkipping = false; // visiting frames before the window (these can include the first frame of the window)
+    bool bRestoreKeyframe = false;
+    std::unordered_map<uint32_t, ActorInfo> Actors;
+    std::unordered_set<std::pair<uint32_t, uint32_t>, PairHash> OldCollisions, NewCollisions;
+    CompactPositionDecoder PositionDecoder;
+    std::vector<CarlaRecorderPosition> CompactPositions;
+};
+
+void SessionScanner::Scan(const std::string &Filename, uint32_t InSession, SessionResult &Out)
+{
+    Out.Stats.Filename = Filename;
+    Session = InSession;
+    Actors.clear();
+    OldCollisions.clear();
+    NewCollisions.clear();
+    PositionDecoder.Reset();
+    Frame.Elapsed = -1.0;
+    Frame.DurationThis = 0.0;
+    bInWindow = false;
+
+    if (!Mapped.Open(File, Filename, Filter.bMapFiles))
+    {
+        Out.Stats.Error = "file not found";
+        return;
+    }
+    CarlaRecorderInfo RecInfo;
+    RecInfo.Read(File);
+    if (!File || RecInfo.Magic != "CARLA_RECORDER")
+    {
+        Out.Stats.Error = "not a CARLA recorder file";
+        Mapped.Close(File);
+        return;
+    }
+
+    // seek close to TimeStart rather than decoding everything before it
+    FrameIndex Index;
+    if (Filter.TimeStart > 0.0 && Index.Read(File))
+        SkipToWindow(Index);
+
+    while (Step(Out))
+        ;
+
+    // actors that were still blocked at the end
+    if (Filter.bBlocked)
+    {
+        for (const auto &Actor : Actors)
+            AddBlocked(Actor.first, Actor.second, Out);
+    }
+    Out.Stats.Collisions = Out.Collisions.size();
+    Out.Stats.Blocked = Out.Blocked.size();
+
+    Mapped.Close(File);
+}
+
+void SessionScanner::SkipToWindow(const FrameIndex &Index)
+{
+    const size_t Target = Index.FindFrame(Filter.TimeStart);
+    size_t First = 0;
+    bSkipping = true;
+
+    // the closest keyframe gives all the live actors (the actor names/types are needed by every query)
+    const size_t Key = Index.FindKeyframe(Target);
+    if (Key < Index.Num())
+    {
+        File.seekg(Index[Key].Offset, std::ios::beg);
+        bRestoreKeyframe = true;
+        SessionResult Ignored;
+        SkipFrame(Ignored);
+        bRestoreKeyframe = false;
+        First = Key + 1;
+    }
+
+    // only the frames with events (or delta-coded positions, when they are needed) from there to the target
+    const uint8_t Mask = FRAME_HAS_EVENTS | (Filter.bBlocked ? FRAME_DELTA : FRAME_NONE);
+    for (size_t i = First; i < Target; ++i)
+    {
+        if (Index[i].Flags & Mask)
+        {
+            File.seekg(Index[i].Offset, std::ios::beg);
+            SessionResult Ignored;
+            SkipFrame(Ignored);
+        }
+    }
+    File.seekg(Index[Target].Offset, std::ios::beg);
+    bSkipping = false;
+    NewCollisions.clear();
+}
+
+void SessionScanner::SkipFrame(SessionResult &Out)
+{
+    // frames before the window only update the actors
+    while (Step(Out) && Id != static_cast<char>(CarlaRecorderPacketId::FrameEnd))
+        ;
+}
+
+bool SessionScanner::Step(SessionResult &Out)
+{
+    ReadValue<char>(File, Id);
+    ReadValue<uint32_t>(File, Size);
+    if (!File)
+        return false;
+
+    const std::streampos End = File.tellg() + static_cast<std::streamoff>(Size);
+    uint16_t Total = 0;
+    switch (Id)
+    {
+    case static_cast<char>(CarlaRecorderPacketId::FrameStart):
+        Frame.Read(File);
+        if (Frame.Elapsed > Filter.TimeEnd)
+            return false;
+        bInWindow = (!bSkipping && Frame.Elapsed + Frame.DurationThis >= Filter.TimeStart);
+        if (bInWindow)
+        {
+            Out.Stats.Frames++;
+            Out.Stats.Duration += Frame.DurationThis;
+        }
+        // to know if a collision is new or continues from the previous frame
+        OldCollisions = std::move(NewCollisions);
+        NewCollisions.clear();
+        break;
+
+    case static_cast<char>(CarlaRecorderPacketId::EventAdd):
+        ReadValue<uint16_t>(File, Total);
+        for (uint16_t i = 0; i < Total; ++i)
+        {
+            CarlaRecorderEventAdd EventAdd;
+            EventAdd.Read(File);
+            ActorInfo &Actor = Actors[EventAdd.DatabaseId];
+            Actor = ActorInfo();
+            Actor.Type = EventAdd.Type;
+            Actor.Id = TCHAR_TO_UTF8(*EventAdd.Description.Id);
+        }
+        break;
+
+    case static_cast<char>(CarlaRecorderPacketId::EventDel):
+        ReadValue<uint16_t>(File, Total);
+        for (uint16_t i = 0; i < Total; ++i)
+        {
+            CarlaRecorderEventDel EventDel;
+            EventDel.Read(File);
+            auto It = Actors.find(EventDel.DatabaseId);
+            if (It != Actors.end())
+            {
+                if (Filter.bBlocked && bInWindow)
+                    AddBlocked(It->first, It->second, Out);
+                Actors.erase(It);
+            }
+        }
+        break;
+
+    case static_cast<char>(CarlaRecorderPacketId::DReyeVRKeyframe):
+        if (bRestoreKeyframe)
+        {
+            Keyframe Key;
+            BinaryReader In = ReadPacket(File, Size, PacketBuffer);
+            Key.Read(In);
+            Actors.clear();
+            for (const CarlaRecorderEventAdd &EventAdd : Key.Actors)
+            {
+                ActorInfo &Actor = Actors[EventAdd.DatabaseId];
+                Actor.Type = EventAdd.Type;
+                Actor.Id = TCHAR_TO_UTF8(*EventAdd.Description.Id);
+            }
+        }
+        break;
+
+    case static_cast<char>(CarlaRecorderPacketId::Collision):
+        if (Filter.bCollisions && bInWindow)
+        {
+            ReadValue<uint16_t>(File, Total);
+            for (uint16_t i = 0; i < Total; ++i)
+            {
+                CarlaRecorderCollision Collision;
+                Collision.Read(File);
+                AddCollision(Collision, Out);
+            }
+        }
+        break;
+
+    case static_cast<char>(CarlaRecorderPacketId::Position):
+        if (Filter.bBlocked && bInWindow)
+        {
+            ReadValue<uint16_t>(File, Total);
+            const CarlaRecorderPosition *Positions = ReadSpan<CarlaRecorderPosition>(File, Total);
+            for (uint16_t i = 0; i < Total; ++i)
+            {
+                CarlaRecorderPosition Position;
+                if (Positions != nullptr)
+                    Position = Positions[i];
+                else
+                    Position.Read(File);
+                AddPosition(Position, Out);
+            }
+        }
+        break;
+
+    case static_cast<char>(CarlaRecorderPacketId::DReyeVRCompactPositions):
+        // the decoder has to see every frame once positions are needed at all
+        if (Filter.bBlocked && bInWindow)
+        {
+            PositionDecoder.Read(File, Size, CompactPositions);
+            for (const CarlaRecorderPosition &Position : CompactPositions)
+                AddPosition(Position, Out);
+        }
+        else if (Filter.bBlocked)
+            PositionDecoder.Skip(File, Size);
+        break;
+
+    default:
+        break;
+    }
+
+    if (bInWindow && bCountPacket[static_cast<uint8_t>(Id)])
+    {
+        Out.Stats.PacketCount[static_cast<uint8_t>(Id)]++;
+        Out.Stats.PacketBytes[static_cast<uint8_t>(Id)] += sizeof(char) + sizeof(uint32_t) + Size;
+    }
+
+    // everything that was not decoded above is skipped by its header
+    File.seekg(End, std::ios::beg);
+    return static_cast<bool>(File);
+}
+
+char SessionScanner::Category(uint32_t DatabaseId) const
+{
+    // other, vehicle, walkers, trafficLight, hero, any (same as CarlaRecorderQuery)
+    static const char Categories[] = {'o', 'v', 'w', 't', 'h', 'a'};
+    auto It = Actors.find(DatabaseId);
+    if (DatabaseId == uint32_t(-1) || It == Actors.end() || It->second.Type >= sizeof(Categories))
+        return 'o'; // other non-actor object
+    return Categories[It->second.Type];
+}
+
+void SessionScanner::AddCollision(const CarlaRecorderCollision &Collision, SessionResult &Out)
+{
+    const char Type1 = Category(Collision.DatabaseId1);
+    const char Type2 = Category(Collision.DatabaseId2);
+    const bool bValid1 = (Filter.Category1 == 'a' || Filter.Category1 == Type1 ||
+                          (Filter.Category1 == 'h' && Collision.IsActor1Hero));
+    const bool bValid2 = (Filter.Category2 == 'a' || Filter.Category2 == Type2 ||
+                          (Filter.Category2 == 'h' && Collision.IsActor2Hero));
+    if (!bValid1 || !bValid2)
+        return;
+
+    // only the first frame of every collision is reported
+    auto Pair = std::make_pair(Collision.DatabaseId1, Collision.DatabaseId2);
+    if (OldCollisions.count(Pair) == 0)
+    {
+        CollisionRecord Record;
+        Record.Session = Session;
+        Record.Frame = Frame.Id;
+        Record.Time = Frame.Elapsed;
+        Record.Id1 = Collision.DatabaseId1;
+        Record.Id2 = Collision.DatabaseId2;
+        Record.Type1 = Type1;
+        Record.Type2 = Type2;
+        auto It1 = Actors.find(Collision.DatabaseId1);
+        auto It2 = Actors.find(Collision.DatabaseId2);
+        Record.Actor1 = (It1 != Actors.end() ? It1->second.Id : "");
+        Record.Actor2 = (It2 != Actors.end() ? It2->second.Id : "");
+        Out.Collisions.push_back(std::move(Record));
+    }
+    NewCollisions.insert(Pair);
+}
+
+void SessionScanner::AddPosition(const CarlaRecorderPosition &Position, SessionResult &Out)
+{
+    ActorInfo &Actor = Actors[Position.DatabaseId];
+    // check if actor moved less than a distance
+    if (FVector::Distance(Actor.LastPosition, Position.Location) < Filter.BlockedMinDistance)
+    {
+        // actor stopped
+        if (Actor.Duration == 0)
+            Actor.Time = Frame.Elapsed;
+        Actor.Duration += Frame.DurationThis;
+    }
+    else
+    {
+        AddBlocked(Position.DatabaseId, Actor, Out);
+        // actor moving
+        Actor.Duration = 0;
+        Actor.LastPosition = Position.Location;
+    }
+}
+
+void SessionScanner::AddBlocked(uint32_t DatabaseId, const ActorInfo &Actor, SessionResult &Out) const
+{
+    if (Actor.Duration < Filter.BlockedMinTime)
+        return;
+    const char Type = Category(DatabaseId);
+    if (Filter.Category1 != 'a' && Filter.Category1 != Type)
+        return;
+    Out.Blocked.push_back(BlockedRecord{Session, DatabaseId, Actor.Id, Actor.Time, Actor.Duration});
+}
+
+}; // namespace
+
+BatchResult BatchQuery::Run(const std::vector<std::string> &Filenames, const QueryFilter &Filter, unsigned Threads)
+{
+    if (Threads == 0)
+        Threads = std::max(1u, std::thread::hardware_concurrency());
+    Threads = static_cast<unsigned>(std::min<size_t>(Threads, std::max<size_t>(1, Filenames.size())));
+
+    // the workers take the next file as soon as they are done with one (sessions vary a lot in length)
+    std::vector<SessionResult> Results(Filenames.size());
+    std::atomic<size_t> Next(0);
+    auto Worker = [&]() {
+        SessionScanner Scanner(Filter);
+        for (size_t i = Next++; i < Filenames.size(); i = Next++)
+            Scanner.Scan(Filenames[i], static_cast<uint32_t>(i), Results[i]);
+    };
+    std::vector<std::thread> Pool;
+    for (unsigned i = 1; i < Threads; i++)
+        Pool.emplace_back(Worker);
+    Worker();
+    for (std::thread &Thread : Pool)
+        Thread.join();
+
+    // concatenate in the order of the input files
+    BatchResult Result;
+    Result.Total.Filename = "total";
+    Result.Sessions.reserve(Results.size());
+    for (SessionResult &Session : Results)
+    {
+        if (Session.Stats.Error.empty())
+            Result.Total.Merge(Session.Stats);
+        Result.Sessions.push_back(std::move(Session.Stats));
+        std::move(Session.Collisions.begin(), Session.Collisions.end(), std::back_inserter(Result.Collisions));
+        std::move(Session.Blocked.begin(), Session.Blocked.end(), std::back_inserter(Result.Blocked));
+    }
+    return Result;
+}
+
+}; // namespace DReyeVR
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Queries over many recordings at once (e.g. all the sessions of a study) that return records instead of the
+// formatted text of CarlaRecorderQuery, and that do not need a map reload per file.
+//
+// Every file is scanned exactly once on a pool of worker threads (each with its own memory-mapped file) and the
+// filters are pushed down into the scan:
+// - packets that none of the requested results need are skipped by their header without being decoded
+// - with a frame index, the time window is applied by seeking: before TimeStart only the closest keyframe and the
+//   frames with events are visited, and the scan stops at the first frame after TimeEnd
+// - actor categories are compared as soon as a record is decoded, before any string is copied into a result
+// The per-file statistics are merged into totals at the end, so cross-session aggregates come out of the same pass.
+
+namespace DReyeVR
+{
+
+struct QueryFilter
+{
+    // only frames that overlap [TimeStart, TimeEnd] (seconds since the start of each recording) are considered
+    double TimeStart = 0.0;
+    double TimeEnd = std::numeric_limits<double>::max();
+    // actor categories like in CarlaRecorderQuery: 'o'ther, 'v'ehicle, 'w'alker, 't'raffic light, 'h'ero, 'a'ny
+    char Category1 = 'a'; // collisions: first actor, blocked: the blocked actor
+    char Category2 = 'a'; // collisions: second actor
+    // results to compute
+    bool bCollisions = true;
+    bool bBlocked = false;
+    double BlockedMinTime = 30.0;     // same as the MinTime of QueryBlocked
+    double BlockedMinDistance = 10.0; // same as the MinDistance of QueryBlocked
+    // packet ids counted in the statistics (empty for all)
+    std::vector<uint8_t> Packets;
+    // memory-map the recordings (false reads them through plain file streams)
+    bool bMapFiles = true;
+};
+
+struct CollisionRecord
+{
+    uint32_t Session; // index into BatchResult::Sessions
+    uint64_t Frame;
+    double Time;
+    uint32_t Id1, Id2;
+    char Type1, Type2;
+    std::string Actor1, Actor2;
+};
+
+struct BlockedRecord
+{
+    uint32_t Session; // index into BatchResult::Sessions
+    uint32_t Id;
+    std::string Actor;
+    double Time;     // when the actor stopped
+    double Duration; // how long it did not move
+};
+
+struct SessionStats
+{
+    std::string Filename;
+    std::string Error; // empty if the file was read successfully
+    uint64_t Frames = 0;
+    double Duration = 0.0;
+    uint64_t Collisions = 0;
+    uint64_t Blocked = 0;
+    std::array<uint64_t, 256> PacketCount = {};
+    std::array<uint64_t, 256> PacketBytes = {}; // including the packet headers
+    void Merge(const SessionStats &Other);
+};
+
+struct CARLA_API BatchResult
+{
+    std::vector<SessionStats> Sessions; // in the same order as the input files
+    SessionStats Total;                 // all the (successfully read) sessions merged
+    std::vector<CollisionRecord> Collisions;
+    std::vector<BlockedRecord> Blocked;
+    std::string Summary() const;
+};
+
+class CARLA_API BatchQuery
+{
+  public:
+    // Filenames are full paths (see GetRecorderFilename), Threads = 0 uses one thread per core
+    static BatchResult Run(const std::vector<std::string> &Filenames, const QueryFilter &Filter, unsigned Threads = 0);
+};
+
+}; // namespace DReyeVR
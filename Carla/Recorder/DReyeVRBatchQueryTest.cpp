@@ -0,0 +1,107 @@
+#include "DReyeVRBatchQuery.h"
+#include "CarlaRecorder.h" // CarlaRecorderInfo, CarlaRecorderFrames, CarlaRecorderEventsAdd, CarlaRecorderCollisions
+
+#include "HAL/FileManager.h" // IFileManager
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h" // FPaths
+
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Run with "Automation RunTests DReyeVR.Recorder" (editor console or -ExecCmds)
+
+static FString TestActorName(uint32_t Session, uint32_t DatabaseId)
+{
+    // distinct per session and long enough to never fit in a small string buffer
+    const TCHAR Fill = static_cast<TCHAR>(TEXT('a') + Session % 26);
+    return FString::Printf(TEXT("vehicle.session%u.actor%u."), Session, DatabaseId) + FString::ChrN(200, Fill);
+}
+
+// every frame (re)adds all the actors, so most of a scan is decoding their names, and actor 1 hits a new one
+static bool WriteTestRecording(const std::string &Filename, uint32_t Session, uint32_t NumActors)
+{
+    std::ofstream File(Filename, std::ios::binary);
+    CarlaRecorderInfo Info;
+    Info.Version = 1;
+    Info.Magic = TEXT("CARLA_RECORDER");
+    Info.Date = std::time(0);
+    Info.Mapfile = TEXT("Town03");
+    Info.Write(File);
+
+    CarlaRecorderFrames Frames;
+    CarlaRecorderEventsAdd EventsAdd;
+    CarlaRecorderCollisions Collisions;
+    for (uint32_t Hit = 2; Hit <= NumActors; Hit++)
+    {
+        Frames.SetFrame(0.05);
+        Frames.WriteStart(File);
+        for (uint32_t Id = 1; Id <= NumActors; Id++)
+        {
+            CarlaRecorderEventAdd EventAdd;
+            EventAdd.DatabaseId = Id;
+            EventAdd.Type = 1; // vehicle
+            EventAdd.Location = FVector(0, 0, 0);
+            EventAdd.Rotation = FVector(0, 0, 0);
+            EventAdd.Description.UId = Id;
+            EventAdd.Description.Id = TestActorName(Session, Id);
+            EventsAdd.Add(EventAdd);
+        }
+        CarlaRecorderCollision Collision;
+        Collision.Id = Hit;
+        Collision.DatabaseId1 = 1;
+        Collision.DatabaseId2 = Hit;
+        Collision.IsActor1Hero = false;
+        Collision.IsActor2Hero = false;
+        Collisions.Add(Collision);
+        EventsAdd.Write(File);
+        Collisions.Write(File);
+        Frames.WriteEnd(File);
+        EventsAdd.Clear();
+        Collisions.Clear();
+    }
+    return static_cast<bool>(File);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDReyeVRBatchQueryUnmappedTest, "DReyeVR.Recorder.BatchQuery.UnmappedFiles",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDReyeVRBatchQueryUnmappedTest::RunTest(const FString &Parameters)
+{
+    // several sessions scanned at once, all of them through plain file streams (not memory-mapped)
+    const uint32_t NumSessions = 8;
+    const uint32_t NumActors = 64;
+    const FString Dir = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("DReyeVRBatchQuery"));
+    IFileManager::Get().MakeDirectory(*Dir, true);
+    std::vector<std::string> Filenames;
+    for (uint32_t Session = 0; Session < NumSessions; Session++)
+    {
+        const FString Filename = Dir / FString::Printf(TEXT("session%u.log"), Session);
+        Filenames.push_back(TCHAR_TO_UTF8(*Filename));
+        if (!TestTrue(TEXT("Recording written"), WriteTestRecording(Filenames.back(), Session, NumActors)))
+            return false;
+    }
+
+    DReyeVR::QueryFilter Filter;
+    Filter.bMapFiles = false;
+    const DReyeVR::BatchResult Result = DReyeVR::BatchQuery::Run(Filenames, Filter, NumSessions);
+    IFileManager::Get().DeleteDirectory(*Dir, false, true);
+
+    for (const DReyeVR::SessionStats &Session : Result.Sessions)
+        TestTrue(TEXT("Session read"), Session.Error.empty());
+    TestEqual(TEXT("Collisions"), static_cast<int32>(Result.Collisions.size()),
+              static_cast<int32>(NumSessions * (NumActors - 1)));
+    for (const DReyeVR::CollisionRecord &Collision : Result.Collisions)
+    {
+        TestEqual(TEXT("Actor1"), FString(UTF8_TO_TCHAR(Collision.Actor1.c_str())),
+                  TestActorName(Collision.Session, Collision.Id1));
+        TestEqual(TEXT("Actor2"), FString(UTF8_TO_TCHAR(Collision.Actor2.c_str())),
+                  TestActorName(Collision.Session, Collision.Id2));
+    }
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
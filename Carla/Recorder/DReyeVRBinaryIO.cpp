@@ -0,0 +1,111 @@
+#include "DReyeVRBinaryIO.h"
+#include "DReyeVRMappedFile.h" // MappedStreamBuf, ReadView
+
+#include <streambuf>
+
+namespace DReyeVR
+{
+
+namespace
+{
+// appends everything written to it to a BinaryWriter's bytes
+class AppendStreamBuf : public std::streambuf
+{
+  public:
+    std::vector<char> *Bytes = nullptr;
+
+  protected:
+    std::streamsize xsputn(const char *Data, std::streamsize Count) override
+    {
+        Bytes->insert(Bytes->end(), Data, Data + Count);
+        return Count;
+    }
+    int_type overflow(int_type Ch) override
+    {
+        if (!traits_type::eq_int_type(Ch, traits_type::eof()))
+            Bytes->push_back(traits_type::to_char_type(Ch));
+        return traits_type::not_eof(Ch);
+    }
+};
+
+// the streams are only used for the duration of a single Write/Read call so one per thread is enough
+struct LegacyStreams
+{
+    std::ofstream Out;
+    AppendStreamBuf OutBuffer;
+    std::ifstream In;
+    MappedStreamBuf InBuffer;
+};
+
+LegacyStreams &GetLegacyStreams()
+{
+    thread_local LegacyStreams Streams;
+    return Streams;
+}
+} // namespace
+
+size_t BinaryWriter::BeginPacket(char Id)
+{
+    const size_t Offset = Bytes.size();
+    Write<char>(Id);
+    Write<uint32_t>(0); // patched in EndPacket
+    return Offset;
+}
+
+void BinaryWriter::EndPacket(size_t Offset)
+{
+    const uint32_t Total = static_cast<uint32_t>(Bytes.size() - Offset - sizeof(char) - sizeof(uint32_t));
+    std::memcpy(Bytes.data() + Offset + sizeof(char), &Total, sizeof(uint32_t));
+}
+
+void BinaryWriter::Flush(std::ofstream &OutFile)
+{
+    OutFile.write(Bytes.data(), Bytes.size());
+    Bytes.clear();
+}
+
+std::ofstream &BinaryWriter::OpenStream()
+{
+    LegacyStreams &Streams = GetLegacyStreams();
+    Streams.OutBuffer.Bytes = &Bytes;
+    // ofstream::rdbuf hides the std::ios setter
+    static_cast<std::ios &>(Streams.Out).rdbuf(&Streams.OutBuffer);
+    Streams.Out.clear();
+    return Streams.Out;
+}
+
+std::ifstream &BinaryReader::OpenStream()
+{
+    LegacyStreams &Streams = GetLegacyStreams();
+    Streams.InBuffer.SetData(Begin + Pos, Size - Pos);
+    // ifstream::rdbuf hides the std::ios setter
+    static_cast<std::ios &>(Streams.In).rdbuf(&Streams.InBuffer);
+    Streams.In.clear();
+    return Streams.In;
+}
+
+bool BinaryReader::CloseStream()
+{
+    std::ifstream &In = GetLegacyStreams().In;
+    if (!In)
+    {
+        // read past the end
+        bFailed = true;
+        Pos = Size;
+        return false;
+    }
+    Pos += static_cast<size_t>(In.tellg());
+    return true;
+}
+
+BinaryReader ReadPacket(std::ifstream &InFile, size_t Size, std::vector<char> &Scratch)
+{
+    const char *View = ReadView(InFile, Size);
+    if (View != nullptr)
+        return BinaryReader(View, Size);
+    Scratch.resize(Size);
+    InFile.read(Scratch.data(), Size);
+    return BinaryReader(Scratch.data(), static_cast<size_t>(InFile.gcount()));
+}
+
+}; // namespace DReyeVR
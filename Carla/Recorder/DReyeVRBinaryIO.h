@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+// Byte-buffer serialization layer for the recorder packets.
+//
+// BinaryWriter appends to a growable byte buffer, so a packet is serialized completely in memory (its size is known
+// before anything reaches the file, no tellp/seekp backpatching) and then written with a single write. The same bytes
+// can just as well be handed to the compact coders, a network stream, etc. BinaryReader is the counterpart, a
+// bounds-checked cursor over a span of bytes (usually a packet in the memory-mapped file, see ReadPacket).
+//
+// Arrays of trivially copyable types are copied in bulk. The upstream carla structures that only have
+// Write(std::ofstream &)/Read(std::ifstream &) can still be (de)serialized through WriteStream/ReadStream.
+
+namespace DReyeVR
+{
+
+class CARLA_API BinaryWriter
+{
+  public:
+    void Clear()
+    {
+        Bytes.clear();
+    }
+    void Reserve(size_t Count)
+    {
+        Bytes.reserve(Count);
+    }
+    size_t Size() const
+    {
+        return Bytes.size();
+    }
+    const char *Data() const
+    {
+        return Bytes.data();
+    }
+    const std::vector<char> &GetBytes() const
+    {
+        return Bytes;
+    }
+
+    void WriteBytes(const void *Src, size_t Count)
+    {
+        const char *Begin = static_cast<const char *>(Src);
+        Bytes.insert(Bytes.end(), Begin, Begin + Count);
+    }
+    template <typename T> void Write(const T &Value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "BinaryWriter::Write: T must be trivially copyable");
+        WriteBytes(&Value, sizeof(T));
+    }
+    // Count contiguous elements in a single copy
+    template <typename T> void WriteArray(const T *Values, size_t Count)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "BinaryWriter::WriteArray: T must be trivially copyable");
+        WriteBytes(Values, Count * sizeof(T));
+    }
+
+    // starts a [char Id][uint32 Size] packet, returns the offset to give to EndPacket
+    size_t BeginPacket(char Id);
+    // sets the size of the packet started at Offset (everything written since BeginPacket)
+    void EndPacket(size_t Offset);
+
+    // for the structures that can only write to an std::ofstream
+    template <typename T> void WriteStream(const T &Obj)
+    {
+        Obj.Write(OpenStream());
+    }
+
+    // writes everything to OutFile at once and clears the buffer
+    void Flush(std::ofstream &OutFile);
+
+  private:
+    std::ofstream &OpenStream();
+    std::vector<char> Bytes;
+};
+
+class CARLA_API BinaryReader
+{
+  public:
+    BinaryReader() = default;
+    BinaryReader(const char *InBegin, size_t InSize) : Begin(InBegin), Size(InSize)
+    {
+    }
+    explicit BinaryReader(const std::vector<char> &Bytes) : BinaryReader(Bytes.data(), Bytes.size())
+    {
+    }
+
+    size_t Tell() const
+    {
+        return Pos;
+    }
+    size_t Remaining() const
+    {
+        return Size - Pos;
+    }
+    // true once a read went past the end (what was read from then on is zeroed)
+    bool HasFailed() const
+    {
+        return bFailed;
+    }
+
+    // pointer to the next Count bytes (and skip over them), nullptr if there are not enough bytes left
+    const char *View(size_t Count)
+    {
+        if (Count > Remaining())
+        {
+            bFailed = true;
+            Pos = Size;
+            return nullptr;
+        }
+        const char *Out = Begin + Pos;
+        Pos += Count;
+        return Out;
+    }
+    // zero-copy view of the next Count packed POD records
+    template <typename T> const T *ViewArray(size_t Count)
+    {
+        return reinterpret_cast<const T *>(View(Count * sizeof(T)));
+    }
+    void Skip(size_t Count)
+    {
+        View(Count);
+    }
+
+    bool ReadBytes(void *Dst, size_t Count)
+    {
+        const char *Src = View(Count);
+        if (Src == nullptr)
+        {
+            std::memset(Dst, 0, Count);
+            return false;
+        }
+        std::memcpy(Dst, Src, Count);
+        return true;
+    }
+    template <typename T> bool Read(T &Value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "BinaryReader::Read: T must be trivially copyable");
+        return ReadBytes(&Value, sizeof(T));
+    }
+    template <typename T> bool ReadArray(T *Values, size_t Count)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "BinaryReader::ReadArray: T must be trivially copyable");
+        return ReadBytes(Values, Count * sizeof(T));
+    }
+
+    // for the structures that can only read from an std::ifstream
+    template <typename T> bool ReadStream(T &Obj)
+    {
+        Obj.Read(OpenStream());
+        return CloseStream();
+    }
+
+  private:
+    std::ifstream &OpenStream();
+    bool CloseStream();
+
+    const char *Begin = nullptr;
+    size_t Size = 0;
+    size_t Pos = 0;
+    bool bFailed = false;
+};
+
+// the next Size bytes of InFile (e.g. the body of a packet), in place if the file is memory-mapped and read into
+// Scratch otherwise
+CARLA_API BinaryReader ReadPacket(std::ifstream &InFile, size_t Size, std::vector<char> &Scratch);
+
+}; // namespace DReyeVR
@@ -0,0 +1,410 @@
+#include "DReyeVRColumnExport.h"
+#include "CarlaRecorderHelpers.h" // WriteValue
+
+#include "HAL/PlatformFilemanager.h" // FPlatformFileManager
+
+#include <algorithm> // std::max
+#include <sstream>
+
+namespace DReyeVR
+{
+
+template <> const char *NpyDescr<bool>()
+{
+    return "|b1";
+}
+template <> const char *NpyDescr<uint8_t>()
+{
+    return "|u1";
+}
+template <> const char *NpyDescr<int32_t>()
+{
+    return "<i4";
+}
+template <> const char *NpyDescr<uint32_t>()
+{
+    return "<u4";
+}
+template <> const char *NpyDescr<int64_t>()
+{
+    return "<i8";
+}
+template <> const char *NpyDescr<uint64_t>()
+{
+    return "<u8";
+}
+template <> const char *NpyDescr<float>()
+{
+    return "<f4";
+}
+template <> const char *NpyDescr<double>()
+{
+    return "<f8";
+}
+
+/// ========================================== ///
+/// ----------------:NPYCOLUMN:--------------- ///
+/// ========================================== ///
+
+NpyColumn::NpyColumn(const std::string &Name, const std::string &Descr, size_t ItemSize, bool bIsString)
+    : Name(Name), Descr(Descr), ItemSize(ItemSize), bIsString(bIsString)
+{
+}
+
+bool NpyColumn::Open(const std::string &InDir)
+{
+    Dir = InDir;
+    File.open(Dir + "/" + Name + ".npy", std::ios::binary);
+    if (!File.is_open())
+        return false;
+    // placeholder header, patched with the final shape in Close
+    WriteHeader(File, Descr, 0);
+    Buffer.reserve(FlushSize + ItemSize);
+    return true;
+}
+
+void NpyColumn::WriteHeader(std::ofstream &Out, const std::string &Descr, uint64_t Count)
+{
+    // npy format v1.0: magic, version, header length, python dict literal padded with spaces and a '\n'
+    // the header is always padded to the same size so it can be rewritten in place once the count is known
+    constexpr size_t HeaderSize = 128;
+    std::ostringstream Dict;
+    Dict << "{'descr': '" << Descr << "', 'fortran_order': False, 'shape': (" << Count << ",), }";
+    std::string Header = Dict.str();
+    Header.resize(HeaderSize - 10 - 1, ' ');
+    Header += '\n';
+
+    Out.write("\x93NUMPY\x01\x00", 8);
+    const uint16_t HeaderLen = static_cast<uint16_t>(Header.size());
+    WriteValue<uint16_t>(Out, HeaderLen);
+    Out.write(Header.data(), Header.size());
+}
+
+void NpyColumn::AddString(const FString &Value)
+{
+    check(bIsString);
+    const std::string Str = TCHAR_TO_UTF8(*Value);
+    auto It = Codes.find(Str);
+    if (It == Codes.end())
+    {
+        It = Codes.emplace(Str, static_cast<int32_t>(Names.size())).first;
+        Names.push_back(Str);
+    }
+    const int32_t Code = It->second;
+    const char *Bytes = reinterpret_cast<const char *>(&Code);
+    Buffer.insert(Buffer.end(), Bytes, Bytes + sizeof(Code));
+    Count++;
+    if (Buffer.size() >= FlushSize)
+        Flush();
+}
+
+void NpyColumn::Flush()
+{
+    File.write(Buffer.data(), Buffer.size());
+    Buffer.clear();
+}
+
+void NpyColumn::Close()
+{
+    if (!File.is_open())
+        return;
+    Flush();
+    File.seekp(0, std::ios::beg);
+    WriteHeader(File, Descr, Count);
+    File.close();
+
+    if (bIsString)
+    {
+        // fixed-width byte strings (numpy "S" dtype), padded with zeros
+        size_t Width = 1;
+        for (const auto &Str : Names)
+            Width = std::max(Width, Str.size());
+        std::ofstream NamesFile(Dir + "/" + Name + "_names.npy", std::ios::binary);
+        WriteHeader(NamesFile, "|S" + std::to_string(Width), Names.size());
+        for (auto Str : Names)
+        {
+            Str.resize(Width, '\0');
+            NamesFile.write(Str.data(), Width);
+        }
+    }
+}
+
+/// ========================================== ///
+/// ---------------:COLUMNTABLE:-------------- ///
+/// ========================================== ///
+
+void ColumnTable::DeclareString(const std::string &Name)
+{
+    Columns.emplace_back(Name, NpyDescr<int32_t>(), sizeof(int32_t), true);
+}
+
+void ColumnTable::DeclareVector(const std::string &Name)
+{
+    Declare<float>(Name + "_x");
+    Declare<float>(Name + "_y");
+    Declare<float>(Name + "_z");
+}
+
+void ColumnTable::DeclareRotator(const std::string &Name)
+{
+    Declare<float>(Name + "_pitch");
+    Declare<float>(Name + "_yaw");
+    Declare<float>(Name + "_roll");
+}
+
+void ColumnTable::DeclareVector2D(const std::string &Name)
+{
+    Declare<float>(Name + "_x");
+    Declare<float>(Name + "_y");
+}
+
+bool ColumnTable::Open(const std::string &Dir)
+{
+    if (!FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(UTF8_TO_TCHAR(Dir.c_str())))
+        return false;
+    for (auto &Column : Columns)
+    {
+        if (!Column.Open(Dir))
+            return false;
+    }
+    return true;
+}
+
+void ColumnTable::Close()
+{
+    for (auto &Column : Columns)
+        Column.Close();
+}
+
+ColumnTable &ColumnTable::Advance()
+{
+    if (++Next == Columns.size())
+    {
+        Next = 0;
+        Rows++;
+    }
+    return *this;
+}
+
+ColumnTable &ColumnTable::operator<<(const FString &Value)
+{
+    Columns[Next].AddString(Value);
+    return Advance();
+}
+
+ColumnTable &ColumnTable::operator<<(const FVector &Value)
+{
+    return (*this) << Value.X << Value.Y << Value.Z;
+}
+
+ColumnTable &ColumnTable::operator<<(const FRotator &Value)
+{
+    return (*this) << Value.Pitch << Value.Yaw << Value.Roll;
+}
+
+ColumnTable &ColumnTable::operator<<(const FVector2D &Value)
+{
+    return (*this) << Value.X << Value.Y;
+}
+
+/// ========================================== ///
+/// --------------:COLUMNEXPORTER:------------ ///
+/// ========================================== ///
+
+ColumnExporter::ColumnExporter()
+{
+    // actor positions (from the regular Carla position packets)
+    Positions.Declare<uint64_t>("frame");
+    Positions.Declare<double>("time");
+    Positions.Declare<uint32_t>("actor_id");
+    Positions.DeclareVector("location");
+    Positions.DeclareVector("rotation"); // euler angles as recorded (x=roll, y=pitch, z=yaw)
+
+    // DReyeVR sensor (AggregateData)
+    Sensor.Declare<uint64_t>("frame");
+    Sensor.Declare<double>("time");
+    Sensor.Declare<int64_t>("timestamp_carla");
+    Sensor.Declare<int64_t>("timestamp_device");
+    Sensor.Declare<int64_t>("frame_sequence");
+    Sensor.DeclareVector("gaze_dir");
+    Sensor.DeclareVector("gaze_origin");
+    Sensor.Declare<bool>("gaze_valid");
+    Sensor.Declare<float>("gaze_vergence");
+    for (const std::string Eye : {"left", "right"})
+    {
+        Sensor.DeclareVector(Eye + "_gaze_dir");
+        Sensor.DeclareVector(Eye + "_gaze_origin");
+        Sensor.Declare<bool>(Eye + "_gaze_valid");
+        Sensor.Declare<float>(Eye + "_eye_openness");
+        Sensor.Declare<bool>(Eye + "_eye_openness_valid");
+        Sensor.Declare<float>(Eye + "_pupil_diameter");
+        Sensor.DeclareVector2D(Eye + "_pupil_position");
+        Sensor.Declare<bool>(Eye + "_pupil_position_valid");
+    }
+    Sensor.DeclareVector("camera_location");
+    Sensor.DeclareRotator("camera_rotation");
+    Sensor.DeclareVector("camera_location_abs");
+    Sensor.DeclareRotator("camera_rotation_abs");
+    Sensor.DeclareVector("vehicle_location");
+    Sensor.DeclareRotator("vehicle_rotation");
+    Sensor.Declare<float>("vehicle_velocity");
+    Sensor.DeclareString("focus_actor");
+    Sensor.DeclareVector("focus_point");
+    Sensor.Declare<float>("focus_distance");
+    Sensor.Declare<float>("throttle");
+    Sensor.Declare<float>("steering");
+    Sensor.Declare<float>("brake");
+    Sensor.Declare<bool>("toggled_reverse");
+    Sensor.Declare<bool>("turn_signal_left");
+    Sensor.Declare<bool>("turn_signal_right");
+    Sensor.Declare<bool>("hold_handbrake");
+
+    // DReyeVR custom actors
+    CustomActors.Declare<uint64_t>("frame");
+    CustomActors.Declare<double>("time");
+    CustomActors.DeclareString("name");
+    CustomActors.DeclareVector("location");
+    CustomActors.DeclareRotator("rotation");
+    CustomActors.DeclareVector("scale");
+    CustomActors.DeclareString("mesh");
+
+    // DReyeVR eye tracker samples (all of them, at the eye tracker rate)
+    EyeSamples.Declare<uint64_t>("frame");
+    EyeSamples.Declare<double>("time");
+    EyeSamples.Declare<int64_t>("timestamp_device");
+    EyeSamples.Declare<int64_t>("frame_sequence");
+    EyeSamples.DeclareVector("gaze_dir");
+    EyeSamples.DeclareVector("gaze_origin");
+    EyeSamples.Declare<float>("gaze_vergence");
+    for (const std::string Eye : {"left", "right"})
+    {
+        EyeSamples.DeclareVector(Eye + "_gaze_dir");
+        EyeSamples.DeclareVector(Eye + "_gaze_origin");
+        EyeSamples.Declare<float>(Eye + "_eye_openness");
+        EyeSamples.Declare<float>(Eye + "_pupil_diameter");
+        EyeSamples.DeclareVector2D(Eye + "_pupil_position");
+    }
+    EyeSamples.Declare<uint8_t>("valid"); // PackedEyeSample::ValidityFlags
+
+    // DReyeVR attention weights of the gaze cone (one row per actor in the cone per frame)
+    Attention.Declare<uint64_t>("frame");
+    Attention.Declare<double>("time");
+    Attention.DeclareString("actor");
+    Attention.Declare<float>("weight");
+
+    // DReyeVR fixations/saccades (one row per event)
+    GazeEvents.Declare<uint64_t>("frame");
+    GazeEvents.Declare<double>("time");
+    GazeEvents.Declare<uint8_t>("type"); // GazeEventType
+    GazeEvents.Declare<int64_t>("timestamp_device");
+    GazeEvents.Declare<int64_t>("detected_at");
+    GazeEvents.Declare<float>("duration_ms");
+    GazeEvents.DeclareVector("centroid");
+    GazeEvents.Declare<float>("amplitude");
+    GazeEvents.Declare<float>("peak_velocity");
+
+    // gaze re-attributed to the actor bounding boxes (one row per DReyeVR sensor row, see CarlaRecorderQuery)
+    GazeBoxes.Declare<uint64_t>("frame");
+    GazeBoxes.Declare<double>("time");
+    GazeBoxes.Declare<uint32_t>("actor_id");
+    GazeBoxes.DeclareString("actor");
+    GazeBoxes.Declare<float>("distance");
+    GazeBoxes.DeclareVector("point");
+}
+
+bool ColumnExporter::Open(const std::string &InDir)
+{
+    Dir = InDir;
+    return Positions.Open(Dir + "/positions") && Sensor.Open(Dir + "/dreyevr") &&
+           CustomActors.Open(Dir + "/custom_actors") && EyeSamples.Open(Dir + "/eye_samples") &&
+           Attention.Open(Dir + "/attention") && GazeEvents.Open(Dir + "/gaze_events") &&
+           GazeBoxes.Open(Dir + "/gaze_boxes");
+}
+
+void ColumnExporter::Close()
+{
+    Positions.Close();
+    Sensor.Close();
+    CustomActors.Close();
+    EyeSamples.Close();
+    Attention.Close();
+    GazeEvents.Close();
+    GazeBoxes.Close();
+}
+
+void ColumnExporter::AddPosition(uint64_t FrameId, double Elapsed, uint32_t ActorId, const FVector &Location,
+                                 const FVector &Rotation)
+{
+    Positions << FrameId << Elapsed << ActorId << Location << Rotation;
+}
+
+void ColumnExporter::AddAggregateData(uint64_t FrameId, double Elapsed, const AggregateData &Data)
+{
+    Sensor << FrameId << Elapsed << Data.GetTimestampCarla() << Data.GetTimestampDevice() << Data.GetFrameSequence();
+    Sensor << Data.GetGazeDir() << Data.GetGazeOrigin() << Data.GetGazeValidity() << Data.GetGazeVergence();
+    const std::pair<Gaze, Eye> Eyes[] = {{Gaze::LEFT, Eye::LEFT}, {Gaze::RIGHT, Eye::RIGHT}};
+    for (const auto &E : Eyes)
+    {
+        Sensor << Data.GetGazeDir(E.first) << Data.GetGazeOrigin(E.first) << Data.GetGazeValidity(E.first);
+        Sensor << Data.GetEyeOpenness(E.second) << Data.GetEyeOpennessValidity(E.second);
+        Sensor << Data.GetPupilDiameter(E.second) << Data.GetPupilPosition(E.second)
+               << Data.GetPupilPositionValidity(E.second);
+    }
+    Sensor << Data.GetCameraLocation() << Data.GetCameraRotation();
+    Sensor << Data.GetCameraLocationAbs() << Data.GetCameraRotationAbs();
+    Sensor << Data.GetVehicleLocation() << Data.GetVehicleRotation() << Data.GetVehicleVelocity();
+    Sensor << Data.GetFocusActorName() << Data.GetFocusActorPoint() << Data.GetFocusActorDistance();
+    const UserInputs &Inputs = Data.GetUserInputs();
+    Sensor << Inputs.Throttle << Inputs.Steering << Inputs.Brake;
+    Sensor << Inputs.ToggledReverse << Inputs.TurnSignalLeft << Inputs.TurnSignalRight << Inputs.HoldHandbrake;
+}
+
+void ColumnExporter::AddCustomActor(uint64_t FrameId, double Elapsed, const CustomActorData &Data)
+{
+    CustomActors << FrameId << Elapsed << Data.Name << Data.Location << Data.Rotation << Data.Scale3D
+                 << Data.MeshPath;
+}
+
+void ColumnExporter::AddEyeSample(uint64_t FrameId, double Elapsed, const PackedEyeSample &Sample)
+{
+    EyeSamples << FrameId << Elapsed << Sample.TimestampDevice << Sample.FrameSequence;
+    EyeSamples << Sample.GazeDir << Sample.GazeOrigin << Sample.Vergence;
+    for (const PackedEyeSample::Eye *E : {&Sample.Left, &Sample.Right})
+    {
+        EyeSamples << E->GazeDir << E->GazeOrigin << E->EyeOpenness << E->PupilDiameter << E->PupilPosition;
+    }
+    EyeSamples << Sample.Valid;
+}
+
+void ColumnExporter::AddAttention(uint64_t FrameId, double Elapsed, const ActorAttention &A)
+{
+    Attention << FrameId << Elapsed << A.ActorNameTag << A.Weight;
+}
+
+void ColumnExporter::AddGazeEvent(uint64_t FrameId, double Elapsed, const GazeEvent &E)
+{
+    GazeEvents << FrameId << Elapsed << static_cast<uint8_t>(E.Type) << E.TimestampDevice << E.DetectedAt;
+    GazeEvents << E.DurationMs << E.Centroid << E.Amplitude << E.PeakVelocity;
+}
+
+void ColumnExporter::AddGazeHit(uint64_t FrameId, double Elapsed, uint32_t ActorId, const FString &Actor,
+                                float Distance, const FVector &Point)
+{
+    GazeBoxes << FrameId << Elapsed << ActorId << Actor << Distance << Point;
+}
+
+std::string ColumnExporter::Summary() const
+{
+    std::ostringstream Info;
+    Info << "Exported to " << Dir << std::endl;
+    Info << " positions: " << Positions.Num() << " rows" << std::endl;
+    Info << " dreyevr: " << Sensor.Num() << " rows" << std::endl;
+    Info << " custom_actors: " << CustomActors.Num() << " rows" << std::endl;
+    Info << " eye_samples: " << EyeSamples.Num() << " rows" << std::endl;
+    Info << " attention: " << Attention.Num() << " rows" << std::endl;
+    Info << " gaze_events: " << GazeEvents.Num() << " rows" << std::endl;
+    Info << " gaze_boxes: " << GazeBoxes.Num() << " rows" << std::endl;
+    return Info.str();
+}
+
+}; // namespace DReyeVR
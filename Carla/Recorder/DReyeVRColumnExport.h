@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Carla/Sensor/DReyeVRData.h"
+#include "DReyeVREyeSamples.h"
+
+// Columnar export of recordings for offline analysis.
+//
+// Every table is a directory with one .npy file per field (a contiguous little-endian array with a tiny
+// self-describing header) so each column loads straight into numpy with np.load (optionally memory-mapped) without
+// any text parsing. Strings are dictionary encoded: "<name>.npy" holds int32 codes into "<name>_names.npy".
+//
+// Rows are buffered per column and flushed in small chunks so the export runs in bounded memory regardless of the
+// length of the recording (only the string dictionaries are kept, and those are tiny).
+
+namespace DReyeVR
+{
+
+template <typename T> const char *NpyDescr();
+
+class CARLA_API NpyColumn
+{
+  public:
+    NpyColumn(const std::string &Name, const std::string &Descr, size_t ItemSize, bool bIsString = false);
+    bool Open(const std::string &Dir);
+    void Close();
+
+    template <typename T> void Add(const T &Value)
+    {
+        check(!bIsString && sizeof(T) == ItemSize);
+        const char *Bytes = reinterpret_cast<const char *>(&Value);
+        Buffer.insert(Buffer.end(), Bytes, Bytes + sizeof(T));
+        Count++;
+        if (Buffer.size() >= FlushSize)
+            Flush();
+    }
+    void AddString(const FString &Value);
+
+    uint64_t Num() const
+    {
+        return Count;
+    }
+
+  private:
+    void Flush();
+    static void WriteHeader(std::ofstream &Out, const std::string &Descr, uint64_t Count);
+
+    static constexpr size_t FlushSize = 1 << 16;
+
+    std::string Name;
+    std::string Descr;
+    std::string Dir;
+    size_t ItemSize;
+    bool bIsString;
+
+    std::ofstream File;
+    std::vector<char> Buffer;
+    uint64_t Count = 0;
+
+    // dictionary for string columns
+    std::unordered_map<std::string, int32_t> Codes;
+    std::vector<std::string> Names;
+};
+
+class CARLA_API ColumnTable
+{
+  public:
+    template <typename T> void Declare(const std::string &Name)
+    {
+        Columns.emplace_back(Name, NpyDescr<T>(), sizeof(T));
+    }
+    void DeclareString(const std::string &Name);
+    void DeclareVector(const std::string &Name);   // _x, _y, _z
+    void DeclareRotator(const std::string &Name);  // _pitch, _yaw, _roll
+    void DeclareVector2D(const std::string &Name); // _x, _y
+
+    bool Open(const std::string &Dir);
+    void Close();
+    uint64_t Num() const
+    {
+        return Rows;
+    }
+
+    // values must be added in the same order the columns were declared
+    template <typename T> ColumnTable &operator<<(const T &Value)
+    {
+        Columns[Next].Add(Value);
+        return Advance();
+    }
+    ColumnTable &operator<<(const FString &Value);
+    ColumnTable &operator<<(const FVector &Value);
+    ColumnTable &operator<<(const FRotator &Value);
+    ColumnTable &operator<<(const FVector2D &Value);
+
+  private:
+    ColumnTable &Advance();
+
+    std::vector<NpyColumn> Columns;
+    size_t Next = 0;
+    uint64_t Rows = 0;
+};
+
+// streams the positions, DReyeVR (139), DReyeVRCustomActor (140), DReyeVREyeSamples (143), DReyeVRAttention (146) and
+// DReyeVRGazeEvents (147) packets of a recording into column tables, along with the gaze re-attributed to the actor
+// bounding boxes
+class CARLA_API ColumnExporter
+{
+  public:
+    ColumnExporter();
+    bool Open(const std::string &Dir);
+    void Close();
+
+    void AddPosition(uint64_t FrameId, double Elapsed, uint32_t ActorId, const FVector &Location,
+                     const FVector &Rotation);
+    void AddAggregateData(uint64_t FrameId, double Elapsed, const AggregateData &Data);
+    void AddCustomActor(uint64_t FrameId, double Elapsed, const CustomActorData &Data);
+    void AddEyeSample(uint64_t FrameId, double Elapsed, const PackedEyeSample &Sample);
+    void AddAttention(uint64_t FrameId, double Elapsed, const ActorAttention &A);
+    void AddGazeEvent(uint64_t FrameId, double Elapsed, const GazeEvent &E);
+    // ActorId 0 if the gaze did not hit any box
+    void AddGazeHit(uint64_t FrameId, double Elapsed, uint32_t ActorId, const FString &Actor, float Distance,
+                    const FVector &Point);
+
+    std::string Summary() const;
+
+  private:
+    std::string Dir;
+    ColumnTable Positions;
+    ColumnTable Sensor;
+    ColumnTable CustomActors;
+    ColumnTable EyeSamples;
+    ColumnTable Attention;
+    ColumnTable GazeEvents;
+    ColumnTable GazeBoxes;
+};
+
+}; // namespace DReyeVR
@@ -0,0 +1,314 @@
+#include "DReyeVRCompact.h"
+#include "CarlaRecorderHelpers.h" // WriteValue, ReadValue
+#include "DReyeVRMappedFile.h"    // ReadView
+
+#include <cmath> // std::lround
+
+namespace DReyeVR
+{
+
+// quantization steps (the decoded values are multiples of these)
+static constexpr float LocationStep = 0.1f; // cm (so 1mm)
+static constexpr float RotationStep = 0.01f; // degrees
+
+enum CompactFlags : uint8_t
+{
+    COMPACT_INTRA = 1 << 0, // the decoder state is reset before this packet
+};
+
+enum CompactDataMode : uint8_t
+{
+    COMPACT_DATA_RAW = 0,   // packet bytes as they are
+    COMPACT_DATA_DELTA = 1, // runs of (zeros, literals) of the packet XOR'ed with the previous one
+};
+
+/// ========================================== ///
+/// -----------------:VARINT:----------------- ///
+/// ========================================== ///
+
+static void PutVarint(std::vector<uint8_t> &Out, uint64_t Value)
+{
+    while (Value >= 0x80)
+    {
+        Out.push_back(static_cast<uint8_t>(Value) | 0x80);
+        Value >>= 7;
+    }
+    Out.push_back(static_cast<uint8_t>(Value));
+}
+
+static void PutZigzag(std::vector<uint8_t> &Out, int64_t Value)
+{
+    PutVarint(Out, (static_cast<uint64_t>(Value) << 1) ^ static_cast<uint64_t>(Value >> 63));
+}
+
+// minimal bounds-checked reader over a packet body
+struct ByteReader
+{
+    const uint8_t *Ptr;
+    const uint8_t *End;
+
+    bool Ok() const
+    {
+        return Ptr <= End;
+    }
+    uint8_t Byte()
+    {
+        return (Ptr < End) ? *Ptr++ : (Ptr = End + 1, 0);
+    }
+    uint64_t Varint()
+    {
+        uint64_t Value = 0;
+        for (int Shift = 0; Shift < 64 && Ptr < End; Shift += 7)
+        {
+            const uint8_t B = *Ptr++;
+            Value |= static_cast<uint64_t>(B & 0x7f) << Shift;
+            if (!(B & 0x80))
+                return Value;
+        }
+        Ptr = End + 1; // truncated
+        return 0;
+    }
+    int64_t Zigzag()
+    {
+        const uint64_t Value = Varint();
+        return static_cast<int64_t>(Value >> 1) ^ -static_cast<int64_t>(Value & 1);
+    }
+};
+
+// the packet body, in place when the file is memory-mapped
+static const uint8_t *ReadBody(std::ifstream &InFile, uint32_t Size, std::vector<char> &Storage)
+{
+    const char *Body = ReadView(InFile, Size);
+    if (Body == nullptr)
+    {
+        Storage.resize(Size);
+        InFile.read(Storage.data(), Size);
+        Body = Storage.data();
+    }
+    return reinterpret_cast<const uint8_t *>(Body);
+}
+
+static void WritePacket(std::ofstream &OutFile, char Id, const std::vector<uint8_t> &Body)
+{
+    WriteValue<char>(OutFile, Id);
+    WriteValue<uint32_t>(OutFile, static_cast<uint32_t>(Body.size()));
+    OutFile.write(reinterpret_cast<const char *>(Body.data()), Body.size());
+}
+
+/// ========================================== ///
+/// ---------------:POSITIONS:---------------- ///
+/// ========================================== ///
+
+void CompactPositionEncoder::Reset()
+{
+    State.clear();
+    bHasState = false;
+}
+
+void CompactPositionEncoder::Write(const std::vector<CarlaRecorderPosition> &Positions, bool bIntra,
+                                   std::ofstream &OutFile)
+{
+    bIntra = bIntra || !bHasState;
+    if (bIntra)
+        State.clear();
+    bHasState = true;
+
+    // quantize this frame (sorted by id)
+    std::map<uint32_t, std::array<int32_t, 6>> Current;
+    for (const auto &Pos : Positions)
+    {
+        Current[Pos.DatabaseId] = {
+            static_cast<int32_t>(std::lround(Pos.Location.X / LocationStep)),
+            static_cast<int32_t>(std::lround(Pos.Location.Y / LocationStep)),
+            static_cast<int32_t>(std::lround(Pos.Location.Z / LocationStep)),
+            static_cast<int32_t>(std::lround(Pos.Rotation.X / RotationStep)),
+            static_cast<int32_t>(std::lround(Pos.Rotation.Y / RotationStep)),
+            static_cast<int32_t>(std::lround(Pos.Rotation.Z / RotationStep)),
+        };
+    }
+
+    Buffer.clear();
+    Buffer.push_back(bIntra ? COMPACT_INTRA : 0);
+
+    // actors that are gone
+    std::vector<uint32_t> Removed;
+    for (const auto &Entry : State)
+    {
+        if (Current.find(Entry.first) == Current.end())
+            Removed.push_back(Entry.first);
+    }
+    PutVarint(Buffer, Removed.size());
+    uint32_t LastId = 0;
+    for (uint32_t Id : Removed)
+    {
+        PutVarint(Buffer, Id - LastId);
+        LastId = Id;
+        State.erase(Id);
+    }
+
+    // actors that are new or moved (the others are skipped entirely)
+    std::vector<std::pair<uint32_t, uint8_t>> Changed;
+    for (const auto &Entry : Current)
+    {
+        auto It = State.find(Entry.first);
+        uint8_t Mask = 0;
+        for (int i = 0; i < 6; i++)
+        {
+            const int32_t Prev = (It != State.end()) ? It->second[i] : 0;
+            if (Entry.second[i] != Prev)
+                Mask |= 1 << i;
+        }
+        if (Mask != 0 || It == State.end())
+            Changed.emplace_back(Entry.first, Mask);
+    }
+    PutVarint(Buffer, Changed.size());
+    LastId = 0;
+    for (const auto &Change : Changed)
+    {
+        const uint32_t Id = Change.first;
+        const uint8_t Mask = Change.second;
+        auto &Prev = State[Id]; // zeros for new actors
+        const auto &Cur = Current[Id];
+        PutVarint(Buffer, Id - LastId);
+        LastId = Id;
+        Buffer.push_back(Mask);
+        for (int i = 0; i < 6; i++)
+        {
+            if (Mask & (1 << i))
+                PutZigzag(Buffer, static_cast<int64_t>(Cur[i]) - Prev[i]);
+        }
+        Prev = Cur;
+    }
+
+    WritePacket(OutFile, static_cast<char>(DREYEVR_COMPACT_POSITIONS_PACKET_ID), Buffer);
+}
+
+void CompactPositionDecoder::Reset()
+{
+    State.clear();
+}
+
+void CompactPositionDecoder::Decode(std::ifstream &InFile, uint32_t Size)
+{
+    ByteReader In{ReadBody(InFile, Size, Buffer), nullptr};
+    In.End = In.Ptr + Size;
+
+    if (In.Byte() & COMPACT_INTRA)
+        State.clear();
+
+    uint64_t Num = In.Varint();
+    uint32_t Id = 0;
+    for (uint64_t i = 0; i < Num && In.Ok(); i++)
+    {
+        Id += static_cast<uint32_t>(In.Varint());
+        State.erase(Id);
+    }
+
+    Num = In.Varint();
+    Id = 0;
+    for (uint64_t i = 0; i < Num && In.Ok(); i++)
+    {
+        Id += static_cast<uint32_t>(In.Varint());
+        auto &Values = State[Id]; // value-initialized (zeros) for new actors
+        const uint8_t Mask = In.Byte();
+        for (int j = 0; j < 6; j++)
+        {
+            if (Mask & (1 << j))
+                Values[j] += static_cast<int32_t>(In.Zigzag());
+        }
+    }
+}
+
+void CompactPositionDecoder::Read(std::ifstream &InFile, uint32_t Size, std::vector<CarlaRecorderPosition> &Out)
+{
+    Decode(InFile, Size);
+    Out.clear();
+    Out.reserve(State.size());
+    for (const auto &Entry : State)
+    {
+        CarlaRecorderPosition Pos;
+        Pos.DatabaseId = Entry.first;
+        Pos.Location = FVector(Entry.second[0], Entry.second[1], Entry.second[2]) * LocationStep;
+        Pos.Rotation = FVector(Entry.second[3], Entry.second[4], Entry.second[5]) * RotationStep;
+        Out.push_back(Pos);
+    }
+}
+
+void CompactPositionDecoder::Skip(std::ifstream &InFile, uint32_t Size)
+{
+    Decode(InFile, Size);
+}
+
+/// ========================================== ///
+/// -----------------:DATA:------------------- ///
+/// ========================================== ///
+
+void CompactDataEncoder::Reset()
+{
+    Prev.clear();
+}
+
+void CompactDataEncoder::Write(const std::vector<char> &Packet, bool bIntra, std::ofstream &OutFile)
+{
+    Buffer.clear();
+    if (bIntra || Prev.size() != Packet.size())
+    {
+        // first packet or the size changed (ex. a different focus actor name)
+        Buffer.push_back(COMPACT_DATA_RAW);
+        Buffer.insert(Buffer.end(), Packet.begin(), Packet.end());
+    }
+    else
+    {
+        Buffer.push_back(COMPACT_DATA_DELTA);
+        const size_t N = Packet.size();
+        size_t i = 0;
+        while (i < N)
+        {
+            // unchanged bytes
+            const size_t ZeroStart = i;
+            while (i < N && Packet[i] == Prev[i])
+                i++;
+            PutVarint(Buffer, i - ZeroStart);
+            // changed bytes (a single unchanged byte does not end the run, it is cheaper to keep it)
+            const size_t LitStart = i;
+            while (i < N && !(Packet[i] == Prev[i] && (i + 1 == N || Packet[i + 1] == Prev[i + 1])))
+                i++;
+            PutVarint(Buffer, i - LitStart);
+            for (size_t j = LitStart; j < i; j++)
+                Buffer.push_back(static_cast<uint8_t>(Packet[j] ^ Prev[j]));
+        }
+    }
+    Prev = Packet;
+    WritePacket(OutFile, static_cast<char>(DREYEVR_COMPACT_DATA_PACKET_ID), Buffer);
+}
+
+void CompactDataDecoder::Reset()
+{
+    Prev.clear();
+}
+
+const std::vector<char> &CompactDataDecoder::Read(std::ifstream &InFile, uint32_t Size)
+{
+    ByteReader In{ReadBody(InFile, Size, Buffer), nullptr};
+    In.End = In.Ptr + Size;
+
+    if (In.Byte() == COMPACT_DATA_RAW)
+    {
+        Prev.assign(reinterpret_cast<const char *>(In.Ptr), reinterpret_cast<const char *>(In.End));
+        return Prev;
+    }
+
+    // XOR the runs into the previous packet (in place)
+    const size_t N = Prev.size();
+    size_t i = 0;
+    while (i < N && In.Ok())
+    {
+        i += In.Varint();
+        const size_t Len = In.Varint();
+        for (size_t j = 0; j < Len && i < N; j++, i++)
+            Prev[i] ^= static_cast<char>(In.Byte());
+    }
+    return Prev;
+}
+
+}; // namespace DReyeVR
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include "CarlaRecorderPosition.h"
+
+// Compact recording mode (opt-in, see ACarlaRecorder::SetCompactMode) for the two packets that dominate the size of
+// long recordings: the actor positions and the DReyeVR sensor data, which are otherwise written in full every frame.
+//
+// - DReyeVRCompactPositions replaces the Position packet. Locations are quantized to millimetres and rotations to
+//   1/100 of a degree, and every actor is delta-coded (zigzag varints) against its value in the previous frame.
+//   Actors that did not move are not written at all, so parked vehicles cost nothing. The decoder keeps the state of
+//   every live actor and always reproduces the complete list of positions of the frame.
+// - DReyeVRCompactData wraps the serialized DReyeVR (139) packet, XOR'ed byte-wise against the previous one and
+//   run-length coded. This is lossless (floats that did not change are all zeros after the XOR) and the original
+//   packet is reproduced exactly.
+//
+// Both depend on the previous frame, so the replayer decodes them on every frame (even the ones it does not apply)
+// and these frames are flagged with FRAME_DELTA in the frame index so seeking visits them. Keyframes (and the first
+// frame) are "intra" frames that reset both coders, which is where seeking starts from.
+
+#define DREYEVR_COMPACT_POSITIONS_PACKET_ID 144
+#define DREYEVR_COMPACT_DATA_PACKET_ID 145
+
+namespace DReyeVR
+{
+
+class CARLA_API CompactPositionEncoder
+{
+  public:
+    void Reset();
+    // writes the positions of this frame as a DReyeVRCompactPositions packet
+    void Write(const std::vector<CarlaRecorderPosition> &Positions, bool bIntra, std::ofstream &OutFile);
+
+  private:
+    std::map<uint32_t, std::array<int32_t, 6>> State; // quantized location & rotation of every live actor
+    std::vector<uint8_t> Buffer;
+    bool bHasState = false;
+};
+
+class CARLA_API CompactPositionDecoder
+{
+  public:
+    void Reset();
+    // decodes the packet body (Size bytes after the header), Out gets the positions of every live actor
+    void Read(std::ifstream &InFile, uint32_t Size, std::vector<CarlaRecorderPosition> &Out);
+    // same as Read but only updates the decoder state (frames that are not being applied)
+    void Skip(std::ifstream &InFile, uint32_t Size);
+
+  private:
+    void Decode(std::ifstream &InFile, uint32_t Size);
+    std::map<uint32_t, std::array<int32_t, 6>> State;
+    std::vector<char> Buffer; // scratch space when the file is not memory-mapped
+};
+
+class CARLA_API CompactDataEncoder
+{
+  public:
+    void Reset();
+    // writes Packet (a complete serialized packet including its header) as a DReyeVRCompactData packet
+    void Write(const std::vector<char> &Packet, bool bIntra, std::ofstream &OutFile);
+
+  private:
+    std::vector<char> Prev;
+    std::vector<uint8_t> Buffer;
+};
+
+class CARLA_API CompactDataDecoder
+{
+  public:
+    void Reset();
+    // decodes the packet body (Size bytes after the header) back to the original packet (including its header)
+    const std::vector<char> &Read(std::ifstream &InFile, uint32_t Size);
+
+  private:
+    std::vector<char> Prev;
+    std::vector<char> Buffer; // scratch space when the file is not memory-mapped
+};
+
+}; // namespace DReyeVR
@@ -0,0 +1,172 @@
+#include "DReyeVRCompact.h"
+#include "CarlaRecorder.h"        // DREYEVR_PACKET_ID
+#include "CarlaRecorderHelpers.h" // ReadValue
+#include "DReyeVRRecorder.h"      // DReyeVRDataRecorders
+
+#include "HAL/FileManager.h" // IFileManager
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h" // FPaths
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Run with "Automation RunTests DReyeVR.Recorder" (editor console or -ExecCmds)
+
+// what the compact coders keep of a position (see DReyeVRCompact.h)
+static FVector QuantizeTest(const FVector &V, float Step)
+{
+    return FVector(std::lround(V.X / Step), std::lround(V.Y / Step), std::lround(V.Z / Step)) * Step;
+}
+
+struct CompactTestFrame
+{
+    std::vector<CarlaRecorderPosition> Positions; // sorted by id, like the decoder gives them back
+    std::vector<char> Packet;                     // serialized DReyeVR packet (with its header)
+    bool bIntra = false;
+};
+
+static CarlaRecorderPosition MakeTestPosition(uint32_t Id, const FVector &Location, const FVector &Rotation)
+{
+    CarlaRecorderPosition Pos;
+    Pos.DatabaseId = Id;
+    Pos.Location = Location;
+    Pos.Rotation = Rotation;
+    return Pos;
+}
+
+// actors are added, moved, left alone and removed, with a keyframe in the middle
+static std::vector<CompactTestFrame> MakeTestFrames(int32 NumFrames, int32 Keyframe)
+{
+    std::vector<CompactTestFrame> Frames(NumFrames);
+    for (int32 f = 0; f < NumFrames; f++)
+    {
+        CompactTestFrame &Frame = Frames[f];
+        Frame.bIntra = (f == Keyframe);
+        const float t = static_cast<float>(f);
+        // moves every frame (sub-millimetre and negative values too)
+        Frame.Positions.push_back(
+            MakeTestPosition(1, FVector(1000.123f + 55.5f * t, -250.0456f - t, 30.f), FVector(0.f, -90.f + t, 0.333f)));
+        // only there until frame 2
+        if (f <= 2)
+            Frame.Positions.push_back(MakeTestPosition(2, FVector(10.f, 20.f, 30.f + t), FVector(0.f, 0.f, 0.f)));
+        // parked for the whole recording
+        Frame.Positions.push_back(MakeTestPosition(3, FVector(-5432.1f, 777.77f, 0.05f), FVector(1.f, 179.99f, -3.f)));
+        // added on frame 2 and removed after the keyframe
+        if (f >= 2 && f < Keyframe + 2)
+            Frame.Positions.push_back(MakeTestPosition(7, FVector(t, t, t), FVector(-t, t, -t)));
+        // added right after the keyframe (with a large id)
+        if (f > Keyframe)
+            Frame.Positions.push_back(MakeTestPosition(100000, FVector(0.f, 0.f, 12.3456f * t), FVector(0.f, t, 0.f)));
+
+        // the DReyeVR packet: small changes every frame and a focus name (so the packet size) that changes once
+        DReyeVR::EyeTracker Eyes;
+        Eyes.TimestampDevice = 1000 + 8 * f;
+        Eyes.FrameSequence = f;
+        Eyes.Combined.GazeDir = FVector(1.f, 0.01f * t, 0.f);
+        Eyes.Combined.GazeValid = (f % 3 != 0);
+        Eyes.Left.PupilDiameter = 3.f + 0.1f * t;
+        DReyeVR::EgoVariables EgoVars;
+        EgoVars.VehicleLocation = Frame.Positions[0].Location;
+        EgoVars.Velocity = 100.f * t;
+        DReyeVR::FocusInfo Focus;
+        Focus.ActorNameTag = (f < 3) ? TEXT("None") : TEXT("BP_Vehicle_Lincoln_Vehicle");
+        Focus.Distance = 500.f - t;
+        Focus.bDidHit = (f >= 3);
+        DReyeVR::UserInputs Inputs;
+        Inputs.Throttle = (f % 2 == 0) ? 0.5f : 0.75f;
+        DReyeVR::AggregateData Data;
+        Data.Update(33 * f, Eyes, EgoVars, Focus, Inputs);
+
+        DReyeVRDataRecorders<DReyeVR::AggregateData, DREYEVR_PACKET_ID> Packet;
+        Packet.Add(&Data);
+        DReyeVR::BinaryWriter Writer;
+        Packet.Write(Writer);
+        Frame.Packet = Writer.GetBytes();
+    }
+    return Frames;
+}
+
+// decodes the frames from First on (starting at its offset with fresh decoders, like a seek does)
+static bool CheckCompactFrames(FAutomationTestBase &Test, const FString &Filename,
+                               const std::vector<CompactTestFrame> &Frames, const std::vector<std::streamoff> &Offsets,
+                               size_t First)
+{
+    std::ifstream File(TCHAR_TO_UTF8(*Filename), std::ios::binary);
+    File.seekg(Offsets[First], std::ios::beg);
+    DReyeVR::CompactPositionDecoder PositionDecoder;
+    DReyeVR::CompactDataDecoder DataDecoder;
+    std::vector<CarlaRecorderPosition> Positions;
+    for (size_t f = First; f < Frames.size(); f++)
+    {
+        const CompactTestFrame &Frame = Frames[f];
+        char Id = 0;
+        uint32_t Size = 0;
+        ReadValue<char>(File, Id);
+        ReadValue<uint32_t>(File, Size);
+        if (!Test.TestEqual(TEXT("Positions packet"), static_cast<int32>(static_cast<uint8_t>(Id)),
+                            DREYEVR_COMPACT_POSITIONS_PACKET_ID))
+            return false;
+        PositionDecoder.Read(File, Size, Positions);
+        Test.TestEqual(TEXT("Number of actors"), static_cast<int32>(Positions.size()),
+                       static_cast<int32>(Frame.Positions.size()));
+        for (size_t i = 0; i < std::min(Positions.size(), Frame.Positions.size()); i++)
+        {
+            const CarlaRecorderPosition &Expected = Frame.Positions[i];
+            Test.TestEqual(TEXT("Actor id"), static_cast<int32>(Positions[i].DatabaseId),
+                           static_cast<int32>(Expected.DatabaseId));
+            // within a tenth of the quantization step of the quantized value
+            Test.TestEqual(TEXT("Location"), Positions[i].Location, QuantizeTest(Expected.Location, 0.1f), 0.01f);
+            Test.TestEqual(TEXT("Rotation"), Positions[i].Rotation, QuantizeTest(Expected.Rotation, 0.01f), 0.001f);
+        }
+
+        ReadValue<char>(File, Id);
+        ReadValue<uint32_t>(File, Size);
+        if (!Test.TestEqual(TEXT("Data packet"), static_cast<int32>(static_cast<uint8_t>(Id)),
+                            DREYEVR_COMPACT_DATA_PACKET_ID))
+            return false;
+        const std::vector<char> &Packet = DataDecoder.Read(File, Size);
+        Test.TestTrue(TEXT("DReyeVR packet is byte-identical"), Packet == Frame.Packet);
+    }
+    return Test.TestTrue(TEXT("File read"), static_cast<bool>(File));
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDReyeVRCompactRoundTripTest, "DReyeVR.Recorder.Compact.RoundTrip",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDReyeVRCompactRoundTripTest::RunTest(const FString &Parameters)
+{
+    const int32 Keyframe = 4;
+    const std::vector<CompactTestFrame> Frames = MakeTestFrames(10, Keyframe);
+    const FString Dir = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("DReyeVRCompact"));
+    IFileManager::Get().MakeDirectory(*Dir, true);
+    const FString Filename = Dir / TEXT("compact.bin");
+
+    // the packets of every frame, as the recorder writes them in compact mode
+    std::vector<std::streamoff> Offsets;
+    {
+        std::ofstream File(TCHAR_TO_UTF8(*Filename), std::ios::binary);
+        DReyeVR::CompactPositionEncoder PositionEncoder;
+        DReyeVR::CompactDataEncoder DataEncoder;
+        for (const CompactTestFrame &Frame : Frames)
+        {
+            Offsets.push_back(static_cast<std::streamoff>(File.tellp()));
+            PositionEncoder.Write(Frame.Positions, Frame.bIntra, File);
+            DataEncoder.Write(Frame.Packet, Frame.bIntra, File);
+        }
+        if (!TestTrue(TEXT("File written"), static_cast<bool>(File)))
+            return false;
+    }
+
+    // from the start, and from the keyframe (where seeking starts)
+    CheckCompactFrames(*this, Filename, Frames, Offsets, 0);
+    CheckCompactFrames(*this, Filename, Frames, Offsets, Keyframe);
+
+    IFileManager::Get().DeleteDirectory(*Dir, false, true);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,117 @@
+#include "DReyeVREyeSamples.h"
+#include "CarlaRecorderHelpers.h" // WriteValue, ReadValue
+#include "DReyeVRMappedFile.h"    // ReadSpan
+
+#include <algorithm> // std::min
+#include <sstream>
+
+namespace DReyeVR
+{
+
+static_assert(sizeof(PackedEyeSample) == 125, "PackedEyeSample must match the recorded layout");
+
+void PackedEyeSample::Pack(const EyeTracker &Sample)
+{
+    TimestampDevice = Sample.TimestampDevice;
+    FrameSequence = Sample.FrameSequence;
+    GazeDir = Sample.Combined.GazeDir;
+    GazeOrigin = Sample.Combined.GazeOrigin;
+    Vergence = Sample.Combined.Vergence;
+    const SingleEyeData *In[2] = {&Sample.Left, &Sample.Right};
+    Eye *Out[2] = {&Left, &Right};
+    for (int i = 0; i < 2; i++)
+    {
+        Out[i]->GazeDir = In[i]->GazeDir;
+        Out[i]->GazeOrigin = In[i]->GazeOrigin;
+        Out[i]->EyeOpenness = In[i]->EyeOpenness;
+        Out[i]->PupilDiameter = In[i]->PupilDiameter;
+        Out[i]->PupilPosition = In[i]->PupilPosition;
+    }
+    Valid = 0;
+    Valid |= Sample.Combined.GazeValid ? COMBINED_GAZE : 0;
+    Valid |= Sample.Left.GazeValid ? LEFT_GAZE : 0;
+    Valid |= Sample.Right.GazeValid ? RIGHT_GAZE : 0;
+    Valid |= Sample.Left.EyeOpennessValid ? LEFT_OPENNESS : 0;
+    Valid |= Sample.Right.EyeOpennessValid ? RIGHT_OPENNESS : 0;
+    Valid |= Sample.Left.PupilPositionValid ? LEFT_PUPIL_POSITION : 0;
+    Valid |= Sample.Right.PupilPositionValid ? RIGHT_PUPIL_POSITION : 0;
+}
+
+void PackedEyeSample::Unpack(EyeTracker &Sample) const
+{
+    Sample.TimestampDevice = TimestampDevice;
+    Sample.FrameSequence = FrameSequence;
+    Sample.Combined.GazeDir = GazeDir;
+    Sample.Combined.GazeOrigin = GazeOrigin;
+    Sample.Combined.Vergence = Vergence;
+    Sample.Combined.GazeValid = Valid & COMBINED_GAZE;
+    SingleEyeData *Out[2] = {&Sample.Left, &Sample.Right};
+    const Eye *In[2] = {&Left, &Right};
+    for (int i = 0; i < 2; i++)
+    {
+        Out[i]->GazeDir = In[i]->GazeDir;
+        Out[i]->GazeOrigin = In[i]->GazeOrigin;
+        Out[i]->EyeOpenness = In[i]->EyeOpenness;
+        Out[i]->PupilDiameter = In[i]->PupilDiameter;
+        Out[i]->PupilPosition = In[i]->PupilPosition;
+    }
+    Sample.Left.GazeValid = Valid & LEFT_GAZE;
+    Sample.Right.GazeValid = Valid & RIGHT_GAZE;
+    Sample.Left.EyeOpennessValid = Valid & LEFT_OPENNESS;
+    Sample.Right.EyeOpennessValid = Valid & RIGHT_OPENNESS;
+    Sample.Left.PupilPositionValid = Valid & LEFT_PUPIL_POSITION;
+    Sample.Right.PupilPositionValid = Valid & RIGHT_PUPIL_POSITION;
+}
+
+std::string PackedEyeSample::Print() const
+{
+    std::ostringstream oss;
+    oss << "  TimestampDevice:" << TimestampDevice << ", FrameSequence:" << FrameSequence;
+    oss << ", GazeDir:" << TCHAR_TO_UTF8(*GazeDir.ToString()) << ", GazeValid:" << bool(Valid & COMBINED_GAZE);
+    oss << ", Vergence:" << Vergence;
+    oss << ", LeftOpenness:" << Left.EyeOpenness << ", RightOpenness:" << Right.EyeOpenness;
+    oss << ", LeftPupilDiameter:" << Left.PupilDiameter << ", RightPupilDiameter:" << Right.PupilDiameter;
+    return oss.str();
+}
+
+void EyeSampleRecorder::Add(const std::vector<EyeTracker> &Samples)
+{
+    const size_t Start = AllSamples.size();
+    AllSamples.resize(Start + Samples.size());
+    for (size_t i = 0; i < Samples.size(); i++)
+        AllSamples[Start + i].Pack(Samples[i]);
+}
+
+void EyeSampleRecorder::Clear()
+{
+    AllSamples.clear();
+}
+
+void EyeSampleRecorder::Write(std::ofstream &OutFile) const
+{
+    // write the packet id
+    WriteValue<char>(OutFile, static_cast<char>(DREYEVR_EYE_SAMPLES_PACKET_ID));
+
+    // the size is known ahead of time (fixed-size records)
+    const uint16_t Total = static_cast<uint16_t>(std::min<size_t>(AllSamples.size(), UINT16_MAX));
+    WriteValue<uint32_t>(OutFile, sizeof(uint16_t) + Total * sizeof(PackedEyeSample));
+
+    WriteValue<uint16_t>(OutFile, Total);
+    OutFile.write(reinterpret_cast<const char *>(AllSamples.data()), Total * sizeof(PackedEyeSample));
+}
+
+const PackedEyeSample *EyeSampleRecorder::Read(std::ifstream &InFile, uint16_t &Total,
+                                               std::vector<PackedEyeSample> &Storage)
+{
+    ReadValue<uint16_t>(InFile, Total);
+    const PackedEyeSample *Samples = ReadSpan<PackedEyeSample>(InFile, Total);
+    if (Samples == nullptr)
+    {
+        Storage.resize(Total);
+        InFile.read(reinterpret_cast<char *>(Storage.data()), Total * sizeof(PackedEyeSample));
+        Samples = Storage.data();
+    }
+    return Samples;
+}
+
+}; // namespace DReyeVR
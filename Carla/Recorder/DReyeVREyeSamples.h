@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Carla/Sensor/DReyeVRData.h" // DReyeVR::EyeTracker
+
+// Every eye tracker sample taken during a frame (see AEgoSensor::RunEyeSampler), stored as a compact array.
+//
+// The DReyeVR (139) packet holds a single AggregateData per frame (the latest eye sample along with the ego, focus
+// and input data) so when the eye tracker runs faster than the game most samples would be lost. This packet is
+// written right after it with all the samples of the frame (oldest first) as packed fixed-size records, so it can
+// also be read in place from a memory-mapped file. Older readers just skip it.
+
+#define DREYEVR_EYE_SAMPLES_PACKET_ID 143
+
+namespace DReyeVR
+{
+
+#pragma pack(push, 1)
+struct CARLA_API PackedEyeSample
+{
+    enum ValidityFlags : uint8_t
+    {
+        COMBINED_GAZE = 1 << 0,
+        LEFT_GAZE = 1 << 1,
+        RIGHT_GAZE = 1 << 2,
+        LEFT_OPENNESS = 1 << 3,
+        RIGHT_OPENNESS = 1 << 4,
+        LEFT_PUPIL_POSITION = 1 << 5,
+        RIGHT_PUPIL_POSITION = 1 << 6,
+    };
+
+    struct Eye
+    {
+        FVector GazeDir;
+        FVector GazeOrigin;
+        float EyeOpenness;
+        float PupilDiameter;
+        FVector2D PupilPosition;
+    };
+
+    int64_t TimestampDevice;
+    int64_t FrameSequence;
+    FVector GazeDir; // combined
+    FVector GazeOrigin;
+    float Vergence;
+    Eye Left;
+    Eye Right;
+    uint8_t Valid; // ValidityFlags
+
+    void Pack(const EyeTracker &Sample);
+    void Unpack(EyeTracker &Sample) const;
+    std::string Print() const;
+};
+#pragma pack(pop)
+
+class CARLA_API EyeSampleRecorder
+{
+  public:
+    void Add(const std::vector<EyeTracker> &Samples);
+    void Clear();
+    bool IsEmpty() const
+    {
+        return AllSamples.empty();
+    }
+    void Write(std::ofstream &OutFile) const;
+
+    // reads the packet contents (after the header) in place when the file is memory-mapped
+    static const PackedEyeSample *Read(std::ifstream &InFile, uint16_t &Total, std::vector<PackedEyeSample> &Storage);
+
+  private:
+    std::vector<PackedEyeSample> AllSamples;
+};
+
+}; // namespace DReyeVR
@@ -0,0 +1,136 @@
+#include "DReyeVRFrameIndex.h"
+#include "CarlaRecorderHelpers.h" // WriteValue, ReadValue
+
+#include <algorithm> // std::upper_bound, std::lower_bound
+#include <cstring>   // std::memcmp, std::memcpy
+
+namespace DReyeVR
+{
+
+static const char FrameIndexMagic[8] = {'D', 'R', 'V', 'R', 'I', 'D', 'X', '1'};
+
+void FrameIndex::Reset()
+{
+    Entries.clear();
+    Keyframes.clear();
+    Elapsed = 0.0;
+    bIsValid = false;
+}
+
+void FrameIndex::AddFrame(double DeltaSeconds, uint64_t Offset, uint8_t Flags)
+{
+    /// NOTE: this mirrors CarlaRecorderFrames::SetFrame so the Id/Elapsed match what is written in the FrameStart
+    if (Entries.empty())
+        Elapsed = 0.0;
+    else
+        Elapsed += DeltaSeconds;
+    if (Flags & FRAME_KEYFRAME)
+        Keyframes.push_back(Entries.size());
+    Entries.push_back(Entry{Entries.size() + 1, Elapsed, Offset, Flags});
+}
+
+void FrameIndex::Write(std::ofstream &OutFile) const
+{
+    if (Entries.empty())
+        return;
+
+    const uint64_t PacketOffset = static_cast<uint64_t>(OutFile.tellp());
+
+    // write the packet id
+    WriteValue<char>(OutFile, static_cast<char>(DREYEVR_FRAME_INDEX_PACKET_ID));
+
+    // the size is known ahead of time so there is no need to patch it afterwards
+    const uint32_t Count = Entries.size();
+    const uint32_t Total = sizeof(uint32_t) + Count * sizeof(Entry) + sizeof(Trailer);
+    WriteValue<uint32_t>(OutFile, Total);
+
+    // write all the entries at once (they are packed PODs)
+    WriteValue<uint32_t>(OutFile, Count);
+    OutFile.write(reinterpret_cast<const char *>(Entries.data()), Count * sizeof(Entry));
+
+    // trailer goes last so it is always found at the end of the file
+    Trailer End;
+    End.PacketOffset = PacketOffset;
+    std::memcpy(End.Magic, FrameIndexMagic, sizeof(FrameIndexMagic));
+    WriteValue<Trailer>(OutFile, End);
+}
+
+bool FrameIndex::Read(std::ifstream &InFile)
+{
+    Reset();
+    const std::streampos Current = InFile.tellg();
+
+    // look for the trailer at the very end of the file
+    InFile.seekg(0, std::ios::end);
+    const uint64_t FileSize = static_cast<uint64_t>(InFile.tellg());
+    Trailer End;
+    if (FileSize > sizeof(Trailer))
+    {
+        InFile.seekg(-static_cast<std::streamoff>(sizeof(Trailer)), std::ios::end);
+        ReadValue<Trailer>(InFile, End);
+    }
+
+    if (InFile && FileSize > sizeof(Trailer) && std::memcmp(End.Magic, FrameIndexMagic, sizeof(FrameIndexMagic)) == 0 &&
+        End.PacketOffset < FileSize)
+    {
+        char Id;
+        uint32_t Total, Count;
+        InFile.seekg(End.PacketOffset, std::ios::beg);
+        ReadValue<char>(InFile, Id);
+        ReadValue<uint32_t>(InFile, Total);
+        ReadValue<uint32_t>(InFile, Count);
+        const bool bSizesMatch = (Total == sizeof(uint32_t) + uint64_t(Count) * sizeof(Entry) + sizeof(Trailer));
+        if (InFile && Id == static_cast<char>(DREYEVR_FRAME_INDEX_PACKET_ID) && bSizesMatch)
+        {
+            Entries.resize(Count);
+            InFile.read(reinterpret_cast<char *>(Entries.data()), Count * sizeof(Entry));
+            bIsValid = static_cast<bool>(InFile) && Count > 0;
+        }
+        for (size_t i = 0; bIsValid && i < Entries.size(); i++)
+        {
+            if (Entries[i].Flags & FRAME_KEYFRAME)
+                Keyframes.push_back(i);
+        }
+    }
+
+    if (!bIsValid)
+        Reset();
+
+    // return to original position
+    InFile.clear();
+    InFile.seekg(Current, std::ios::beg);
+    return bIsValid;
+}
+
+double FrameIndex::GetTotalTime() const
+{
+    return Entries.empty() ? 0.0 : Entries.back().Elapsed;
+}
+
+size_t FrameIndex::FindFrame(double Time) const
+{
+    // last frame that starts at or before Time
+    auto It = std::upper_bound(Entries.begin(), Entries.end(), Time,
+                               [](double T, const Entry &E) { return T < E.Elapsed; });
+    if (It == Entries.begin())
+        return 0;
+    return std::distance(Entries.begin(), It) - 1;
+}
+
+size_t FrameIndex::FindOffset(uint64_t Offset) const
+{
+    auto It = std::lower_bound(Entries.begin(), Entries.end(), Offset,
+                               [](const Entry &E, uint64_t O) { return E.Offset < O; });
+    return std::distance(Entries.begin(), It);
+}
+
+size_t FrameIndex::FindKeyframe(size_t Frame) const
+{
+    // last keyframe that is at or before Frame
+    auto It = std::upper_bound(Keyframes.begin(), Keyframes.end(), Frame);
+    if (It == Keyframes.begin())
+        return Entries.size();
+    return *(It - 1);
+}
+
+}; // namespace DReyeVR
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+// Frame index that is appended (as a regular packet) after the last FrameEnd of a recording so the replayer can
+// binary-search for the frame containing any time instead of parsing every packet header in the file.
+//
+// The packet looks like: [Id][Size][Count][Entries...][Trailer] and since the Trailer is the last thing in the file
+// a reader can find the index by reading the final sizeof(Trailer) bytes. Readers that do not know about this packet
+// just skip it like any other unknown packet, and files without the trailer fall back to the usual linear scan.
+
+#define DREYEVR_FRAME_INDEX_PACKET_ID 141
+
+namespace DReyeVR
+{
+
+enum FrameIndexFlags : uint8_t
+{
+    FRAME_NONE = 0,
+    FRAME_HAS_EVENTS = 1 << 0,  // frame has EventAdd/EventDel/EventParent records (must be visited when seeking)
+    FRAME_HAS_WEATHER = 1 << 1, // frame has a Weather packet (must be visited when seeking)
+    FRAME_KEYFRAME = 1 << 2,    // frame holds a full-state snapshot (seeking can start here)
+    FRAME_DELTA = 1 << 3,       // frame is delta-coded against the previous one (must be visited when seeking)
+};
+
+class CARLA_API FrameIndex
+{
+  public:
+#pragma pack(push, 1)
+    struct Entry
+    {
+        uint64_t Id;      // same as CarlaRecorderFrame::Id
+        double Elapsed;   // same as CarlaRecorderFrame::Elapsed
+        uint64_t Offset;  // file offset of this frame's FrameStart packet
+        uint8_t Flags;    // FrameIndexFlags
+    };
+
+    struct Trailer
+    {
+        uint64_t PacketOffset; // file offset of the frame index packet
+        char Magic[8];
+    };
+#pragma pack(pop)
+
+    // recorder
+    void Reset();
+    void AddFrame(double DeltaSeconds, uint64_t Offset, uint8_t Flags);
+    void Write(std::ofstream &OutFile) const;
+
+    // replayer
+    bool Read(std::ifstream &InFile); // returns false for (legacy) recordings without an index
+    bool IsValid() const
+    {
+        return bIsValid;
+    }
+    size_t Num() const
+    {
+        return Entries.size();
+    }
+    const Entry &operator[](size_t Idx) const
+    {
+        return Entries[Idx];
+    }
+    double GetTotalTime() const;
+    size_t FindFrame(double Time) const;       // index of the frame whose interval contains Time
+    size_t FindOffset(uint64_t Offset) const;  // index of the first frame starting at or after Offset
+    size_t FindKeyframe(size_t Frame) const;   // index of the last keyframe at or before Frame (Num() if none)
+
+  private:
+    std::vector<Entry> Entries;
+    std::vector<size_t> Keyframes; // indices (into Entries) of the frames flagged as FRAME_KEYFRAME
+    double Elapsed = 0.0;
+    bool bIsValid = false;
+};
+
+}; // namespace DReyeVR
@@ -0,0 +1,94 @@
+#include "DReyeVRGazeEvents.h"
+#include "CarlaRecorderHelpers.h" // WriteValue, ReadValue, WriteFVector, ReadFVector
+
+#include <algorithm> // std::min
+#include <sstream>
+
+namespace DReyeVR
+{
+
+void GazeEventRecorder::Add(const std::vector<GazeEvent> &Events)
+{
+    AllEvents.insert(AllEvents.end(), Events.begin(), Events.end());
+}
+
+void GazeEventRecorder::Clear()
+{
+    AllEvents.clear();
+}
+
+void GazeEventRecorder::Write(std::ofstream &OutFile)
+{
+    const size_t Offset = Packet.BeginPacket(static_cast<char>(DREYEVR_GAZE_EVENTS_PACKET_ID));
+    const uint16_t Total = static_cast<uint16_t>(std::min<size_t>(AllEvents.size(), UINT16_MAX));
+    WriteValue<uint16_t>(Packet, Total);
+    for (uint16_t i = 0; i < Total; ++i)
+    {
+        const GazeEvent &E = AllEvents[i];
+        WriteValue<uint8_t>(Packet, static_cast<uint8_t>(E.Type));
+        WriteValue<int64_t>(Packet, E.TimestampDevice);
+        WriteValue<int64_t>(Packet, E.DetectedAt);
+        WriteValue<float>(Packet, E.DurationMs);
+        WriteFVector(Packet, E.Centroid);
+        WriteValue<float>(Packet, E.Amplitude);
+        WriteValue<float>(Packet, E.PeakVelocity);
+    }
+    Packet.EndPacket(Offset);
+    Packet.Flush(OutFile);
+}
+
+void GazeEventRecorder::Read(BinaryReader &In, std::vector<GazeEvent> &Out)
+{
+    uint16_t Total = 0;
+    ReadValue<uint16_t>(In, Total);
+    const size_t Start = Out.size(); // appends (the replayer collects the events of all the frames played in a tick)
+    Out.resize(Start + Total);
+    for (uint16_t i = 0; i < Total && !In.HasFailed(); ++i)
+    {
+        GazeEvent &E = Out[Start + i];
+        uint8_t Type = 0;
+        ReadValue<uint8_t>(In, Type);
+        E.Type = static_cast<GazeEventType>(Type);
+        ReadValue<int64_t>(In, E.TimestampDevice);
+        ReadValue<int64_t>(In, E.DetectedAt);
+        ReadValue<float>(In, E.DurationMs);
+        ReadFVector(In, E.Centroid);
+        ReadValue<float>(In, E.Amplitude);
+        ReadValue<float>(In, E.PeakVelocity);
+    }
+    if (In.HasFailed())
+        Out.resize(Start); // truncated packet
+}
+
+const char *GazeEventRecorder::TypeName(GazeEventType Type)
+{
+    switch (Type)
+    {
+    case GazeEventType::FixationStart:
+        return "fixation_start";
+    case GazeEventType::FixationEnd:
+        return "fixation_end";
+    case GazeEventType::Saccade:
+        return "saccade";
+    default:
+        return "none";
+    }
+}
+
+std::string GazeEventRecorder::Print(const std::vector<GazeEvent> &Events)
+{
+    std::ostringstream oss;
+    for (const GazeEvent &E : Events)
+    {
+        oss << "  " << TypeName(E.Type) << " at " << E.TimestampDevice << " (detected at " << E.DetectedAt
+            << "): duration " << E.DurationMs << "ms, amplitude " << E.Amplitude << "deg";
+        if (E.Type == GazeEventType::Saccade)
+            oss << ", peak velocity " << E.PeakVelocity << "deg/s";
+        else
+            oss << ", centroid (" << E.Centroid.X << ", " << E.Centroid.Y << ", " << E.Centroid.Z << ")";
+        oss << std::endl;
+    }
+    return oss.str();
+}
+
+}; // namespace DReyeVR
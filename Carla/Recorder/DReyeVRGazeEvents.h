@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Carla/Sensor/DReyeVRData.h" // DReyeVR::GazeEvent
+#include "DReyeVRBinaryIO.h"          // DReyeVR::BinaryWriter, DReyeVR::BinaryReader
+
+// Fixations and saccades detected on the eye samples (see DReyeVR::FixationDetector), written after the attention
+// weights as [uint16 Total] then Total times [uint8 Type][int64 TimestampDevice][int64 DetectedAt][float DurationMs]
+// [FVector Centroid][float Amplitude][float PeakVelocity] (oldest first). Only frames where an event was detected have
+// such a packet, and older readers just skip it.
+
+#define DREYEVR_GAZE_EVENTS_PACKET_ID 147
+
+namespace DReyeVR
+{
+
+class CARLA_API GazeEventRecorder
+{
+  public:
+    // accumulates the events of every tick until the frame is written (ticks can be folded into one frame)
+    void Add(const std::vector<GazeEvent> &Events);
+    void Clear();
+    bool IsEmpty() const
+    {
+        return AllEvents.empty();
+    }
+    void Write(std::ofstream &OutFile);
+
+    // reads the packet contents (after the header), appending to Out
+    static void Read(BinaryReader &In, std::vector<GazeEvent> &Out);
+    static std::string Print(const std::vector<GazeEvent> &Events);
+    static const char *TypeName(GazeEventType Type);
+
+  private:
+    std::vector<GazeEvent> AllEvents;
+    BinaryWriter Packet;
+};
+
+}; // namespace DReyeVR
@@ -0,0 +1,72 @@
+#include "DReyeVRKeyframe.h"
+#include "CarlaRecorderHelpers.h" // WriteValue, ReadValue
+
+namespace DReyeVR
+{
+
+void Keyframe::Clear()
+{
+    Actors.clear();
+    Parents.clear();
+    Lights.clear();
+    bHasWeather = false;
+}
+
+void Keyframe::Read(BinaryReader &In)
+{
+    Clear();
+    uint16_t Total;
+
+    // the carla records can only be read from a stream
+    ReadValue<uint16_t>(In, Total);
+    Actors.resize(Total);
+    for (auto &Actor : Actors)
+        In.ReadStream(Actor);
+
+    ReadValue<uint16_t>(In, Total);
+    Parents.resize(Total);
+    for (auto &Parent : Parents)
+        In.ReadStream(Parent);
+
+    ReadValue<uint16_t>(In, Total);
+    Lights.resize(Total);
+    for (auto &Light : Lights)
+        In.ReadStream(Light);
+
+    ReadValue<bool>(In, bHasWeather);
+    if (bHasWeather)
+        Weather.Read(In);
+}
+
+void Keyframe::Write(BinaryWriter &Out) const
+{
+    const size_t Start = Out.BeginPacket(static_cast<char>(DREYEVR_KEYFRAME_PACKET_ID));
+
+    WriteValue<uint16_t>(Out, Actors.size());
+    for (const auto &Actor : Actors)
+        Out.WriteStream(Actor);
+
+    WriteValue<uint16_t>(Out, Parents.size());
+    for (const auto &Parent : Parents)
+        Out.WriteStream(Parent);
+
+    WriteValue<uint16_t>(Out, Lights.size());
+    for (const auto &Light : Lights)
+        Out.WriteStream(Light);
+
+    WriteValue<bool>(Out, bHasWeather);
+    if (bHasWeather)
+        Weather.Write(Out);
+
+    Out.EndPacket(Start);
+}
+
+void Keyframe::Write(std::ofstream &OutFile) const
+{
+    // keyframes are rare, no need to keep the buffer around
+    BinaryWriter Packet;
+    Write(Packet);
+    Packet.Flush(OutFile);
+}
+
+}; // namespace DReyeVR
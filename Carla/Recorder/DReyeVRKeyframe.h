@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#include "CarlaRecorderEventAdd.h"
+#include "CarlaRecorderEventParent.h"
+#include "CarlaRecorderLightScene.h"
+#include "CarlaRecorderWeather.h"
+#include "DReyeVRBinaryIO.h"
+
+// Full-state keyframe packet that is periodically written at the start of a frame so the replayer can reconstruct
+// the world at that frame without replaying every EventAdd/EventDel/EventParent from the beginning of the file.
+//
+// Only the state that is otherwise recorded as deltas is stored here (which actors exist along with their
+// descriptions & transforms, parenting, scene lights, and the weather). Positions, traffic light states, vehicle
+// lights and the DReyeVR AggregateData are already written on every frame so they come from the keyframe's own frame.
+//
+// Keyframes are only written on frames without events or weather changes, so the snapshot is valid both at the
+// start and at the end of its frame. These frames are marked with FRAME_KEYFRAME in the frame index.
+
+#define DREYEVR_KEYFRAME_PACKET_ID 142
+
+namespace DReyeVR
+{
+
+class CARLA_API Keyframe
+{
+  public:
+    std::vector<CarlaRecorderEventAdd> Actors;      // all live actors (as if they were just spawned)
+    std::vector<CarlaRecorderEventParent> Parents;  // parenting of the live actors
+    std::vector<CarlaRecorderLightScene> Lights;    // state of all the scene lights
+    bool bHasWeather = false;
+    CarlaRecorderWeather Weather;
+
+    void Clear();
+    void Read(BinaryReader &In); // the body of the packet
+    void Write(BinaryWriter &Out) const;
+    void Write(std::ofstream &OutFile) const;
+};
+
+}; // namespace DReyeVR
@@ -0,0 +1,106 @@
+#include "DReyeVRMappedFile.h"
+
+#include "HAL/PlatformFilemanager.h" // FPlatformFileManager
+
+namespace DReyeVR
+{
+
+void MappedStreamBuf::SetData(const char *Begin, size_t Size)
+{
+    // the get area is the whole (read-only) mapping, the const_cast is just to satisfy the std::streambuf interface
+    char *Data = const_cast<char *>(Begin);
+    setg(Data, Data, Data + Size);
+}
+
+const char *MappedStreamBuf::View(size_t Count)
+{
+    if (static_cast<size_t>(egptr() - gptr()) < Count)
+        return nullptr;
+    const char *Ptr = gptr();
+    setg(eback(), gptr() + Count, egptr());
+    return Ptr;
+}
+
+MappedStreamBuf::pos_type MappedStreamBuf::seekoff(off_type Off, std::ios_base::seekdir Dir,
+                                                   std::ios_base::openmode Which)
+{
+    switch (Dir)
+    {
+    case std::ios_base::beg:
+        return seekpos(pos_type(Off), Which);
+    case std::ios_base::cur:
+        return seekpos(pos_type(static_cast<off_type>(gptr() - eback()) + Off), Which);
+    case std::ios_base::end:
+        return seekpos(pos_type(static_cast<off_type>(egptr() - eback()) + Off), Which);
+    default:
+        return pos_type(off_type(-1));
+    }
+}
+
+MappedStreamBuf::pos_type MappedStreamBuf::seekpos(pos_type Pos, std::ios_base::openmode Which)
+{
+    const off_type Target = static_cast<off_type>(Pos);
+    if (!(Which & std::ios_base::in) || Target < 0 || Target > static_cast<off_type>(egptr() - eback()))
+        return pos_type(off_type(-1));
+    setg(eback(), eback() + Target, egptr());
+    return Pos;
+}
+
+MappedFile::~MappedFile()
+{
+    Region.Reset();
+    Handle.Reset();
+}
+
+bool MappedFile::Open(std::ifstream &Stream, const std::string &Filename, bool bMap)
+{
+    Close(Stream);
+
+    IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (bMap)
+        Handle.Reset(PlatformFile.OpenMapped(UTF8_TO_TCHAR(Filename.c_str())));
+    if (Handle.IsValid() && Handle->GetFileSize() > 0)
+    {
+        Region.Reset(Handle->MapRegion(0, Handle->GetFileSize()));
+    }
+
+    if (!Region.IsValid())
+    {
+        // not every platform supports mapping, just read the file normally
+        Handle.Reset();
+        Stream.open(Filename, std::ios::binary);
+        return Stream.is_open();
+    }
+
+    Buffer.SetData(reinterpret_cast<const char *>(Region->GetMappedPtr()), Region->GetMappedSize());
+    // ifstream::rdbuf hides the std::ios setter
+    static_cast<std::ios &>(Stream).rdbuf(&Buffer);
+    return true;
+}
+
+void MappedFile::Close(std::ifstream &Stream)
+{
+    if (Region.IsValid())
+    {
+        static_cast<std::ios &>(Stream).rdbuf(Stream.rdbuf());
+        Buffer.SetData(nullptr, 0);
+        Region.Reset();
+        Handle.Reset();
+    }
+    else if (Stream.is_open())
+    {
+        Stream.close();
+    }
+    Stream.clear();
+}
+
+const char *ReadView(std::ifstream &InFile, size_t Count)
+{
+    // the only buffer (other than the stream's own file buffer) that is ever installed on an ifstream is ours
+    std::streambuf *Buf = static_cast<std::istream &>(InFile).rdbuf();
+    if (!InFile || Buf == InFile.rdbuf())
+        return nullptr;
+    return static_cast<MappedStreamBuf *>(Buf)->View(Count);
+}
+
+}; // namespace DReyeVR
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <streambuf>
+#include <string>
+
+#include "Async/MappedFileHandle.h" // IMappedFileHandle, IMappedFileRegion
+#include "Templates/UniquePtr.h"    // TUniquePtr
+
+// Memory-mapped read layer shared by the replayer and the recorder queries.
+//
+// All the recorder packets are read through an std::ifstream (see the many Read(std::ifstream &) functions) so the
+// mapping is exposed as a read-only std::streambuf that replaces the stream's own file buffer. Existing readers keep
+// working unchanged (every ReadValue becomes a memcpy out of the mapping with no syscalls, and seeking/skipping
+// packets is just pointer arithmetic) while the hot paths can use ReadView/ReadSpan to access the bytes in place.
+// If the file cannot be mapped the stream is opened normally and ReadView/ReadSpan return nullptr.
+
+namespace DReyeVR
+{
+
+class CARLA_API MappedStreamBuf : public std::streambuf
+{
+  public:
+    void SetData(const char *Begin, size_t Size);
+    // pointer to the next Count bytes (and skip over them), nullptr if there are not enough bytes left
+    const char *View(size_t Count);
+
+  protected:
+    pos_type seekoff(off_type Off, std::ios_base::seekdir Dir, std::ios_base::openmode Which) override;
+    pos_type seekpos(pos_type Pos, std::ios_base::openmode Which) override;
+};
+
+class CARLA_API MappedFile
+{
+  public:
+    ~MappedFile();
+    // maps Filename and redirects Stream to it (falls back to opening Stream directly, or always with bMap = false),
+    // false if it can't be opened
+    bool Open(std::ifstream &Stream, const std::string &Filename, bool bMap = true);
+    // unmaps the file and gives the stream back its own file buffer
+    void Close(std::ifstream &Stream);
+    bool IsMapped() const
+    {
+        return Region.IsValid();
+    }
+
+  private:
+    MappedStreamBuf Buffer;
+    TUniquePtr<IMappedFileHandle> Handle;
+    TUniquePtr<IMappedFileRegion> Region;
+};
+
+// zero-copy view of the next Count bytes of InFile (nullptr if it is not memory-mapped)
+const char *ReadView(std::ifstream &InFile, size_t Count);
+
+// zero-copy view of the next Count packed POD records of InFile (nullptr if it is not memory-mapped)
+template <typename T> const T *ReadSpan(std::ifstream &InFile, size_t Count)
+{
+    return reinterpret_cast<const T *>(ReadView(InFile, Count * sizeof(T)));
+}
+
+}; // namespace DReyeVR
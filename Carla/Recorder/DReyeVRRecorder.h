@@ -16,13 +16,13 @@ template <typename T> struct DReyeVRDataRecorder
         Data = (*DataIn);
     }
     T Data;
-    void Read(std::ifstream &InFile)
+    void Read(DReyeVR::BinaryReader &In)
     {
-        Data.Read(InFile);
+        Data.Read(In);
     }
-    void Write(std::ofstream &OutFile) const
+    void Write(DReyeVR::BinaryWriter &Out) const
     {
-        Data.Write(OutFile);
+        Data.Write(Out);
     }
     std::string GetUniqueName() const
     {
@@ -41,7 +41,8 @@ template <typename T, uint8_t N> class DReyeVRDataRecorders
 {
 
   public:
-    void Add(const DReyeVRDataRecorder<T> &NewData)
+    // the records are written in the same tick they are added, so only the (immutable) snapshots are referenced
+    void Add(const T *NewData)
     {
         AllData.push_back(NewData);
     }
@@ -49,33 +50,28 @@ template <typename T, uint8_t N> class DReyeVRDataRecorders
     {
         AllData.clear();
     }
+    // serializes the whole packet in memory, then writes it at once
     void Write(std::ofstream &OutFile)
     {
-        // write the packet id
-        WriteValue<char>(OutFile, static_cast<char>(PacketId));
-        std::streampos PosStart = OutFile.tellp();
-
-        // write a dummy packet size
-        uint32_t Total = 0;
-        WriteValue<uint32_t>(OutFile, Total);
+        Write(Packet);
+        Packet.Flush(OutFile);
+    }
+    void Write(DReyeVR::BinaryWriter &Out) const
+    {
+        const size_t Start = Out.BeginPacket(static_cast<char>(PacketId));
 
         // write total records
-        Total = AllData.size();
-        WriteValue<uint16_t>(OutFile, Total);
+        WriteValue<uint16_t>(Out, static_cast<uint16_t>(AllData.size()));
 
-        for (auto &Snapshot : AllData)
-            Snapshot.Write(OutFile);
+        for (const T *Snapshot : AllData)
+            Snapshot->Write(Out);
 
-        // write the real packet size
-        std::streampos PosEnd = OutFile.tellp();
-        Total = PosEnd - PosStart - sizeof(uint32_t);
-        OutFile.seekp(PosStart, std::ios::beg);
-        WriteValue<uint32_t>(OutFile, Total);
-        OutFile.seekp(PosEnd, std::ios::beg);
+        Out.EndPacket(Start);
     }
 
   private:
     // using a vector as a queue that holds everything, gets written and flushed on every tick
-    std::vector<DReyeVRDataRecorder<T>> AllData;
+    std::vector<const T *> AllData;
+    DReyeVR::BinaryWriter Packet; // reused every tick
     uint8_t PacketId = N;
 };
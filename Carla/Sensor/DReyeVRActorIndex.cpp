@@ -0,0 +1,332 @@
+#include "DReyeVRActorIndex.h"
+
+#include <algorithm> // std::nth_element, std::sort
+
+namespace DReyeVR
+{
+
+void ActorBoxIndex::BeginUpdate()
+{
+    for (Box &B : Boxes)
+        B.bUpdated = false;
+}
+
+void ActorBoxIndex::UpdateActor(uint32 Id, const FVector &Location, const FQuat &Rotation, const FVector &BoxOrigin,
+                                const FVector &BoxExtent)
+{
+    const int32 *Slot = Slots.Find(Id);
+    if (Slot == nullptr)
+    {
+        Slots.Add(Id, Boxes.Num());
+        Box &B = Boxes.AddDefaulted_GetRef();
+        B = {Id, Location, Rotation, BoxOrigin, BoxExtent};
+        B.bUpdated = true;
+        ComputeBounds(B);
+        bNeedsBuild = true;
+        return;
+    }
+    Box &B = Boxes[*Slot];
+    B.bUpdated = true;
+    if (B.Location == Location && B.Rotation == Rotation && B.BoxOrigin == BoxOrigin && B.BoxExtent == BoxExtent)
+        return; // most actors (parked vehicles, props) do not move
+    B.Location = Location;
+    B.Rotation = Rotation;
+    B.BoxOrigin = BoxOrigin;
+    B.BoxExtent = BoxExtent;
+    ComputeBounds(B);
+    bNeedsRefit = true;
+}
+
+void ActorBoxIndex::EndUpdate()
+{
+    for (int32 i = Boxes.Num() - 1; i >= 0; i--)
+    {
+        if (Boxes[i].bUpdated)
+            continue;
+        Slots.Remove(Boxes[i].Id);
+        Boxes.RemoveAtSwap(i, 1, false);
+        if (i < Boxes.Num())
+            Slots[Boxes[i].Id] = i; // the last box took its place
+        bNeedsBuild = true;
+    }
+
+    if (bNeedsBuild)
+    {
+        Build();
+    }
+    else if (bNeedsRefit)
+    {
+        // the topology of the tree stays that of the last build, so once the boxes have moved around enough it gets
+        // loose (large overlapping nodes) and the queries slow down
+        if (Refit() > 2.f * BuiltArea)
+            Build();
+    }
+    bNeedsBuild = false;
+    bNeedsRefit = false;
+}
+
+void ActorBoxIndex::Clear()
+{
+    Boxes.Reset();
+    Slots.Reset();
+    Nodes.Reset();
+    bNeedsBuild = false;
+    bNeedsRefit = false;
+    BuiltArea = 0.f;
+}
+
+void ActorBoxIndex::ComputeBounds(Box &B) const
+{
+    B.Center = B.Location + B.Rotation.RotateVector(B.BoxOrigin);
+    // half size of the world AABB: the extent along each (rotated) box axis projected onto the world axes
+    const FVector X = B.BoxExtent.X * B.Rotation.GetAxisX();
+    const FVector Y = B.BoxExtent.Y * B.Rotation.GetAxisY();
+    const FVector Z = B.BoxExtent.Z * B.Rotation.GetAxisZ();
+    const FVector Half = X.GetAbs() + Y.GetAbs() + Z.GetAbs();
+    B.AABBMin = B.Center - Half;
+    B.AABBMax = B.Center + Half;
+}
+
+/// ========================================== ///
+/// -----------------:BUILD:------------------ ///
+/// ========================================== ///
+
+void ActorBoxIndex::Build()
+{
+    Nodes.Reset();
+    BuildItems.SetNumUninitialized(Boxes.Num());
+    for (int32 i = 0; i < Boxes.Num(); i++)
+        BuildItems[i] = i;
+    if (Boxes.Num() > 0)
+        BuildNode(0, Boxes.Num());
+    BuiltArea = Refit(); // computes all the bounds
+}
+
+int32 ActorBoxIndex::BuildNode(int32 First, int32 Count)
+{
+    // no references into Nodes are kept across the recursion (it may reallocate)
+    const int32 Index = Nodes.AddZeroed();
+    if (Count <= 4)
+    {
+        for (int32 Lane = 0; Lane < Count; Lane++)
+            Nodes[Index].Child[Lane] = ~BuildItems[First + Lane];
+        Nodes[Index].NumChildren = Count;
+        return Index;
+    }
+
+    // splits [Begin, End) at Mid along the longest axis of the box centers
+    auto Partition = [this](int32 Begin, int32 Mid, int32 End) {
+        FBox Centers(ForceInit);
+        for (int32 i = Begin; i < End; i++)
+            Centers += Boxes[BuildItems[i]].Center;
+        const FVector Size = Centers.GetSize();
+        const int32 Axis = (Size.X >= Size.Y && Size.X >= Size.Z) ? 0 : (Size.Y >= Size.Z ? 1 : 2);
+        int32 *Items = BuildItems.GetData();
+        std::nth_element(Items + Begin, Items + Mid, Items + End,
+                         [this, Axis](int32 A, int32 B) { return Boxes[A].Center[Axis] < Boxes[B].Center[Axis]; });
+    };
+
+    // 4 groups: the halves at the median, and each half at its own median
+    int32 Bounds[5];
+    Bounds[0] = First;
+    Bounds[2] = First + Count / 2;
+    Bounds[4] = First + Count;
+    Bounds[1] = Bounds[0] + (Bounds[2] - Bounds[0]) / 2;
+    Bounds[3] = Bounds[2] + (Bounds[4] - Bounds[2]) / 2;
+    Partition(Bounds[0], Bounds[2], Bounds[4]);
+    Partition(Bounds[0], Bounds[1], Bounds[2]);
+    Partition(Bounds[2], Bounds[3], Bounds[4]);
+
+    for (int32 Lane = 0; Lane < 4; Lane++)
+    {
+        const int32 GroupSize = Bounds[Lane + 1] - Bounds[Lane]; // at least 1 since Count > 4
+        const int32 Child = GroupSize == 1 ? ~BuildItems[Bounds[Lane]] : BuildNode(Bounds[Lane], GroupSize);
+        Nodes[Index].Child[Lane] = Child;
+    }
+    Nodes[Index].NumChildren = 4;
+    return Index;
+}
+
+void ActorBoxIndex::GetChildBounds(int32 Child, FVector &Min, FVector &Max) const
+{
+    if (Child < 0)
+    {
+        Min = Boxes[~Child].AABBMin;
+        Max = Boxes[~Child].AABBMax;
+        return;
+    }
+    const Node &N = Nodes[Child];
+    Min = FVector(N.MinX[0], N.MinY[0], N.MinZ[0]);
+    Max = FVector(N.MaxX[0], N.MaxY[0], N.MaxZ[0]);
+    for (int32 Lane = 1; Lane < N.NumChildren; Lane++)
+    {
+        Min = Min.ComponentMin(FVector(N.MinX[Lane], N.MinY[Lane], N.MinZ[Lane]));
+        Max = Max.ComponentMax(FVector(N.MaxX[Lane], N.MaxY[Lane], N.MaxZ[Lane]));
+    }
+}
+
+void ActorBoxIndex::SetLane(Node &N, int32 Lane, int32 Child) const
+{
+    FVector Min = FVector::ZeroVector, Max = FVector::ZeroVector; // unused lanes are masked out by NumChildren
+    if (Lane < N.NumChildren)
+        GetChildBounds(Child, Min, Max);
+    N.MinX[Lane] = Min.X;
+    N.MinY[Lane] = Min.Y;
+    N.MinZ[Lane] = Min.Z;
+    N.MaxX[Lane] = Max.X;
+    N.MaxY[Lane] = Max.Y;
+    N.MaxZ[Lane] = Max.Z;
+}
+
+float ActorBoxIndex::Refit()
+{
+    float Area = 0.f;
+    // children come after their parent, so going backwards every child is up to date before its parent
+    for (int32 n = Nodes.Num() - 1; n >= 0; n--)
+    {
+        Node &N = Nodes[n];
+        for (int32 Lane = 0; Lane < 4; Lane++)
+        {
+            SetLane(N, Lane, N.Child[Lane]);
+            const FVector Size(N.MaxX[Lane] - N.MinX[Lane], N.MaxY[Lane] - N.MinY[Lane], N.MaxZ[Lane] - N.MinZ[Lane]);
+            Area += Size.X * Size.Y + Size.Y * Size.Z + Size.Z * Size.X;
+        }
+    }
+    return Area;
+}
+
+/// ========================================== ///
+/// -----------------:QUERY:------------------ ///
+/// ========================================== ///
+
+bool ActorBoxIndex::Raycast(const FVector &Start, const FVector &End, Hit &Out, uint32 IgnoreId) const
+{
+    if (Nodes.Num() == 0)
+        return false;
+
+    // the segment is Start + T * Dir for T in [0, 1]
+    const FVector Dir = End - Start;
+    // a zero component would make 0 * inf = NaN in the slab test, a tiny one just gives a huge (finite) slab
+    FVector InvDir;
+    for (int32 Axis = 0; Axis < 3; Axis++)
+    {
+        const float D = FMath::Abs(Dir[Axis]) < SMALL_NUMBER ? (Dir[Axis] < 0.f ? -SMALL_NUMBER : SMALL_NUMBER)
+                                                             : Dir[Axis];
+        InvDir[Axis] = 1.f / D;
+    }
+    const VectorRegister Ox = VectorSetFloat1(Start.X), Oy = VectorSetFloat1(Start.Y), Oz = VectorSetFloat1(Start.Z);
+    const VectorRegister Ix = VectorSetFloat1(InvDir.X), Iy = VectorSetFloat1(InvDir.Y), Iz = VectorSetFloat1(InvDir.Z);
+
+    struct StackEntry
+    {
+        int32 Node;
+        float TNear; // where the ray enters the node
+    };
+    // the tree is balanced (median splits) so this is enough for a depth of 20, i.e. way more actors than a world has
+    constexpr int32 StackSize = 64;
+    StackEntry Stack[StackSize];
+    int32 Top = 0;
+    Stack[Top++] = {0, 0.f};
+
+    float TMax = 1.f; // of the closest hit so far
+    bool bHit = false;
+    while (Top > 0)
+    {
+        const StackEntry Entry = Stack[--Top];
+        if (Entry.TNear > TMax)
+            continue; // something closer was hit since this node was pushed
+        const Node &N = Nodes[Entry.Node];
+
+        // slab test of the 4 children at once
+        const VectorRegister T1x = VectorMultiply(VectorSubtract(VectorLoadAligned(N.MinX), Ox), Ix);
+        const VectorRegister T2x = VectorMultiply(VectorSubtract(VectorLoadAligned(N.MaxX), Ox), Ix);
+        const VectorRegister T1y = VectorMultiply(VectorSubtract(VectorLoadAligned(N.MinY), Oy), Iy);
+        const VectorRegister T2y = VectorMultiply(VectorSubtract(VectorLoadAligned(N.MaxY), Oy), Iy);
+        const VectorRegister T1z = VectorMultiply(VectorSubtract(VectorLoadAligned(N.MinZ), Oz), Iz);
+        const VectorRegister T2z = VectorMultiply(VectorSubtract(VectorLoadAligned(N.MaxZ), Oz), Iz);
+        const VectorRegister TNear = VectorMax(VectorMax(VectorMin(T1x, T2x), VectorMin(T1y, T2y)),
+                                               VectorMax(VectorMin(T1z, T2z), VectorZero()));
+        const VectorRegister TFar = VectorMin(VectorMin(VectorMax(T1x, T2x), VectorMax(T1y, T2y)),
+                                              VectorMin(VectorMax(T1z, T2z), VectorSetFloat1(TMax)));
+        const int32 Mask = VectorMaskBits(VectorCompareGE(TFar, TNear)) & ((1 << N.NumChildren) - 1);
+        if (Mask == 0)
+            continue;
+        alignas(16) float Near[4];
+        VectorStoreAligned(TNear, Near);
+
+        // the boxes are tested right away, the nodes are pushed farthest first so the nearest one is visited next
+        StackEntry Children[4];
+        int32 NumChildren = 0;
+        for (int32 Lane = 0; Lane < N.NumChildren; Lane++)
+        {
+            if ((Mask & (1 << Lane)) == 0)
+                continue;
+            const int32 Child = N.Child[Lane];
+            if (Child < 0)
+            {
+                const Box &B = Boxes[~Child];
+                if (B.Id != IgnoreId && IntersectBox(B, Start, Dir, TMax, Out))
+                    bHit = true;
+            }
+            else
+            {
+                Children[NumChildren++] = {Child, Near[Lane]};
+            }
+        }
+        std::sort(Children, Children + NumChildren,
+                  [](const StackEntry &A, const StackEntry &B) { return A.TNear > B.TNear; });
+        check(Top + NumChildren <= StackSize);
+        for (int32 i = 0; i < NumChildren; i++)
+            Stack[Top++] = Children[i];
+    }
+    return bHit;
+}
+
+bool ActorBoxIndex::IntersectBox(const Box &B, const FVector &Start, const FVector &Dir, float &TMax, Hit &Out) const
+{
+    // slab test in the space of the box, where it is axis aligned and centered
+    const FVector O = B.Rotation.UnrotateVector(Start - B.Center);
+    const FVector D = B.Rotation.UnrotateVector(Dir);
+    const FVector &E = B.BoxExtent;
+    if (FMath::Abs(O.X) <= E.X && FMath::Abs(O.Y) <= E.Y && FMath::Abs(O.Z) <= E.Z)
+        return false; // starts inside
+
+    float TNear = 0.f;
+    float TFar = TMax;
+    int32 EntryAxis = -1;
+    for (int32 Axis = 0; Axis < 3; Axis++)
+    {
+        if (FMath::Abs(D[Axis]) < SMALL_NUMBER)
+        {
+            // parallel to this slab
+            if (FMath::Abs(O[Axis]) > E[Axis])
+                return false;
+            continue;
+        }
+        float T1 = (-E[Axis] - O[Axis]) / D[Axis];
+        float T2 = (E[Axis] - O[Axis]) / D[Axis];
+        if (T1 > T2)
+            Swap(T1, T2);
+        if (T1 > TNear)
+        {
+            TNear = T1;
+            EntryAxis = Axis;
+        }
+        TFar = FMath::Min(TFar, T2);
+        if (TNear > TFar)
+            return false;
+    }
+    if (EntryAxis < 0)
+        return false; // only when the start is on the surface
+
+    FVector Normal = FVector::ZeroVector;
+    Normal[EntryAxis] = D[EntryAxis] > 0.f ? -1.f : 1.f;
+    TMax = TNear;
+    Out.Id = B.Id;
+    Out.Distance = TNear * Dir.Size();
+    Out.Location = Start + TNear * Dir;
+    Out.Normal = B.Rotation.RotateVector(Normal);
+    return true;
+}
+
+}; // namespace DReyeVR
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "CoreMinimal.h" // FVector, FQuat, TArray, TMap, VectorRegister
+
+#include <cstdint>
+
+// Ray queries against the bounding boxes of the actors, without going through the physics scene. Used for the
+// physics-free gaze focus of AEgoSensor (BoundingBoxFocus) and to re-attribute the gaze of recordings offline (see
+// CarlaRecorderQuery::QueryExport), where there is no physics scene at all.
+//
+// Every actor is an oriented box: its bounding box (in the actor's local space, like FActorInfo::BoundingBox) placed
+// by the actor's transform. The boxes are kept in a 4-wide BVH over their world-space AABBs. Each node holds the
+// bounds of its (up to) 4 children in SoA layout so a ray is slab-tested against all of them at once with the UE4
+// vector intrinsics, and the boxes at the leaves are then tested exactly in their own space.
+//
+// The index is updated from the actor transforms every frame. Actors that did not move are not touched, when boxes
+// only moved the node bounds are refit bottom-up, and the tree is only rebuilt when actors come or go or when refitting
+// has made it too loose.
+
+namespace DReyeVR
+{
+
+class CARLA_API ActorBoxIndex
+{
+  public:
+    struct Hit
+    {
+        uint32 Id = 0;
+        float Distance = 0.f; // from the start of the ray
+        FVector Location = FVector::ZeroVector;
+        FVector Normal = FVector::ZeroVector; // of the face of the box the ray entered through
+    };
+
+    // once per frame: BeginUpdate, UpdateActor for every actor to index, EndUpdate (removes the actors not updated)
+    void BeginUpdate();
+    void UpdateActor(uint32 Id, const FVector &Location, const FQuat &Rotation, const FVector &BoxOrigin,
+                     const FVector &BoxExtent);
+    void EndUpdate();
+    void Clear();
+
+    int32 Num() const
+    {
+        return Boxes.Num();
+    }
+
+    // first box entered by the segment from Start to End. The boxes that contain Start (e.g. the vehicle the gaze
+    // comes from) are skipped, as is the actor IgnoreId
+    bool Raycast(const FVector &Start, const FVector &End, Hit &Out, uint32 IgnoreId = ~0u) const;
+
+  private:
+    struct Box
+    {
+        uint32 Id;
+        // the inputs of UpdateActor, to tell whether it moved
+        FVector Location;
+        FQuat Rotation;
+        FVector BoxOrigin;
+        FVector BoxExtent;
+        // derived
+        FVector Center; // world space
+        FVector AABBMin, AABBMax;
+        bool bUpdated; // in this BeginUpdate/EndUpdate
+    };
+
+    struct alignas(16) Node
+    {
+        // bounds of the children in SoA layout, one lane per child
+        float MinX[4], MinY[4], MinZ[4];
+        float MaxX[4], MaxY[4], MaxZ[4];
+        int32 Child[4]; // >= 0: index of a node, < 0: ~index of a box
+        int32 NumChildren;
+    };
+
+    void ComputeBounds(Box &B) const;
+    void Build();
+    int32 BuildNode(int32 First, int32 Count);
+    void SetLane(Node &N, int32 Lane, int32 Child) const;
+    void GetChildBounds(int32 Child, FVector &Min, FVector &Max) const;
+    float Refit(); // returns the total surface area of the nodes
+    bool IntersectBox(const Box &B, const FVector &Start, const FVector &Dir, float &TMax, Hit &Out) const;
+
+    TArray<Box> Boxes;
+    TMap<uint32, int32> Slots; // actor id -> index in Boxes
+    TArray<Node, TAlignedHeapAllocator<16>> Nodes; // Nodes[0] is the root, children come after their parent
+    TArray<int32> BuildItems;                      // box indices being partitioned by Build
+    bool bNeedsBuild = false;
+    bool bNeedsRefit = false;
+    float BuiltArea = 0.f; // surface area of the nodes right after the last build
+};
+
+}; // namespace DReyeVR
@@ -8,18 +8,18 @@ namespace DReyeVR
 /// ----------------:EYEDATA:----------------- ///
 /// ========================================== ///
 
-void EyeData::Read(std::ifstream &InFile)
+void EyeData::Read(BinaryReader &In)
 {
-    ReadFVector(InFile, GazeDir);
-    ReadFVector(InFile, GazeOrigin);
-    ReadValue<bool>(InFile, GazeValid);
+    ReadFVector(In, GazeDir);
+    ReadFVector(In, GazeOrigin);
+    ReadValue<bool>(In, GazeValid);
 }
 
-void EyeData::Write(std::ofstream &OutFile) const
+void EyeData::Write(BinaryWriter &Out) const
 {
-    WriteFVector(OutFile, GazeDir);
-    WriteFVector(OutFile, GazeOrigin);
-    WriteValue<bool>(OutFile, GazeValid);
+    WriteFVector(Out, GazeDir);
+    WriteFVector(Out, GazeOrigin);
+    WriteValue<bool>(Out, GazeValid);
 }
 
 FString EyeData::ToString() const
@@ -35,16 +35,16 @@ FString EyeData::ToString() const
 /// ------------:COMBINEDEYEDATA:------------- ///
 /// ========================================== ///
 
-void CombinedEyeData::Read(std::ifstream &InFile)
+void CombinedEyeData::Read(BinaryReader &In)
 {
-    EyeData::Read(InFile);
-    ReadValue<float>(InFile, Vergence);
+    EyeData::Read(In);
+    ReadValue<float>(In, Vergence);
 }
 
-void CombinedEyeData::Write(std::ofstream &OutFile) const
+void CombinedEyeData::Write(BinaryWriter &Out) const
 {
-    EyeData::Write(OutFile);
-    WriteValue<float>(OutFile, Vergence);
+    EyeData::Write(Out);
+    WriteValue<float>(Out, Vergence);
 }
 
 FString CombinedEyeData::ToString() const
@@ -58,24 +58,24 @@ FString CombinedEyeData::ToString() const
 /// -------------:SINGLEEYEDATA:-------------- ///
 /// ========================================== ///
 
-void SingleEyeData::Read(std::ifstream &InFile)
+void SingleEyeData::Read(BinaryReader &In)
 {
-    EyeData::Read(InFile);
-    ReadValue<float>(InFile, EyeOpenness);
-    ReadValue<bool>(InFile, EyeOpennessValid);
-    ReadValue<float>(InFile, PupilDiameter);
-    ReadFVector2D(InFile, PupilPosition);
-    ReadValue<bool>(InFile, PupilPositionValid);
+    EyeData::Read(In);
+    ReadValue<float>(In, EyeOpenness);
+    ReadValue<bool>(In, EyeOpennessValid);
+    ReadValue<float>(In, PupilDiameter);
+    ReadFVector2D(In, PupilPosition);
+    ReadValue<bool>(In, PupilPositionValid);
 }
 
-void SingleEyeData::Write(std::ofstream &OutFile) const
+void SingleEyeData::Write(BinaryWriter &Out) const
 {
-    EyeData::Write(OutFile);
-    WriteValue<float>(OutFile, EyeOpenness);
-    WriteValue<bool>(OutFile, EyeOpennessValid);
-    WriteValue<float>(OutFile, PupilDiameter);
-    WriteFVector2D(OutFile, PupilPosition);
-    WriteValue<bool>(OutFile, PupilPositionValid);
+    EyeData::Write(Out);
+    WriteValue<float>(Out, EyeOpenness);
+    WriteValue<bool>(Out, EyeOpennessValid);
+    WriteValue<float>(Out, PupilDiameter);
+    WriteFVector2D(Out, PupilPosition);
+    WriteValue<bool>(Out, PupilPositionValid);
 }
 
 FString SingleEyeData::ToString() const
@@ -93,26 +93,26 @@ FString SingleEyeData::ToString() const
 /// --------------:EGOVARIABLES:-------------- ///
 /// ========================================== ///
 
-void EgoVariables::Read(std::ifstream &InFile)
+void EgoVariables::Read(BinaryReader &In)
 {
-    ReadFVector(InFile, CameraLocation);
-    ReadFRotator(InFile, CameraRotation);
-    ReadFVector(InFile, CameraLocationAbs);
-    ReadFRotator(InFile, CameraRotationAbs);
-    ReadFVector(InFile, VehicleLocation);
-    ReadFRotator(InFile, VehicleRotation);
-    ReadValue<float>(InFile, Velocity);
+    ReadFVector(In, CameraLocation);
+    ReadFRotator(In, CameraRotation);
+    ReadFVector(In, CameraLocationAbs);
+    ReadFRotator(In, CameraRotationAbs);
+    ReadFVector(In, VehicleLocation);
+    ReadFRotator(In, VehicleRotation);
+    ReadValue<float>(In, Velocity);
 }
 
-void EgoVariables::Write(std::ofstream &OutFile) const
+void EgoVariables::Write(BinaryWriter &Out) const
 {
-    WriteFVector(OutFile, CameraLocation);
-    WriteFRotator(OutFile, CameraRotation);
-    WriteFVector(OutFile, CameraLocationAbs);
-    WriteFRotator(OutFile, CameraRotationAbs);
-    WriteFVector(OutFile, VehicleLocation);
-    WriteFRotator(OutFile, VehicleRotation);
-    WriteValue<float>(OutFile, Velocity);
+    WriteFVector(Out, CameraLocation);
+    WriteFRotator(Out, CameraRotation);
+    WriteFVector(Out, CameraLocationAbs);
+    WriteFRotator(Out, CameraRotationAbs);
+    WriteFVector(Out, VehicleLocation);
+    WriteFRotator(Out, VehicleRotation);
+    WriteValue<float>(Out, Velocity);
 }
 
 FString EgoVariables::ToString() const
@@ -132,26 +132,26 @@ FString EgoVariables::ToString() const
 /// --------------:USERINPUTS:---------------- ///
 /// ========================================== ///
 
-void UserInputs::Read(std::ifstream &InFile)
+void UserInputs::Read(BinaryReader &In)
 {
-    ReadValue<float>(InFile, Throttle);
-    ReadValue<float>(InFile, Steering);
-    ReadValue<float>(InFile, Brake);
-    ReadValue<bool>(InFile, ToggledReverse);
-    ReadValue<bool>(InFile, TurnSignalLeft);
-    ReadValue<bool>(InFile, TurnSignalRight);
-    ReadValue<bool>(InFile, HoldHandbrake);
+    ReadValue<float>(In, Throttle);
+    ReadValue<float>(In, Steering);
+    ReadValue<float>(In, Brake);
+    ReadValue<bool>(In, ToggledReverse);
+    ReadValue<bool>(In, TurnSignalLeft);
+    ReadValue<bool>(In, TurnSignalRight);
+    ReadValue<bool>(In, HoldHandbrake);
 }
 
-void UserInputs::Write(std::ofstream &OutFile) const
+void UserInputs::Write(BinaryWriter &Out) const
 {
-    WriteValue<float>(OutFile, Throttle);
-    WriteValue<float>(OutFile, Steering);
-    WriteValue<float>(OutFile, Brake);
-    WriteValue<bool>(OutFile, ToggledReverse);
-    WriteValue<bool>(OutFile, TurnSignalLeft);
-    WriteValue<bool>(OutFile, TurnSignalRight);
-    WriteValue<bool>(OutFile, HoldHandbrake);
+    WriteValue<float>(Out, Throttle);
+    WriteValue<float>(Out, Steering);
+    WriteValue<float>(Out, Brake);
+    WriteValue<bool>(Out, ToggledReverse);
+    WriteValue<bool>(Out, TurnSignalLeft);
+    WriteValue<bool>(Out, TurnSignalRight);
+    WriteValue<bool>(Out, HoldHandbrake);
 }
 
 FString UserInputs::ToString() const
@@ -171,22 +171,22 @@ FString UserInputs::ToString() const
 /// ---------------:FOCUSINFO:---------------- ///
 /// ========================================== ///
 
-void FocusInfo::Read(std::ifstream &InFile)
+void FocusInfo::Read(BinaryReader &In)
 {
-    ReadFString(InFile, ActorNameTag);
-    ReadValue<bool>(InFile, bDidHit);
-    ReadFVector(InFile, HitPoint);
-    ReadFVector(InFile, Normal);
-    ReadValue<float>(InFile, Distance);
+    ReadFString(In, ActorNameTag);
+    ReadValue<bool>(In, bDidHit);
+    ReadFVector(In, HitPoint);
+    ReadFVector(In, Normal);
+    ReadValue<float>(In, Distance);
 }
 
-void FocusInfo::Write(std::ofstream &OutFile) const
+void FocusInfo::Write(BinaryWriter &Out) const
 {
-    WriteFString(OutFile, ActorNameTag);
-    WriteValue<bool>(OutFile, bDidHit);
-    WriteFVector(OutFile, HitPoint);
-    WriteFVector(OutFile, Normal);
-    WriteValue<float>(OutFile, Distance);
+    WriteFString(Out, ActorNameTag);
+    WriteValue<bool>(Out, bDidHit);
+    WriteFVector(Out, HitPoint);
+    WriteFVector(Out, Normal);
+    WriteValue<float>(Out, Distance);
 }
 
 FString FocusInfo::ToString() const
@@ -204,22 +204,22 @@ FString FocusInfo::ToString() const
 /// ---------------:EYETRACKER:--------------- ///
 /// ========================================== ///
 
-void EyeTracker::Read(std::ifstream &InFile)
+void EyeTracker::Read(BinaryReader &In)
 {
-    ReadValue<int64_t>(InFile, TimestampDevice);
-    ReadValue<int64_t>(InFile, FrameSequence);
-    Combined.Read(InFile);
-    Left.Read(InFile);
-    Right.Read(InFile);
+    ReadValue<int64_t>(In, TimestampDevice);
+    ReadValue<int64_t>(In, FrameSequence);
+    Combined.Read(In);
+    Left.Read(In);
+    Right.Read(In);
 }
 
-void EyeTracker::Write(std::ofstream &OutFile) const
+void EyeTracker::Write(BinaryWriter &Out) const
 {
-    WriteValue<int64_t>(OutFile, TimestampDevice);
-    WriteValue<int64_t>(OutFile, FrameSequence);
-    Combined.Write(OutFile);
-    Left.Write(OutFile);
-    Right.Write(OutFile);
+    WriteValue<int64_t>(Out, TimestampDevice);
+    WriteValue<int64_t>(Out, FrameSequence);
+    Combined.Write(Out);
+    Left.Write(Out);
+    Right.Write(Out);
 }
 
 FString EyeTracker::ToString() const
@@ -424,6 +424,21 @@ const DReyeVR::UserInputs &AggregateData::GetUserInputs() const
     return Inputs;
 }
 
+const std::vector<struct EyeTracker> &AggregateData::GetEyeSamples() const
+{
+    return EyeSamples;
+}
+
+const std::vector<struct ActorAttention> &AggregateData::GetAttention() const
+{
+    return Attention;
+}
+
+const std::vector<struct GazeEvent> &AggregateData::GetGazeEvents() const
+{
+    return GazeEvents;
+}
+
 void AggregateData::UpdateCamera(const FVector &NewCameraLoc, const FRotator &NewCameraRot)
 {
     EgoVars.CameraLocation = NewCameraLoc;
@@ -453,24 +468,44 @@ void AggregateData::Update(int64_t NewTimestamp, const struct EyeTracker &NewEye
     Inputs = NewInputs;
 }
 
-void AggregateData::Read(std::ifstream &InFile)
+void AggregateData::UpdateEyeTracker(const struct EyeTracker &NewEyeData)
+{
+    EyeTrackerData = NewEyeData;
+}
+
+void AggregateData::UpdateEyeSamples(std::vector<struct EyeTracker> &&NewEyeSamples)
+{
+    EyeSamples = std::move(NewEyeSamples);
+}
+
+void AggregateData::UpdateAttention(std::vector<struct ActorAttention> &&NewAttention)
+{
+    Attention = std::move(NewAttention);
+}
+
+void AggregateData::UpdateGazeEvents(std::vector<struct GazeEvent> &&NewGazeEvents)
+{
+    GazeEvents = std::move(NewGazeEvents);
+}
+
+void AggregateData::Read(BinaryReader &In)
 {
     /// CAUTION: make sure the order of writes/reads is the same
-    ReadValue<int64_t>(InFile, TimestampCarlaUE4);
-    EgoVars.Read(InFile);
-    EyeTrackerData.Read(InFile);
-    FocusData.Read(InFile);
-    Inputs.Read(InFile);
+    ReadValue<int64_t>(In, TimestampCarlaUE4);
+    EgoVars.Read(In);
+    EyeTrackerData.Read(In);
+    FocusData.Read(In);
+    Inputs.Read(In);
 }
 
-void AggregateData::Write(std::ofstream &OutFile) const
+void AggregateData::Write(BinaryWriter &Out) const
 {
     /// CAUTION: make sure the order of writes/reads is the same
-    WriteValue<int64_t>(OutFile, GetTimestampCarla());
-    EgoVars.Write(OutFile);
-    EyeTrackerData.Write(OutFile);
-    FocusData.Write(OutFile);
-    Inputs.Write(OutFile);
+    WriteValue<int64_t>(Out, GetTimestampCarla());
+    EgoVars.Write(Out);
+    EyeTrackerData.Write(Out);
+    FocusData.Write(Out);
+    Inputs.Write(Out);
 }
 
 FString AggregateData::ToString() const
@@ -525,28 +560,28 @@ void CustomActorData::MaterialParamsStruct::Apply(class UMaterialInstanceDynamic
     }
 }
 
-void CustomActorData::MaterialParamsStruct::Read(std::ifstream &InFile)
+void CustomActorData::MaterialParamsStruct::Read(BinaryReader &In)
 {
-    ReadValue<float>(InFile, Metallic);
-    ReadValue<float>(InFile, Specular);
-    ReadValue<float>(InFile, Roughness);
-    ReadValue<float>(InFile, Anisotropy);
-    ReadValue<float>(InFile, Opacity);
-    ReadFLinearColor(InFile, BaseColor);
-    ReadFLinearColor(InFile, Emissive);
-    ReadFString(InFile, MaterialPath);
+    ReadValue<float>(In, Metallic);
+    ReadValue<float>(In, Specular);
+    ReadValue<float>(In, Roughness);
+    ReadValue<float>(In, Anisotropy);
+    ReadValue<float>(In, Opacity);
+    ReadFLinearColor(In, BaseColor);
+    ReadFLinearColor(In, Emissive);
+    ReadFString(In, MaterialPath);
 }
 
-void CustomActorData::MaterialParamsStruct::Write(std::ofstream &OutFile) const
+void CustomActorData::MaterialParamsStruct::Write(BinaryWriter &Out) const
 {
-    WriteValue<float>(OutFile, Metallic);
-    WriteValue<float>(OutFile, Specular);
-    WriteValue<float>(OutFile, Roughness);
-    WriteValue<float>(OutFile, Anisotropy);
-    WriteValue<float>(OutFile, Opacity);
-    WriteFLinearColor(OutFile, BaseColor);
-    WriteFLinearColor(OutFile, Emissive);
-    WriteFString(OutFile, MaterialPath);
+    WriteValue<float>(Out, Metallic);
+    WriteValue<float>(Out, Specular);
+    WriteValue<float>(Out, Roughness);
+    WriteValue<float>(Out, Anisotropy);
+    WriteValue<float>(Out, Opacity);
+    WriteFLinearColor(Out, BaseColor);
+    WriteFLinearColor(Out, Emissive);
+    WriteFString(Out, MaterialPath);
 }
 
 FString PrintFLinearColor(const FLinearColor &F)
@@ -570,34 +605,34 @@ FString CustomActorData::MaterialParamsStruct::ToString() const
     return Print;
 }
 
-void CustomActorData::Read(std::ifstream &InFile)
+void CustomActorData::Read(BinaryReader &In)
 {
     // 9 dof
-    ReadFVector(InFile, Location);
-    ReadFRotator(InFile, Rotation);
-    ReadFVector(InFile, Scale3D);
+    ReadFVector(In, Location);
+    ReadFRotator(In, Rotation);
+    ReadFVector(In, Scale3D);
     // visual properties
-    ReadFString(InFile, MeshPath);
+    ReadFString(In, MeshPath);
     // material properties
-    MaterialParams.Read(InFile);
+    MaterialParams.Read(In);
     // other
-    ReadFString(InFile, Other);
-    ReadFString(InFile, Name);
+    ReadFString(In, Other);
+    ReadFString(In, Name);
 }
 
-void CustomActorData::Write(std::ofstream &OutFile) const
+void CustomActorData::Write(BinaryWriter &Out) const
 {
     // 9 dof
-    WriteFVector(OutFile, Location);
-    WriteFRotator(OutFile, Rotation);
-    WriteFVector(OutFile, Scale3D);
+    WriteFVector(Out, Location);
+    WriteFRotator(Out, Rotation);
+    WriteFVector(Out, Scale3D);
     // visual properties
-    WriteFString(OutFile, MeshPath);
+    WriteFString(Out, MeshPath);
     // material properties
-    MaterialParams.Write(OutFile);
+    MaterialParams.Write(Out);
     // other
-    WriteFString(OutFile, Other);
-    WriteFString(OutFile, Name);
+    WriteFString(Out, Other);
+    WriteFString(Out, Name);
 }
 
 FString CustomActorData::ToString() const
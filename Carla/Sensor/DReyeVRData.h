@@ -9,6 +9,7 @@
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace DReyeVR
 {
@@ -18,8 +19,8 @@ struct CARLA_API DataSerializer
     DataSerializer() = default;
     virtual ~DataSerializer() = default;
 
-    virtual void Read(std::ifstream &InFile) = 0;
-    virtual void Write(std::ofstream &OutFile) const = 0;
+    virtual void Read(BinaryReader &In) = 0;
+    virtual void Write(BinaryWriter &Out) const = 0;
     virtual FString ToString() const = 0;
 };
 
@@ -29,8 +30,8 @@ struct CARLA_API EyeData : public DataSerializer
     FVector GazeOrigin = FVector::ZeroVector;
     bool GazeValid = false;
 
-    void Read(std::ifstream &InFile) override;
-    void Write(std::ofstream &OutFile) const override;
+    void Read(BinaryReader &In) override;
+    void Write(BinaryWriter &Out) const override;
     FString ToString() const override;
 };
 
@@ -38,8 +39,8 @@ struct CARLA_API CombinedEyeData : EyeData
 {
     float Vergence = 0.f; // in cm (default UE4 units)
 
-    void Read(std::ifstream &InFile) override;
-    void Write(std::ofstream &OutFile) const override;
+    void Read(BinaryReader &In) override;
+    void Write(BinaryWriter &Out) const override;
     FString ToString() const override;
 };
 
@@ -51,8 +52,8 @@ struct CARLA_API SingleEyeData : EyeData
     FVector2D PupilPosition = FVector2D::ZeroVector;
     bool PupilPositionValid = false;
 
-    void Read(std::ifstream &InFile) override;
-    void Write(std::ofstream &OutFile) const override;
+    void Read(BinaryReader &In) override;
+    void Write(BinaryWriter &Out) const override;
     FString ToString() const override;
 };
 
@@ -70,8 +71,8 @@ struct CARLA_API EgoVariables : public DataSerializer
     // Ego variables
     float Velocity = 0.f; // note this is in cm/s (default UE4 units)
 
-    void Read(std::ifstream &InFile) override;
-    void Write(std::ofstream &OutFile) const override;
+    void Read(BinaryReader &In) override;
+    void Write(BinaryWriter &Out) const override;
     FString ToString() const override;
 };
 
@@ -87,8 +88,8 @@ struct CARLA_API UserInputs : public DataSerializer
     bool HoldHandbrake = false;
     // Add more inputs here!
 
-    void Read(std::ifstream &InFile) override;
-    void Write(std::ofstream &OutFile) const override;
+    void Read(BinaryReader &In) override;
+    void Write(BinaryWriter &Out) const override;
     FString ToString() const override;
 };
 
@@ -96,17 +97,47 @@ struct CARLA_API FocusInfo : public DataSerializer
 {
     // substitute for SRanipal FFocusInfo in SRanipal_Eyes_Enums.h
     TWeakObjectPtr<class AActor> Actor;
-    FVector HitPoint; // in world space (absolute location)
-    FVector Normal;
+    FVector HitPoint = FVector::ZeroVector; // in world space (absolute location)
+    FVector Normal = FVector::ZeroVector;
     FString ActorNameTag = "None"; // Tag of the actor being focused on
-    float Distance;
-    bool bDidHit;
+    float Distance = 0.f;
+    bool bDidHit = false;
+    // TimestampDevice of the eye tracker sample whose gaze was traced (the traces can lag a tick behind), not recorded
+    int64_t SampleTimestamp = 0;
 
-    void Read(std::ifstream &InFile) override;
-    void Write(std::ofstream &OutFile) const override;
+    void Read(BinaryReader &In) override;
+    void Write(BinaryWriter &Out) const override;
     FString ToString() const override;
 };
 
+// share of the foveal gaze cone that landed on an actor (see AEgoSensor::ComputeAttention)
+struct CARLA_API ActorAttention
+{
+    TWeakObjectPtr<class AActor> Actor; // not recorded
+    FString ActorNameTag;               // same naming as FocusInfo::ActorNameTag
+    float Weight = 0.f;                 // fraction of the cone's (foveally weighted) rays that hit the actor, in [0,1]
+};
+
+enum class GazeEventType : uint8_t
+{
+    None = 0,
+    FixationStart = 1, // once the fixation has lasted the minimum duration
+    FixationEnd = 2,
+    Saccade = 3, // the movement from a fixation to the next, reported when the next one starts
+};
+
+// fixation/saccade detected online on the eye tracker samples (see DReyeVR::FixationDetector)
+struct CARLA_API GazeEvent
+{
+    GazeEventType Type = GazeEventType::None;
+    int64_t TimestampDevice = 0;            // start of the fixation/saccade (eye tracker clock)
+    int64_t DetectedAt = 0;                 // TimestampDevice of the sample that completed the event
+    float DurationMs = 0.f;                 // so far for FixationStart
+    FVector Centroid = FVector::ZeroVector; // fixations: mean combined gaze direction (same space as GazeDir)
+    float Amplitude = 0.f;                  // fixations: dispersion, saccades: angle between the fixations (deg)
+    float PeakVelocity = 0.f;               // saccades: peak angular velocity of the gaze (deg/s)
+};
+
 struct CARLA_API EyeTracker : public DataSerializer
 {
     int64_t TimestampDevice = 0; // timestamp from the eye tracker device (with its own clock)
@@ -115,8 +146,8 @@ struct CARLA_API EyeTracker : public DataSerializer
     SingleEyeData Left;
     SingleEyeData Right;
 
-    void Read(std::ifstream &InFile) override;
-    void Write(std::ofstream &OutFile) const override;
+    void Read(BinaryReader &In) override;
+    void Write(BinaryWriter &Out) const override;
     FString ToString() const override;
 };
 
@@ -169,21 +200,37 @@ class CARLA_API AggregateData : public DataSerializer
     float GetFocusActorDistance() const;
     const DReyeVR::UserInputs &GetUserInputs() const;
 
+    // every eye tracker sample taken since the previous tick (oldest first, the latest is also the current data)
+    const std::vector<struct EyeTracker> &GetEyeSamples() const;
+
+    // attention weight of every actor in the gaze cone (largest first, empty if the cone sampling is disabled)
+    const std::vector<struct ActorAttention> &GetAttention() const;
+
+    // fixations/saccades detected in the eye samples since the previous tick (oldest first)
+    const std::vector<struct GazeEvent> &GetGazeEvents() const;
+
     ////////////////////:SETTERS://////////////////////
     void UpdateCamera(const FVector &NewCameraLoc, const FRotator &NewCameraRot);
     void UpdateCameraAbs(const FVector &NewCameraLocAbs, const FRotator &NewCameraRotAbs);
     void UpdateVehicle(const FVector &NewVehicleLoc, const FRotator &NewVehicleRot);
     void Update(int64_t NewTimestamp, const struct EyeTracker &NewEyeData, const struct EgoVariables &NewEgoVars,
                 const struct FocusInfo &NewFocus, const struct UserInputs &NewInputs);
+    void UpdateEyeTracker(const struct EyeTracker &NewEyeData);
+    void UpdateEyeSamples(std::vector<struct EyeTracker> &&NewEyeSamples);
+    void UpdateAttention(std::vector<struct ActorAttention> &&NewAttention);
+    void UpdateGazeEvents(std::vector<struct GazeEvent> &&NewGazeEvents);
 
     ////////////////////:SERIALIZATION://////////////////////
-    void Read(std::ifstream &InFile) override;
-    void Write(std::ofstream &OutFile) const override;
+    void Read(BinaryReader &In) override;
+    void Write(BinaryWriter &Out) const override;
     FString ToString() const override;
 
   private:
     int64_t TimestampCarlaUE4; // Carla Timestamp (EgoSensor Tick() event) in milliseconds
     struct EyeTracker EyeTrackerData;
+    std::vector<struct EyeTracker> EyeSamples; // all samples since the last tick (when sampling asynchronously)
+    std::vector<struct ActorAttention> Attention; // recorded in its own packet, like the eye samples
+    std::vector<struct GazeEvent> GazeEvents;     // recorded in its own packet too
     struct EgoVariables EgoVars;
     struct FocusInfo FocusData;
     struct UserInputs Inputs;
@@ -215,8 +262,8 @@ class CARLA_API CustomActorData : public DataSerializer
         FString MaterialPath;
         void Apply(class UMaterialInstanceDynamic *Material) const;
 
-        void Read(std::ifstream &InFile) override;
-        void Write(std::ofstream &OutFile) const override;
+        void Read(BinaryReader &In) override;
+        void Write(BinaryWriter &Out) const override;
         FString ToString() const override;
     };
     MaterialParamsStruct MaterialParams;
@@ -225,8 +272,8 @@ class CARLA_API CustomActorData : public DataSerializer
 
     CustomActorData() = default;
 
-    void Read(std::ifstream &InFile) override;
-    void Write(std::ofstream &OutFile) const override;
+    void Read(BinaryReader &In) override;
+    void Write(BinaryWriter &Out) const override;
     FString ToString() const override;
     std::string GetUniqueName() const;
 };
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>  // std::atomic
+#include <cstddef> // size_t
+
+namespace DReyeVR
+{
+
+// Bounded lock-free ring buffer for exactly one producer thread and one consumer thread.
+// Push never blocks (returns false when full) so a fast producer (ex. the eye tracker sampler) can never stall on a
+// slow consumer (ex. the game thread), and Pop never blocks either.
+template <typename T, size_t N> class SPSCRing
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SPSCRing capacity must be a power of two");
+
+  public:
+    // producer thread only
+    bool Push(const T &Item)
+    {
+        const size_t H = Head.load(std::memory_order_relaxed);
+        if (H - Tail.load(std::memory_order_acquire) >= N)
+            return false; // full
+        Items[H & (N - 1)] = Item;
+        Head.store(H + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer thread only
+    bool Pop(T &Out)
+    {
+        const size_t Rd = Tail.load(std::memory_order_relaxed);
+        if (Rd == Head.load(std::memory_order_acquire))
+            return false; // empty
+        Out = Items[Rd & (N - 1)];
+        Tail.store(Rd + 1, std::memory_order_release);
+        return true;
+    }
+
+    // approximate when called concurrently with Push/Pop
+    size_t Num() const
+    {
+        return Head.load(std::memory_order_acquire) - Tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t Capacity()
+    {
+        return N;
+    }
+
+  private:
+    T Items[N];
+    std::atomic<size_t> Head{0}; // next slot to fill (producer)
+    std::atomic<size_t> Tail{0}; // next slot to read (consumer)
+};
+
+}; // namespace DReyeVR
@@ -12,14 +12,12 @@
 #include "carla/geom/Vector3D.h"
 #include "carla/sensor/s11n/DReyeVRSerializer.h" // DReyeVRSerializer::Data
 
-class DReyeVR::AggregateData *ADReyeVRSensor::Data = nullptr;
 bool ADReyeVRSensor::bIsReplaying = false; // initially not replaying
 
 ADReyeVRSensor::ADReyeVRSensor(const FObjectInitializer &ObjectInitializer) : Super(ObjectInitializer)
 {
     // no need for any other initialization
     PrimaryActorTick.bCanEverTick = true;
-    ADReyeVRSensor::Data = new DReyeVR::AggregateData();
 }
 
 FActorDefinition ADReyeVRSensor::GetSensorDefinition()
@@ -30,8 +28,36 @@ FActorDefinition ADReyeVRSensor::GetSensorDefinition()
     /// NOTE: only has EActorAttributeType for bool, int, float, string, and RGBColor
     // see /Plugins/Carla/Source/Carla/Actor/ActorAttribute.h for the whole list
 
+    // number of ticks to batch into one stream message
+    FActorVariation BatchTicks;
+    BatchTicks.Id = TEXT("stream_batch_ticks");
+    BatchTicks.Type = EActorAttributeType::Int;
+    BatchTicks.RecommendedValues = {TEXT("1")};
+    BatchTicks.bRestrictToRecommended = false;
+
+    // milliseconds to batch into one stream message (overrides stream_batch_ticks if positive)
+    FActorVariation BatchMs;
+    BatchMs.Id = TEXT("stream_batch_ms");
+    BatchMs.Type = EActorAttributeType::Float;
+    BatchMs.RecommendedValues = {TEXT("0.0")};
+    BatchMs.bRestrictToRecommended = false;
+
+    // field groups to stream (comma separated, see DReyeVRSerializer::ParseFieldMask)
+    FActorVariation Fields;
+    Fields.Id = TEXT("stream_fields");
+    Fields.Type = EActorAttributeType::String;
+    Fields.RecommendedValues = {TEXT("all")};
+    Fields.bRestrictToRecommended = false;
+
+    // name of the shared memory to also publish the stream messages to (empty for none)
+    FActorVariation Shm;
+    Shm.Id = TEXT("shared_memory_name");
+    Shm.Type = EActorAttributeType::String;
+    Shm.RecommendedValues = {TEXT("")};
+    Shm.bRestrictToRecommended = false;
+
     // append all Variable variations to the definition
-    // Definition.Variations.Append();
+    Definition.Variations.Append({BatchTicks, BatchMs, Fields, Shm});
 
     return Definition;
 }
@@ -39,6 +65,24 @@ FActorDefinition ADReyeVRSensor::GetSensorDefinition()
 void ADReyeVRSensor::Set(const FActorDescription &Description)
 {
     Super::Set(Description);
+    StreamBatchTicks = FMath::Max(1, UActorBlueprintFunctionLibrary::RetrieveActorAttributeToInt(
+                                         "stream_batch_ticks", Description.Variations, StreamBatchTicks));
+    StreamBatchMs = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToFloat("stream_batch_ms",
+                                                                                  Description.Variations, StreamBatchMs);
+    SetStreamFields(
+        UActorBlueprintFunctionLibrary::RetrieveActorAttributeToString("stream_fields", Description.Variations, "all"));
+    SharedMemoryName = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToString(
+        "shared_memory_name", Description.Variations, SharedMemoryName);
+}
+
+void ADReyeVRSensor::SetStreamFields(const FString &Fields)
+{
+    StreamFieldMask = carla::sensor::s11n::DReyeVRSerializer::ParseFieldMask(carla::rpc::FromFString(Fields));
+    // the batch in progress was filled with the previous mask
+    StreamBatch.clear();
+    StreamBatchNames.clear();
+    StreamBatchAttentionNames.clear();
+    StreamBatchNumTicks = 0;
 }
 
 void ADReyeVRSensor::SetOwner(AActor *Owner)
@@ -57,13 +101,43 @@ void ADReyeVRSensor::BeginPlay()
     Super::BeginPlay();
     World = GetWorld();
 
-    // assign statics
-    ADReyeVRSensor::sWorld = World;
-    ADReyeVRSensor::DReyeVRSensorPtr = this;
+    // assign statics (the first sensor stays the main one)
+    if (ADReyeVRSensor::sWorld != World || ADReyeVRSensor::DReyeVRSensorPtr == nullptr)
+    {
+        ADReyeVRSensor::sWorld = World;
+        ADReyeVRSensor::DReyeVRSensorPtr = this;
+    }
 
     UCarlaGameInstance *CarlaGame = UCarlaStatics::GetGameInstance(World);
     SetEpisode(*(CarlaGame->GetCarlaEpisode()));
     SetDataStream(CarlaGame->GetServer().OpenStream()); // initialize boost::optional<Stream>
+    OpenSharedMemory();
+}
+
+void ADReyeVRSensor::OpenSharedMemory()
+{
+    SharedMemory.reset();
+    if (SharedMemoryName.IsEmpty())
+        return;
+    SharedMemory = std::make_unique<carla::sensor::DReyeVRSharedMemoryWriter>(
+        carla::rpc::FromFString(SharedMemoryName), static_cast<uint32_t>(FMath::Max(1, SharedMemorySlots)),
+        static_cast<uint32_t>(FMath::Max(1, SharedMemorySlotSize)));
+    if (!SharedMemory->IsOpen())
+    {
+        DReyeVR_LOG_ERROR("Unable to create the shared memory \"%s\"", *SharedMemoryName);
+        SharedMemory.reset();
+        return;
+    }
+    DReyeVR_LOG("Publishing the sensor data to the shared memory \"%s\"", *SharedMemoryName);
+}
+
+void ADReyeVRSensor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    // look for another sensor next time
+    if (ADReyeVRSensor::DReyeVRSensorPtr == this)
+        ADReyeVRSensor::DReyeVRSensorPtr = nullptr;
+    SharedMemory.reset(); // removes the segment
+    Super::EndPlay(EndPlayReason);
 }
 
 void ADReyeVRSensor::BeginDestroy()
@@ -74,9 +148,9 @@ void ADReyeVRSensor::BeginDestroy()
 void ADReyeVRSensor::PostPhysTick(UWorld *W, ELevelTick TickType, float DeltaSeconds)
 {
     /// NOTE: this function defines the routine for streaming data to the PythonAPI
-    if (!this->bStreamData) // param for enabling or disabling the data streaming
+    // param for enabling or disabling the data streaming (and the local shared-memory transport)
+    if (!this->bStreamData && SharedMemory == nullptr)
         return;
-    auto Stream = GetDataStream(*this);
 
     struct // overloaded lambdas to convert UE4 types to carla::geom types
     {
@@ -98,96 +172,173 @@ void ADReyeVRSensor::PostPhysTick(UWorld *W, ELevelTick TickType, float DeltaSec
         };
     } ToGeom;
 
-    /// TODO: refactor this somehow
-    /// to see where this is sent, see LibCarla/source/carla/sensor/s11n/DReyeVRSerializer.h
-    Stream.Send(*this,
-                carla::sensor::s11n::DReyeVRSerializer::Data{
-                    Data->GetTimestampCarla(),  // Timestamp of Carla (ms)
-                    Data->GetTimestampDevice(), // Timestamp of SRanipal (ms)
-                    Data->GetFrameSequence(),   // Frame sequence
-                    // camera
-                    ToGeom(Data->GetCameraLocation()), // HMD absolute location
-                    ToGeom(Data->GetCameraRotation()), // HMD absolute rotation
-                    // combined gaze
-                    ToGeom(Data->GetGazeDir()),    // Combined gaze ray direction
-                    ToGeom(Data->GetGazeOrigin()), // Stream EyeOrigin Vec3
-                    Data->GetGazeValidity(),       // Validity of combined gaze
-                    Data->GetGazeVergence(),       // Vergence (float) of combined ray
-                    // left gaze/eye
-                    ToGeom(Data->GetGazeDir(DReyeVR::Gaze::LEFT)),      // Left eye gaze ray direction
-                    ToGeom(Data->GetGazeOrigin(DReyeVR::Gaze::LEFT)),   // Left eye gaze origin
-                    Data->GetGazeValidity(DReyeVR::Gaze::LEFT),         // Validity of left gaze
-                    Data->GetEyeOpenness(DReyeVR::Eye::LEFT),           // Left eye openness
-                    Data->GetEyeOpennessValidity(DReyeVR::Eye::LEFT),   // Validity of left eye openness
-                    ToGeom(Data->GetPupilPosition(DReyeVR::Eye::LEFT)), // Left pupil position
-                    Data->GetPupilPositionValidity(DReyeVR::Eye::LEFT), // Validity of left eye posn
-                    Data->GetPupilDiameter(DReyeVR::Eye::LEFT),         // Left eye diameter (mm)
-                    // right gaze/eye
-                    ToGeom(Data->GetGazeDir(DReyeVR::Gaze::RIGHT)),      // Right eye gaze ray direction
-                    ToGeom(Data->GetGazeOrigin(DReyeVR::Gaze::RIGHT)),   // Dight eye gaze origin
-                    Data->GetGazeValidity(DReyeVR::Gaze::RIGHT),         // Validity of right gaze
-                    Data->GetEyeOpenness(DReyeVR::Eye::RIGHT),           // Right eye openness
-                    Data->GetEyeOpennessValidity(DReyeVR::Eye::RIGHT),   // Validity of right eye openness
-                    ToGeom(Data->GetPupilPosition(DReyeVR::Eye::RIGHT)), // Right pupil position
-                    Data->GetPupilPositionValidity(DReyeVR::Eye::RIGHT), // Validity of left eye posn
-                    Data->GetPupilDiameter(DReyeVR::Eye::RIGHT),         // Right eye diameter (mm)
-                    // focus
-                    ToGeom(Data->GetFocusActorName()),  // Focus Actor's name
-                    ToGeom(Data->GetFocusActorPoint()), // Focus Actor's location in world space
-                    Data->GetFocusActorDistance(),      // Focus Actor's distance to the sensor
-                    // user inputs
-                    Data->GetUserInputs().Throttle,       // Vehicle input throttle
-                    Data->GetUserInputs().Steering,       // Vehicle input steering
-                    Data->GetUserInputs().Brake,          // Vehicle input brake
-                    Data->GetUserInputs().ToggledReverse, // Vehicle input gear (reverse, fwd)
-                    Data->GetUserInputs().HoldHandbrake   // Vehicle input handbrake
-                });
+    using Serializer = carla::sensor::s11n::DReyeVRSerializer;
+    auto SendData = [&](const DReyeVR::AggregateData &D, bool bAllGazeEvents) {
+        /// to see how this is sent/received, see LibCarla/source/carla/sensor/s11n/DReyeVRSerializer.h
+        /// NOTE: only the groups of StreamFieldMask are filled (and sent), the FocusActorName and attention ActorName ids
+        /// are filled in by the serializer
+        Serializer::Data Msg{};
+        Msg.Timestamps.TimestampCarla = D.GetTimestampCarla();   // Timestamp of Carla (ms)
+        Msg.Timestamps.TimestampDevice = D.GetTimestampDevice(); // Timestamp of SRanipal (ms)
+        Msg.Timestamps.FrameSequence = D.GetFrameSequence();     // Frame sequence
+        if (StreamFieldMask & Serializer::Camera)
+        {
+            Msg.Camera.CameraLocation = ToGeom(D.GetCameraLocation()); // HMD absolute location
+            Msg.Camera.CameraRotation = ToGeom(D.GetCameraRotation()); // HMD absolute rotation
+        }
+        if (StreamFieldMask & Serializer::Gaze)
+        {
+            Msg.Gaze.GazeDir = ToGeom(D.GetGazeDir());       // Combined gaze ray direction
+            Msg.Gaze.GazeOrigin = ToGeom(D.GetGazeOrigin()); // Stream EyeOrigin Vec3
+            Msg.Gaze.GazeValid = D.GetGazeValidity();        // Validity of combined gaze
+            Msg.Gaze.GazeVergence = D.GetGazeVergence();     // Vergence (float) of combined ray
+        }
+        auto FillEye = [&](Serializer::EyeData &Out, DReyeVR::Gaze WhichGaze, DReyeVR::Eye WhichEye) {
+            Out.GazeDir = ToGeom(D.GetGazeDir(WhichGaze));                 // Eye gaze ray direction
+            Out.GazeOrigin = ToGeom(D.GetGazeOrigin(WhichGaze));           // Eye gaze origin
+            Out.GazeValid = D.GetGazeValidity(WhichGaze);                  // Validity of eye gaze
+            Out.EyeOpenness = D.GetEyeOpenness(WhichEye);                  // Eye openness
+            Out.EyeOpenValid = D.GetEyeOpennessValidity(WhichEye);         // Validity of eye openness
+            Out.PupilPos = ToGeom(D.GetPupilPosition(WhichEye));           // Pupil position
+            Out.PupilPosValid = D.GetPupilPositionValidity(WhichEye);      // Validity of pupil posn
+            Out.PupilDiameter = D.GetPupilDiameter(WhichEye);              // Pupil diameter (mm)
+        };
+        if (StreamFieldMask & Serializer::LeftEye)
+            FillEye(Msg.LEye, DReyeVR::Gaze::LEFT, DReyeVR::Eye::LEFT);
+        if (StreamFieldMask & Serializer::RightEye)
+            FillEye(Msg.REye, DReyeVR::Gaze::RIGHT, DReyeVR::Eye::RIGHT);
+        if (StreamFieldMask & Serializer::Focus)
+        {
+            Msg.Focus.FocusActorPoint = ToGeom(D.GetFocusActorPoint()); // Focus Actor's location in world space
+            Msg.Focus.FocusActorDist = D.GetFocusActorDistance();      // Focus Actor's distance to the sensor
+        }
+        if (StreamFieldMask & Serializer::Inputs)
+        {
+            Msg.Inputs.Throttle = D.GetUserInputs().Throttle;             // Vehicle input throttle
+            Msg.Inputs.Steering = D.GetUserInputs().Steering;             // Vehicle input steering
+            Msg.Inputs.Brake = D.GetUserInputs().Brake;                   // Vehicle input brake
+            Msg.Inputs.ToggledReverse = D.GetUserInputs().ToggledReverse; // Vehicle input gear (reverse, fwd)
+            Msg.Inputs.HoldHandbrake = D.GetUserInputs().HoldHandbrake;   // Vehicle input handbrake
+        }
+        if (StreamFieldMask & Serializer::Attention)
+        {
+            // the actors with the largest attention weights of the gaze cone (their names are interned too)
+            const auto &Attention = D.GetAttention();
+            for (size_t i = 0; i < Serializer::MaxAttentionActors; i++)
+            {
+                const bool bUsed = i < Attention.size();
+                Msg.Attention.Weight[i] = bUsed ? Attention[i].Weight : 0.f;
+                StreamBatchAttentionNames.push_back(bUsed ? ToGeom(Attention[i].ActorNameTag) : "");
+            }
+        }
+        if (StreamFieldMask & Serializer::GazeEvents)
+        {
+            // the fixations/saccades completed by this eye sample (or all of them if it is the only one of the tick)
+            size_t Num = 0;
+            for (const DReyeVR::GazeEvent &E : D.GetGazeEvents())
+            {
+                if (Num == Serializer::MaxGazeEvents)
+                    break;
+                if (!bAllGazeEvents && E.DetectedAt != D.GetTimestampDevice())
+                    continue;
+                Msg.GazeEvents.Type[Num] = static_cast<uint8_t>(E.Type);
+                Msg.GazeEvents.TimestampDevice[Num] = E.TimestampDevice;
+                Msg.GazeEvents.DurationMs[Num] = E.DurationMs;
+                Msg.GazeEvents.Centroid[Num] = ToGeom(E.Centroid);
+                Msg.GazeEvents.Amplitude[Num] = E.Amplitude;
+                Msg.GazeEvents.PeakVelocity[Num] = E.PeakVelocity;
+                Num++;
+            }
+        }
+        StreamBatch.push_back(Msg);
+        // Focus Actor's name (interned by the serializer)
+        StreamBatchNames.push_back((StreamFieldMask & Serializer::Focus) ? ToGeom(D.GetFocusActorName()) : "");
+    };
+
+    const DReyeVR::AggregateData &Snapshot = Data.Latest();
+    const auto &EyeSamples = Snapshot.GetEyeSamples();
+    if (EyeSamples.size() <= 1)
+    {
+        SendData(Snapshot, true);
+    }
+    else
+    {
+        // the eye tracker is sampled faster than the game ticks, so send every sample that was taken since the
+        // last tick (each one along with the ego/focus/input data of this tick)
+        DReyeVR::AggregateData Sample = Snapshot;
+        for (const auto &EyeSample : EyeSamples)
+        {
+            Sample.UpdateEyeTracker(EyeSample);
+            SendData(Sample, false);
+        }
+    }
+
+    // send the batch as one message once it holds enough ticks (or enough time) worth of samples
+    const double Now = FPlatformTime::Seconds();
+    if (StreamBatchNumTicks++ == 0)
+        StreamBatchStartS = Now;
+    const bool bBatchFull = (StreamBatchMs > 0.f) ? (1000.0 * (Now - StreamBatchStartS) >= StreamBatchMs)
+                                                  : (StreamBatchNumTicks >= StreamBatchTicks);
+    if (bBatchFull)
+    {
+        /// to see where this is sent, see LibCarla/source/carla/sensor/s11n/DReyeVRSerializer.h
+        carla::Buffer Message = Serializer::Serialize(StreamStrings, StreamBatch, StreamBatchNames, StreamFieldMask,
+                                                      StreamBatchAttentionNames);
+        if (SharedMemory != nullptr)
+            SharedMemory->Publish(Message.data(), Message.size());
+        if (bStreamData)
+            GetDataStream(*this).Send(*this, std::move(Message));
+        StreamBatch.clear(); // keeps the capacity for the next batch
+        StreamBatchNames.clear();
+        StreamBatchAttentionNames.clear();
+        StreamBatchNumTicks = 0;
+    }
 }
 
 void ADReyeVRSensor::UpdateData(const DReyeVR::AggregateData &RecorderData, const double Per)
 {
     // update global values
     ADReyeVRSensor::bIsReplaying = true; // Replay has started
-    if (ADReyeVRSensor::Data != nullptr)
+    // the replayer publishes the snapshot at the end of its tick (along with the eye samples)
+    const DReyeVR::AggregateData &Old = Data.Latest();
+    DReyeVR::AggregateData &New = Data.Next();
+    // update local values but first interpolate camera and vehicle pose (Location & Rotation)
+    if (Per != 0.0)
     {
-        // update local values but first interpolate camera and vehicle pose (Location & Rotation)
-        if (Per != 0.0)
-        {
-            // interp Camera
-            FVector NewCameraLoc;
-            FRotator NewCameraRot;
-            InterpPositionAndRotation(ADReyeVRSensor::Data->GetCameraLocation(), // old location
-                                      ADReyeVRSensor::Data->GetCameraRotation(), // old rotation
-                                      RecorderData.GetCameraLocation(),          // new location
-                                      RecorderData.GetCameraRotation(),          // new rotation
-                                      Per, NewCameraLoc, NewCameraRot);
-            // interp Camera (absolute)
-            FVector NewCameraLocAbs;
-            FRotator NewCameraRotAbs;
-            InterpPositionAndRotation(ADReyeVRSensor::Data->GetCameraLocationAbs(), // old location
-                                      ADReyeVRSensor::Data->GetCameraRotationAbs(), // old rotation
-                                      RecorderData.GetCameraLocationAbs(),          // new location
-                                      RecorderData.GetCameraRotationAbs(),          // new rotation
-                                      Per, NewCameraLocAbs, NewCameraRotAbs);
-            // interp vehicle
-            FVector NewVehicleLoc;
-            FRotator NewVehicleRot;
-            InterpPositionAndRotation(ADReyeVRSensor::Data->GetVehicleLocation(), // old location
-                                      ADReyeVRSensor::Data->GetVehicleRotation(), // old rotation
-                                      RecorderData.GetVehicleLocation(),          // new location
-                                      RecorderData.GetVehicleRotation(),          // new rotation
-                                      Per, NewVehicleLoc, NewVehicleRot);
-            (*ADReyeVRSensor::Data) = RecorderData;
-            // update camera positions to the interpolated ones
-            ADReyeVRSensor::Data->UpdateCamera(NewCameraLoc, NewCameraRot);
-            ADReyeVRSensor::Data->UpdateCameraAbs(NewCameraLocAbs, NewCameraRotAbs);
-            ADReyeVRSensor::Data->UpdateVehicle(NewVehicleLoc, NewVehicleRot);
-        }
-        else
-        {
-            // assign updated DReyeVR data without interpolation
-            (*ADReyeVRSensor::Data) = RecorderData;
-        }
+        // interp Camera
+        FVector NewCameraLoc;
+        FRotator NewCameraRot;
+        InterpPositionAndRotation(Old.GetCameraLocation(),          // old location
+                                  Old.GetCameraRotation(),          // old rotation
+                                  RecorderData.GetCameraLocation(), // new location
+                                  RecorderData.GetCameraRotation(), // new rotation
+                                  Per, NewCameraLoc, NewCameraRot);
+        // interp Camera (absolute)
+        FVector NewCameraLocAbs;
+        FRotator NewCameraRotAbs;
+        InterpPositionAndRotation(Old.GetCameraLocationAbs(),          // old location
+                                  Old.GetCameraRotationAbs(),          // old rotation
+                                  RecorderData.GetCameraLocationAbs(), // new location
+                                  RecorderData.GetCameraRotationAbs(), // new rotation
+                                  Per, NewCameraLocAbs, NewCameraRotAbs);
+        // interp vehicle
+        FVector NewVehicleLoc;
+        FRotator NewVehicleRot;
+        InterpPositionAndRotation(Old.GetVehicleLocation(),          // old location
+                                  Old.GetVehicleRotation(),          // old rotation
+                                  RecorderData.GetVehicleLocation(), // new location
+                                  RecorderData.GetVehicleRotation(), // new rotation
+                                  Per, NewVehicleLoc, NewVehicleRot);
+        New = RecorderData;
+        // update camera positions to the interpolated ones
+        New.UpdateCamera(NewCameraLoc, NewCameraRot);
+        New.UpdateCameraAbs(NewCameraLocAbs, NewCameraRotAbs);
+        New.UpdateVehicle(NewVehicleLoc, NewVehicleRot);
+    }
+    else
+    {
+        // assign updated DReyeVR data without interpolation
+        New = RecorderData;
     }
 }
 
@@ -241,20 +392,10 @@ class ADReyeVRSensor *ADReyeVRSensor::GetDReyeVRSensor(class UWorld *World) // s
     if (ADReyeVRSensor::DReyeVRSensorPtr == nullptr) // if need to look for DReyeVR sensor in world
     {
         // need to find the DReyeVR sensor
-        TArray<AActor *> FoundActors;
-        if (ADReyeVRSensor::sWorld != nullptr)
-        {
-            UGameplayStatics::GetAllActorsOfClass(ADReyeVRSensor::sWorld, ADReyeVRSensor::StaticClass(), FoundActors);
-        }
-        if (FoundActors.Num() > 0)
-        {
-            /// TODO: check if multiple DReyeVRSensors exist in the world
-            ADReyeVRSensor::DReyeVRSensorPtr = CastChecked<ADReyeVRSensor>(FoundActors[0]);
-            ensure(ADReyeVRSensor::DReyeVRSensorPtr != nullptr);
-        }
-        if (FoundActors.Num() > 1)
+        const TArray<ADReyeVRSensor *> Sensors = GetDReyeVRSensors(ADReyeVRSensor::sWorld);
+        if (Sensors.Num() > 0)
         {
-            DReyeVR_LOG_ERROR("Multiple DReyeVR sensors active in the world! Not supported.");
+            ADReyeVRSensor::DReyeVRSensorPtr = Sensors[0];
         }
     }
 
@@ -266,3 +407,18 @@ class ADReyeVRSensor *ADReyeVRSensor::GetDReyeVRSensor(class UWorld *World) // s
 
     return DReyeVRSensorPtr;
 }
+
+TArray<class ADReyeVRSensor *> ADReyeVRSensor::GetDReyeVRSensors(class UWorld *World)
+{
+    TArray<ADReyeVRSensor *> Sensors;
+    TArray<AActor *> FoundActors;
+    if (World != nullptr)
+    {
+        UGameplayStatics::GetAllActorsOfClass(World, ADReyeVRSensor::StaticClass(), FoundActors);
+    }
+    for (AActor *Actor : FoundActors)
+    {
+        Sensors.Add(CastChecked<ADReyeVRSensor>(Actor));
+    }
+    return Sensors;
+}
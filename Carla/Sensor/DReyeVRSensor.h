@@ -5,10 +5,17 @@
 #include "Carla/Game/CarlaEpisode.h"      // UCarlaEpisode
 #include "Carla/Sensor/Sensor.h"          // ASensor
 #include "DReyeVRData.h"                  // AggregateData, CustomActorData
+#include "DReyeVRSnapshotChannel.h"       // SnapshotChannel
 #include <cstdint>                        // int64_t
+#include <memory>                         // std::unique_ptr
 #include <string>
 #include <vector>
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/DReyeVRSharedMemory.h>     // DReyeVRSharedMemoryWriter
+#include <carla/sensor/s11n/DReyeVRSerializer.h> // DReyeVRSerializer::Data
+#include <compiler/enable-ue4-macros.h>
+
 #include "DReyeVRSensor.generated.h"
 
 class UCarlaEpisode;
@@ -29,45 +36,84 @@ class CARLA_API ADReyeVRSensor : public ASensor
 
     virtual void PostPhysTick(UWorld *W, ELevelTick TickType, float DeltaSeconds) override;
 
-    // everything stored in the sensor is held in this struct
-    /// TODO: make this non-static and use a smarter scheme for cross-class communication
-    static class DReyeVR::AggregateData *Data;
-
-    class DReyeVR::AggregateData *GetData()
+    // latest snapshot of everything stored in the sensor (immutable, see DReyeVRSnapshotChannel.h)
+    const class DReyeVR::AggregateData *GetData() const
     {
-        return ADReyeVRSensor::Data;
+        return &Data.Latest();
     }
 
-    const class DReyeVR::AggregateData *GetData() const
+    // producers (the sensor tick or the replayer) write the next snapshot here and then publish it
+    class DReyeVR::AggregateData &GetNextData()
+    {
+        return Data.Next();
+    }
+    void PublishData()
     {
-        // read-only variant of GetData
-        return const_cast<const class DReyeVR::AggregateData *>(ADReyeVRSensor::Data);
+        Data.Publish();
     }
 
+    // field groups to stream to the PythonAPI, e.g. "gaze,timestamps" (see DReyeVRSerializer::ParseFieldMask)
+    void SetStreamFields(const FString &Fields);
+
     bool IsReplaying() const;
     virtual void UpdateData(const class DReyeVR::AggregateData &RecorderData, const double Per); // starts replaying
     virtual void UpdateData(const class DReyeVR::CustomActorData &RecorderData, const double Per);
     void StopReplaying();
-    virtual void TakeScreenshot()
+    // called when a synchronized replay of RecordingFile starts at frame FirstFrameIdx, returns the frame to start from
+    // instead (e.g. to resume an interrupted frame capture)
+    virtual size_t BeginFrameCapture(const std::string &RecordingFile, size_t FirstFrameIdx)
+    {
+        return FirstFrameIdx;
+    }
+    // RecorderFrameId: id of the replayed frame (to match the captures with the recording)
+    // FrameIdx: index of the replayed frame in the recording (numbers the captures, also across replay shards)
+    virtual void TakeScreenshot(uint64_t RecorderFrameId, size_t FrameIdx)
     {
         /// TODO: make this a pure virtual function (abstract class)
         DReyeVR_LOG_WARN("Not implemented! Implement in EgoSensor!");
     };
 
+    // the first DReyeVR sensor in the world (the one that is recorded & replayed)
     static class ADReyeVRSensor *GetDReyeVRSensor(class UWorld *World = nullptr);
+    // every DReyeVR sensor in the world
+    static TArray<class ADReyeVRSensor *> GetDReyeVRSensors(class UWorld *World);
     static bool bIsReplaying;
 
   protected:
     void BeginPlay() override;
+    void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     void BeginDestroy() override;
 
     class UWorld *World;
     static class UWorld *sWorld; // to get info about the world: time, frames, etc.
 
     bool bStreamData = true;
+    // the streamed samples are sent in one message every StreamBatchTicks ticks (or StreamBatchMs ms if positive)
+    int StreamBatchTicks = 1;
+    float StreamBatchMs = 0.f;
+    uint32_t StreamFieldMask = carla::sensor::s11n::DReyeVRSerializer::AllFields;
+    // the stream messages are also published to this shared memory (for local readers) if not empty
+    FString SharedMemoryName = "";
+    int SharedMemorySlots = 256;
+    int SharedMemorySlotSize = 65536;
+    void OpenSharedMemory();
+
+    // everything stored in this sensor
+    DReyeVR::SnapshotChannel<DReyeVR::AggregateData> Data;
 
     static class ADReyeVRSensor *DReyeVRSensorPtr;
     static void InterpPositionAndRotation(const FVector &Pos1, const FRotator &Rot1, const FVector &Pos2,
                                           const FRotator &Rot2, const double Per, FVector &Location,
                                           FRotator &Rotation);
+
+  private:
+    // samples waiting to be streamed (and their focus actor names)
+    std::vector<carla::sensor::s11n::DReyeVRSerializer::Data> StreamBatch;
+    std::vector<std::string> StreamBatchNames;
+    std::vector<std::string> StreamBatchAttentionNames; // MaxAttentionActors per sample
+    int StreamBatchNumTicks = 0;
+    double StreamBatchStartS = 0.0;
+    // the focus/attention names this sensor's stream has sent so far
+    carla::sensor::s11n::DReyeVRSerializer::StreamState StreamStrings;
+    std::unique_ptr<carla::sensor::DReyeVRSharedMemoryWriter> SharedMemory;
 };
\ No newline at end of file
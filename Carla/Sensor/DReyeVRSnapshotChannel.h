@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Triple-buffered channel for the data of a DReyeVR sensor (see ADReyeVRSensor::GetData/GetNextData/PublishData).
+//
+// Producers fill the back buffer (which starts out as a copy of the latest snapshot, so they can update only some of
+// the fields) and Publish() it with a single atomic store of its index. Consumers get a const reference to the latest
+// published snapshot without copying or locking. Since the back buffer never reuses the two most recently published
+// buffers, a snapshot that a consumer holds stays unchanged until two more snapshots are published, i.e. for the rest
+// of the tick on the game thread and for a whole tick on any other thread. There is one producer at a time.
+
+namespace DReyeVR
+{
+
+template <typename T> class SnapshotChannel
+{
+  public:
+    // latest published snapshot
+    const T &Latest() const
+    {
+        return Buffers[Published.load(std::memory_order_acquire)];
+    }
+
+    // back buffer for the next snapshot (producer only)
+    T &Next()
+    {
+        if (!bNextStarted)
+        {
+            Buffers[Back] = Buffers[Published.load(std::memory_order_relaxed)];
+            bNextStarted = true;
+        }
+        return Buffers[Back];
+    }
+
+    // make the back buffer the latest snapshot (producer only), nothing happens if it was not touched since
+    void Publish()
+    {
+        if (!bNextStarted)
+            return;
+        const uint8_t Previous = Published.load(std::memory_order_relaxed);
+        Published.store(Back, std::memory_order_release);
+        Back = 3 - Back - Previous; // the only buffer that is neither of the last two published
+        bNextStarted = false;
+    }
+
+  private:
+    T Buffers[3];
+    std::atomic<uint8_t> Published{0};
+    uint8_t Back = 1;
+    bool bNextStarted = false;
+};
+
+}; // namespace DReyeVR
@@ -36,6 +36,9 @@ public class CarlaUE4 : ModuleRules
         // Add module for SteamVR support with UE4
         PublicDependencyModuleNames.AddRange(new string[] { "HeadMountedDisplay" });
 
+        // GPU readback of the replay frame capture (DReyeVR::FrameReadback)
+        PrivateDependencyModuleNames.AddRange(new string[] { "RHI", "RenderCore" });
+
         if (IsWindows(Target))
         {
             bEnableExceptions = true; // enable unwind semantics for C++-style exceptions
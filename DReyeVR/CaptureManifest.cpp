@@ -0,0 +1,161 @@
+#include "CaptureManifest.h"
+
+#include "HAL/FileManager.h"  // IFileManager
+#include "HAL/PlatformTime.h" // FPlatformTime::Seconds
+
+#include <sstream>
+#include <string>
+
+namespace DReyeVR
+{
+
+static const char *ManifestMagic = "# DReyeVR frame capture manifest";
+static const char *ManifestColumns = "frame,recorder_frame,bytes";
+
+CaptureManifest::~CaptureManifest()
+{
+    Close();
+}
+
+bool CaptureManifest::Load(const FString &Path, const Header &Expected, const FrameCheck &IsOnDisk)
+{
+    Frames.clear();
+    Pending.clear();
+    std::ifstream In(TCHAR_TO_UTF8(*Path), std::ios::binary); // "\n" line endings on every platform
+    std::string Line;
+    if (!In || !std::getline(In, Line) || Line != ManifestMagic)
+        return false;
+
+    // header ("key,value" lines) up to the column names
+    Header Found;
+    while (std::getline(In, Line) && Line != ManifestColumns)
+    {
+        const size_t Comma = Line.find(',');
+        if (Comma == std::string::npos)
+            continue;
+        const std::string Key = Line.substr(0, Comma);
+        const FString Value = UTF8_TO_TCHAR(Line.substr(Comma + 1).c_str());
+        if (Key == "recording")
+            Found.Recording = Value;
+        else if (Key == "recording_md5")
+            Found.RecordingHash = Value;
+        else if (Key == "config")
+            Found.Config = Value;
+    }
+    if (!Found.Matches(Expected))
+        return false;
+
+    // complete frames (the last line may have been cut short by a crash)
+    size_t Dropped = 0;
+    while (std::getline(In, Line) && !In.eof()) // a line without its newline was cut short
+    {
+        std::istringstream Row(Line);
+        uint64_t Frame, RecorderFrameId;
+        int64_t Bytes;
+        char Sep1, Sep2;
+        if (!(Row >> Frame >> Sep1 >> RecorderFrameId >> Sep2 >> Bytes) || Sep1 != ',' || Sep2 != ',')
+            continue;
+        if (IsOnDisk && !IsOnDisk(Frame, Bytes))
+        {
+            Dropped++;
+            continue;
+        }
+        Frames[Frame] = std::make_pair(RecorderFrameId, Bytes);
+    }
+    if (Dropped > 0)
+        LOG_WARN("%d frames of %s are not (completely) on disk anymore, capturing them again", int(Dropped), *Path);
+    return true;
+}
+
+bool CaptureManifest::Open(const FString &Path, const Header &InHeader)
+{
+    Close();
+    Info = InHeader;
+
+    // rewrite what was loaded (without a partial last line) next to the old manifest, then replace it
+    const FString TmpPath = Path + TEXT(".tmp");
+    {
+        std::ofstream Out(TCHAR_TO_UTF8(*TmpPath), std::ios::binary | std::ios::trunc);
+        Out << ManifestMagic << "\n";
+        Out << "recording," << TCHAR_TO_UTF8(*Info.Recording) << "\n";
+        Out << "recording_md5," << TCHAR_TO_UTF8(*Info.RecordingHash) << "\n";
+        Out << "config," << TCHAR_TO_UTF8(*Info.Config) << "\n";
+        Out << ManifestColumns << "\n";
+        for (const auto &It : Frames)
+            Out << It.first << "," << It.second.first << "," << It.second.second << "\n";
+        if (!Out)
+        {
+            LOG_ERROR("Unable to write the frame capture manifest %s", *TmpPath);
+            return false;
+        }
+    }
+    if (!IFileManager::Get().Move(*Path, *TmpPath, true))
+    {
+        LOG_ERROR("Unable to replace the frame capture manifest %s", *Path);
+        return false;
+    }
+    File.open(TCHAR_TO_UTF8(*Path), std::ios::binary | std::ios::app);
+    LastFlush = FPlatformTime::Seconds();
+    return File.is_open();
+}
+
+void CaptureManifest::Flush()
+{
+    if (File.is_open())
+        File.flush();
+    LastFlush = FPlatformTime::Seconds();
+}
+
+void CaptureManifest::Close()
+{
+    if (File.is_open())
+        File.close();
+}
+
+size_t CaptureManifest::FirstMissing(size_t From) const
+{
+    // the complete frames are sorted: walk the run of consecutive ones from From on
+    auto It = Frames.lower_bound(From);
+    while (It != Frames.end() && It->first == From)
+    {
+        ++It;
+        ++From;
+    }
+    return From;
+}
+
+void CaptureManifest::BeginFrame(size_t Frame, uint64_t RecorderFrameId, int NumOutputs)
+{
+    PendingFrame &P = Pending[Frame];
+    P.RecorderFrameId = RecorderFrameId;
+    P.Remaining = NumOutputs;
+    P.Bytes = 0;
+    P.bFailed = false;
+}
+
+void CaptureManifest::OutputWritten(size_t Frame, bool bSuccess, int64_t Bytes)
+{
+    auto It = Pending.find(Frame);
+    if (It == Pending.end())
+        return;
+    PendingFrame &P = It->second;
+    P.bFailed |= !bSuccess || Bytes < 0;
+    P.Bytes += Bytes;
+    if (--P.Remaining > 0)
+        return;
+    if (!P.bFailed)
+        WriteFrame(Frame, P.RecorderFrameId, P.Bytes);
+    Pending.erase(It);
+}
+
+void CaptureManifest::WriteFrame(size_t Frame, uint64_t RecorderFrameId, int64_t Bytes)
+{
+    Frames[Frame] = std::make_pair(RecorderFrameId, Bytes);
+    if (!File.is_open())
+        return;
+    File << Frame << "," << RecorderFrameId << "," << Bytes << "\n";
+    if (FPlatformTime::Seconds() - LastFlush > FlushIntervalSec)
+        Flush();
+}
+
+}; // namespace DReyeVR
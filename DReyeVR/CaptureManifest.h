@@ -0,0 +1,83 @@
+#pragma once
+
+#include "CoreMinimal.h" // FString, TFunction
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+// On-disk manifest of the replay frame capture (manifest.csv next to the screenshots, see
+// AEgoSensor::BeginFrameCapture) so an interrupted capture can be resumed (ResumeCapture) instead of starting over.
+//
+// It identifies what is being captured (the recording, by path and MD5, and the capture settings the outputs depend
+// on) and lists every frame whose screenshots (all shaders & poses) are completely on disk, with their total size.
+// Frames are appended once their last image is written and the file is flushed every FlushIntervalSec, so a crash only
+// loses the last few entries (and those frames are captured again). A partial last line is ignored when loading.
+
+namespace DReyeVR
+{
+
+class CaptureManifest
+{
+  public:
+    struct Header
+    {
+        FString Recording;     // path of the recording (informative, it may have moved since)
+        FString RecordingHash; // MD5 of the recording
+        FString Config;        // frame capture settings
+        bool Matches(const Header &Other) const
+        {
+            return RecordingHash == Other.RecordingHash && Config == Other.Config;
+        }
+    };
+    static constexpr double FlushIntervalSec = 5.0;
+
+    ~CaptureManifest();
+
+    // reads the manifest at Path if it is of the same recording & settings, keeping the frames for which
+    // IsOnDisk(Frame, Bytes) holds (e.g. their files are still all there), false if there is none or it does not match
+    using FrameCheck = TFunction<bool(size_t Frame, int64_t Bytes)>;
+    bool Load(const FString &Path, const Header &Expected, const FrameCheck &IsOnDisk);
+    // (re)writes the manifest at Path with the frames that were loaded, and appends the next ones to it
+    bool Open(const FString &Path, const Header &InHeader);
+    void Flush();
+    void Close();
+    const Header &GetHeader() const
+    {
+        return Info;
+    }
+
+    bool IsComplete(size_t Frame) const
+    {
+        return Frames.count(Frame) > 0;
+    }
+    size_t FirstMissing(size_t From) const; // first frame from From on that is not complete
+    size_t Num() const
+    {
+        return Frames.size();
+    }
+
+    // the frame is complete (and added to the manifest) once all of its NumOutputs outputs are written
+    void BeginFrame(size_t Frame, uint64_t RecorderFrameId, int NumOutputs);
+    void OutputWritten(size_t Frame, bool bSuccess, int64_t Bytes);
+
+  private:
+    struct PendingFrame
+    {
+        uint64_t RecorderFrameId = 0;
+        int Remaining = 0;
+        int64_t Bytes = 0;
+        bool bFailed = false;
+    };
+    void WriteFrame(size_t Frame, uint64_t RecorderFrameId, int64_t Bytes);
+
+    Header Info;
+    std::ofstream File;
+    double LastFlush = 0.0;
+    std::map<size_t, std::pair<uint64_t, int64_t>> Frames; // complete ones: recorder frame id & bytes, by index
+    std::unordered_map<size_t, PendingFrame> Pending;      // being written
+};
+
+}; // namespace DReyeVR
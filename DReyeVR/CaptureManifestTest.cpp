@@ -0,0 +1,63 @@
+#include "CaptureManifest.h"
+#include "EgoSensor.h" // AEgoSensor::GetFramePath, AEgoSensor::WriteFrame
+
+#include "Async/TaskGraphInterfaces.h" // FTaskGraphInterface
+#include "HAL/FileManager.h"           // IFileManager
+#include "HighResScreenshot.h"         // GetHighResScreenshotConfig
+#include "ImageWriteQueue.h"           // IImageWriteQueue
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h" // FPaths
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Run with "Automation RunTests DReyeVR.FrameCapture" (editor console or -ExecCmds)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDReyeVRCaptureManifestJPGTest, "DReyeVR.FrameCapture.ManifestJPG",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDReyeVRCaptureManifestJPGTest::RunTest(const FString &Parameters)
+{
+    const FString Dir = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("DReyeVRCapture"));
+    IFileManager::Get().DeleteDirectory(*Dir, false, true);
+    IFileManager::Get().MakeDirectory(*Dir, true);
+    const FString ManifestPath = FPaths::Combine(Dir, TEXT("manifest.csv"));
+    DReyeVR::CaptureManifest::Header Header;
+    Header.Recording = TEXT("test.log");
+    Header.RecordingHash = TEXT("0123456789abcdef");
+    Header.Config = TEXT("FileFormatJPG=1;Views=1");
+    TSharedPtr<DReyeVR::CaptureManifest> Manifest = MakeShared<DReyeVR::CaptureManifest>();
+    if (!TestTrue(TEXT("Manifest opened"), Manifest->Open(ManifestPath, Header)))
+        return false;
+
+    // one JPG frame of a single shader & pose, written like the image sink of the frame capture does
+    const size_t FrameIdx = 7;
+    const FIntPoint Size(64, 32);
+    TArray<FColor> Pixels;
+    Pixels.Init(FColor(200, 100, 50), Size.X * Size.Y);
+    const FString FilePath = AEgoSensor::GetFramePath(Dir, TEXT("tick"), 0, 0, FrameIdx, true);
+    TestTrue(TEXT("JPG extension"), FilePath.EndsWith(TEXT(".jpg")));
+    Manifest->BeginFrame(FrameIdx, 1234, 1);
+    AEgoSensor::WriteFrame(MoveTemp(Pixels), Size, FilePath, true, Manifest, FrameIdx);
+
+    // wait for the image write queue, then run its completion callbacks (which are dispatched to the game thread)
+    GetHighResScreenshotConfig().ImageWriteQueue->CreateFence().Wait();
+    FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+    Manifest->Close();
+    TestTrue(TEXT("Frame written"), IFileManager::Get().FileSize(*FilePath) > 0);
+    TestTrue(TEXT("Frame complete"), Manifest->IsComplete(FrameIdx));
+
+    // a resumed capture finds it, with the size of the file on disk
+    DReyeVR::CaptureManifest Reloaded;
+    auto IsOnDisk = [&Dir](size_t Frame, int64_t Bytes) {
+        return IFileManager::Get().FileSize(*AEgoSensor::GetFramePath(Dir, TEXT("tick"), 0, 0, Frame, true)) == Bytes;
+    };
+    TestTrue(TEXT("Manifest loaded"), Reloaded.Load(ManifestPath, Header, IsOnDisk));
+    TestTrue(TEXT("Frame in the manifest"), Reloaded.IsComplete(FrameIdx));
+    TestEqual(TEXT("First frame to capture"), static_cast<int32>(Reloaded.FirstMissing(FrameIdx)),
+              static_cast<int32>(FrameIdx + 1));
+
+    IFileManager::Get().DeleteDirectory(*Dir, false, true);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -2,6 +2,7 @@
 #include "Carla/AI/AIControllerFactory.h"      // AAIControllerFactory
 #include "Carla/Actor/StaticMeshFactory.h"     // AStaticMeshFactory
 #include "Carla/Game/CarlaStatics.h"           // GetReplayer, GetEpisode
+#include "Carla/Recorder/CarlaRecorder.h"      // ACarlaRecorder
 #include "Carla/Recorder/CarlaReplayer.h"      // ACarlaReplayer
 #include "Carla/Sensor/DReyeVRSensor.h"        // ADReyeVRSensor
 #include "Carla/Sensor/SensorFactory.h"        // ASensorFactory
@@ -14,8 +15,10 @@
 #include "DReyeVRUtils.h"                      // FindDefnInRegistry
 #include "EgoVehicle.h"                        // AEgoVehicle
 #include "FlatHUD.h"                           // ADReyeVRHUD
+#include "HAL/FileManager.h"                    // IFileManager
 #include "HeadMountedDisplayFunctionLibrary.h" // IsHeadMountedDisplayAvailable
 #include "Kismet/GameplayStatics.h"            // GetPlayerController
+#include "Misc/Paths.h"                        // FPaths
 #include "UObject/UObjectIterator.h"           // TObjectInterator
 
 ADReyeVRGameMode::ADReyeVRGameMode(FObjectInitializer const &FO) : Super(FO)
@@ -65,6 +68,10 @@ ADReyeVRGameMode::ADReyeVRGameMode(FObjectInitializer const &FO) : Super(FO)
     bool bEnableReplayInterpolation = false;
     ReadConfigValue("Replayer", "ReplayInterpolation", bEnableReplayInterpolation);
     bReplaySync = !bEnableReplayInterpolation; // synchronous => no interpolation!
+    ReadConfigValue("Replayer", "ExitAfterReplay", bExitAfterReplay);
+    ReadConfigValue("Replayer", "KeyframeInterval", KeyframeInterval);
+    ReadConfigValue("Replayer", "RecorderDropFrames", bRecorderDropFrames);
+    ReadConfigValue("Replayer", "RecorderCompact", bRecorderCompact);
 }
 
 void ADReyeVRGameMode::BeginPlay()
@@ -443,14 +450,68 @@ void ADReyeVRGameMode::SetupReplayer()
     if (Replayer != nullptr)
     {
         Replayer->SetSyncMode(bReplaySync);
+        Replayer->SetExitAfterSyncReplay(bExitAfterReplay);
         if (bReplaySync)
         {
             LOG_WARN("Replay operating in frame-wise (1:1) synchronous mode (no replay interpolation)");
         }
+        auto *Recorder = UCarlaStatics::GetRecorder(GetWorld());
+        if (Recorder != nullptr)
+        {
+            Recorder->SetKeyframeInterval(KeyframeInterval);
+            Recorder->SetDropFramesWhenBusy(bRecorderDropFrames);
+            Recorder->SetCompactMode(bRecorderCompact);
+        }
         bRecorderInitiated = true;
     }
 }
 
+void ADReyeVRGameMode::ExportRecording(const FString &Filename, const FString &OutDir)
+{
+    auto *Recorder = UCarlaStatics::GetRecorder(GetWorld());
+    if (Recorder == nullptr)
+        return;
+    LOG("Exporting recording \"%s\"...", *Filename);
+    const std::string Result = Recorder->ExportFile(TCHAR_TO_UTF8(*Filename), TCHAR_TO_UTF8(*OutDir));
+    LOG("%s", UTF8_TO_TCHAR(Result.c_str()));
+}
+
+void ADReyeVRGameMode::QueryRecordings(const FString &Wildcard, float TimeStart, float TimeEnd,
+                                       const FString &Categories)
+{
+    auto *Recorder = UCarlaStatics::GetRecorder(GetWorld());
+    if (Recorder == nullptr)
+        return;
+    // relative wildcards are in the same directory the recorder writes to
+    FString Dir = FPaths::GetPath(Wildcard);
+    if (FPaths::IsRelative(Wildcard))
+        Dir = FPaths::Combine(FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir()), Dir);
+    TArray<FString> Found;
+    IFileManager::Get().FindFiles(Found, *FPaths::Combine(Dir, FPaths::GetCleanFilename(Wildcard)), true, false);
+    std::vector<std::string> Files;
+    for (const FString &Name : Found)
+        Files.push_back(TCHAR_TO_UTF8(*FPaths::Combine(Dir, Name)));
+
+    DReyeVR::QueryFilter Filter;
+    Filter.TimeStart = TimeStart;
+    if (TimeEnd > 0.f)
+        Filter.TimeEnd = TimeEnd;
+    Filter.Category1 = Categories.Len() > 0 ? static_cast<char>(Categories[0]) : 'a';
+    Filter.Category2 = Categories.Len() > 1 ? static_cast<char>(Categories[1]) : 'a';
+    Filter.bBlocked = true;
+    LOG("Querying %d recordings matching \"%s\"...", static_cast<int>(Files.size()), *Wildcard);
+    const DReyeVR::BatchResult Result = Recorder->QueryFiles(Files, Filter);
+    for (const auto &Collision : Result.Collisions)
+        LOG("%s: collision at %.2fs %c %c (%u %s, %u %s)",
+            UTF8_TO_TCHAR(Result.Sessions[Collision.Session].Filename.c_str()), Collision.Time, Collision.Type1,
+            Collision.Type2, Collision.Id1, UTF8_TO_TCHAR(Collision.Actor1.c_str()), Collision.Id2,
+            UTF8_TO_TCHAR(Collision.Actor2.c_str()));
+    for (const auto &Blocked : Result.Blocked)
+        LOG("%s: %u %s blocked at %.2fs for %.2fs", UTF8_TO_TCHAR(Result.Sessions[Blocked.Session].Filename.c_str()),
+            Blocked.Id, UTF8_TO_TCHAR(Blocked.Actor.c_str()), Blocked.Time, Blocked.Duration);
+    LOG("%s", UTF8_TO_TCHAR(Result.Summary().c_str()));
+}
+
 void ADReyeVRGameMode::DrawBBoxes()
 {
 #if 0
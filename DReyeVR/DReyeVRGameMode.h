@@ -54,6 +54,15 @@ class ADReyeVRGameMode : public ACarlaGameModeBase
     // Replayer
     void SetupReplayer();
 
+    // export a recording to column files (.npy) for offline analysis (console: ExportRecording test1.log)
+    UFUNCTION(Exec, Category = "DReyeVR Game Mode")
+    void ExportRecording(const FString &Filename, const FString &OutDir = "");
+
+    // collisions & blocked actors of every recording matching a wildcard (console: QueryRecordings study_*.log)
+    UFUNCTION(Exec, Category = "DReyeVR Game Mode")
+    void QueryRecordings(const FString &Wildcard, float TimeStart = 0.f, float TimeEnd = 0.f,
+                         const FString &Categories = "aa");
+
     // Meta world functions
     void SetVolume();
     FTransform GetSpawnPoint(int SpawnPointIndex = 0) const;
@@ -93,6 +102,10 @@ class ADReyeVRGameMode : public ACarlaGameModeBase
     double ReplayTimeFactorMin = 0.0;     // minimum playback of 0 (paused)
     double ReplayTimeFactorMax = 4.0;     // maximum of 4.0x playback
     bool bReplaySync = false;             // false allows for interpolation
+    bool bExitAfterReplay = false;        // quit once a synchronized replay (frame capture) is done
     bool bUseCarlaSpectator = false;      // use the Carla spectator or spawn our own
+    float KeyframeInterval = 10.f;        // seconds between full-state keyframes in recordings (0 to disable)
+    bool bRecorderDropFrames = false;     // skip recorder ticks (rather than stall) when the disk is busy
+    bool bRecorderCompact = false;        // delta-coded/quantized positions and sensor data in recordings
     bool bRecorderInitiated = false;      // allows tick-wise checking for replayer/recorder
 };
\ No newline at end of file
@@ -112,6 +112,22 @@ static void ReadDReyeVRConfig()
     {
         LOG_ERROR("Unable to open the config file %s", *ConfigFilePath);
     }
+
+    // command-line overrides of single variables (e.g. for each process of a sharded replay) in the form of
+    // -DReyeVR:Section/Variable=Value
+    const TCHAR *CmdLine = FCommandLine::Get();
+    FString Token;
+    while (FParse::Token(CmdLine, Token, false))
+    {
+        FString VariableName, Value;
+        if (Token.RemoveFromStart(TEXT("-DReyeVR:")) && Token.Split(TEXT("="), &VariableName, &Value))
+        {
+            LOG_WARN("Overriding config variable \"%s\" from the command line", *VariableName);
+            bool bHasQuotes = false;
+            const std::string Name = TCHAR_TO_UTF8(*VariableName);
+            Params[Name].DataStr = Value.TrimStartAndEnd().TrimQuotes(&bHasQuotes);
+        }
+    }
     // for (auto &e : Params){
     //     LOG_WARN("%s: %s", *FString(e.first.c_str()), *e.second);
     // }
@@ -278,40 +294,53 @@ static float CmPerSecondToXPerHour(const bool MilesPerHour)
     return 0.036f;
 }
 
-static void SaveFrameToDisk(UTextureRenderTarget2D &RenderTarget, const FString &FilePath, const bool FileFormatJPG)
+static void WriteFrameToDisk(TArray<FColor> &&Pixels, const FIntPoint &Size, const FString &FilePath,
+                             const bool FileFormatJPG, TFunction<void(bool)> &&OnWritten = nullptr)
+{
+    // dump pixel array to disk (on the image write queue's own threads)
+    TUniquePtr<TImagePixelData<FColor>> PixelData = MakeUnique<TImagePixelData<FColor>>(Size);
+    PixelData->Pixels = MoveTemp(Pixels);
+    TUniquePtr<FImageWriteTask> ImageTask = MakeUnique<FImageWriteTask>();
+    ImageTask->PixelData = MoveTemp(PixelData);
+    ImageTask->Filename = FilePath;
+    // LOG("Saving screenshot to %s", *FilePath);
+    ImageTask->Format = FileFormatJPG ? EImageFormat::JPEG : EImageFormat::PNG; // lower quality, less storage
+    ImageTask->CompressionQuality = (int32)EImageCompressionQuality::Default;
+    ImageTask->bOverwriteFile = true;
+    ImageTask->PixelPreProcessors.Add(TAsyncAlphaWrite<FColor>(255));
+    ImageTask->OnCompleted = MoveTemp(OnWritten); // called on the game thread (with whether it succeeded)
+    FHighResScreenshotConfig &HighResScreenshotConfig = GetHighResScreenshotConfig();
+    HighResScreenshotConfig.ImageWriteQueue->Enqueue(MoveTemp(ImageTask));
+}
+
+// synchronous readback (waits for the GPU), see DReyeVR::FrameReadback for the pipelined one
+static bool ReadFramePixels(UTextureRenderTarget2D &RenderTarget, TArray<FColor> &Pixels)
 {
     FTextureRenderTargetResource *RTResource = RenderTarget.GameThread_GetRenderTargetResource();
     const size_t H = RenderTarget.GetSurfaceHeight();
     const size_t W = RenderTarget.GetSurfaceWidth();
-    const FIntPoint DestSize(W, H);
-    TImagePixelData<FColor> PixelData(DestSize);
 
     // Read pixels into array
     // heavily inspired by Carla's Carla/Sensor/PixelReader.cpp:WritePixelsToArray function
-    TArray<FColor> Pixels;
-    Pixels.AddUninitialized(H * W);
+    Pixels.SetNumUninitialized(H * W);
     FReadSurfaceDataFlags ReadPixelFlags(RCM_UNorm);
     ReadPixelFlags.SetLinearToGamma(true);
     if (RTResource == nullptr)
     {
         LOG_ERROR("Missing render target!");
-        return;
+        return false;
     }
     if (!RTResource->ReadPixels(Pixels, ReadPixelFlags))
         LOG_ERROR("Unable to read pixels!");
+    return true;
+}
 
-    // dump pixel array to disk
-    PixelData.Pixels = Pixels;
-    TUniquePtr<FImageWriteTask> ImageTask = MakeUnique<FImageWriteTask>();
-    ImageTask->PixelData = MakeUnique<TImagePixelData<FColor>>(PixelData);
-    ImageTask->Filename = FilePath;
-    // LOG("Saving screenshot to %s", *FilePath);
-    ImageTask->Format = FileFormatJPG ? EImageFormat::JPEG : EImageFormat::PNG; // lower quality, less storage
-    ImageTask->CompressionQuality = (int32)EImageCompressionQuality::Default;
-    ImageTask->bOverwriteFile = true;
-    ImageTask->PixelPreProcessors.Add(TAsyncAlphaWrite<FColor>(255));
-    FHighResScreenshotConfig &HighResScreenshotConfig = GetHighResScreenshotConfig();
-    HighResScreenshotConfig.ImageWriteQueue->Enqueue(MoveTemp(ImageTask));
+static void SaveFrameToDisk(UTextureRenderTarget2D &RenderTarget, const FString &FilePath, const bool FileFormatJPG)
+{
+    TArray<FColor> Pixels;
+    if (ReadFramePixels(RenderTarget, Pixels))
+        WriteFrameToDisk(MoveTemp(Pixels), FIntPoint(RenderTarget.GetSurfaceWidth(), RenderTarget.GetSurfaceHeight()),
+                         FilePath, FileFormatJPG);
 }
 
 static UTexture2D *CreateTexture2DFromArray(const TArray<FColor> &Contents)
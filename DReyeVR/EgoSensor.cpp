@@ -1,11 +1,14 @@
 #include "EgoSensor.h"
 
+#include "Carla/Actor/ActorRegistry.h"  // FActorRegistry
 #include "Carla/Game/CarlaStatics.h"    // GetCurrentEpisode
 #include "DReyeVRUtils.h"               // ReadConfigValue, ComputeClosestToRayIntersection
 #include "EgoVehicle.h"                 // AEgoVehicle
+#include "HAL/FileManager.h"            // IFileManager
 #include "Kismet/GameplayStatics.h"     // UGameplayStatics::ProjectWorldToScreen
 #include "Kismet/KismetMathLibrary.h"   // Sin, Cos, Normalize
 #include "Misc/DateTime.h"              // FDateTime
+#include "Misc/SecureHash.h"            // FMD5Hash
 #include "UObject/UObjectBaseUtility.h" // GetName
 
 #if USE_SRANIPAL_PLUGIN
@@ -17,7 +20,9 @@
 #include "VRSBlueprintFunctionLibrary.h" // VRS
 #endif
 
+#include <algorithm> // std::sort, std::find_if
 #include <string>
+#include <vector>
 
 #ifndef NO_DREYEVR_EXCEPTIONS
 #include <exception>
@@ -46,6 +51,36 @@ void AEgoSensor::ReadConfigVariables()
     ReadConfigValue("EgoSensor", "StreamSensorData", bStreamData);
     ReadConfigValue("EgoSensor", "MaxTraceLenM", MaxTraceLenM);
     ReadConfigValue("EgoSensor", "DrawDebugFocusTrace", bDrawDebugFocusTrace);
+    ReadConfigValue("EgoSensor", "AsyncFocusTrace", bAsyncFocusTrace);
+    ReadConfigValue("EgoSensor", "TraceEachEye", bTraceEachEye);
+    ReadConfigValue("EgoSensor", "BoundingBoxFocus", bBoundingBoxFocus);
+    ReadConfigValue("EgoSensor", "GazeConeRays", GazeConeRays);
+    ReadConfigValue("EgoSensor", "GazeConeDeg", GazeConeDeg);
+    ReadConfigValue("EgoSensor", "GazeConeBudgetMs", GazeConeBudgetMs);
+    Cone.Init(GazeConeRays, GazeConeDeg);
+    ActiveConeRays = Cone.Num();
+    ReadConfigValue("EgoSensor", "EyeTrackerSampleRate", EyeSampleRateHz);
+    ReadConfigValue("EgoSensor", "DetectFixations", bDetectFixations);
+    DReyeVR::FixationDetector::Params FixationParams;
+    FString FixationMethod = "IVT";
+    ReadConfigValue("EgoSensor", "FixationMethod", FixationMethod);
+    FixationParams.Algorithm = FixationMethod.Equals("IDT", ESearchCase::IgnoreCase)
+                                   ? DReyeVR::FixationDetector::Method::IDT
+                                   : DReyeVR::FixationDetector::Method::IVT;
+    ReadConfigValue("EgoSensor", "SaccadeVelocityDeg", FixationParams.VelocityThresholdDeg);
+    ReadConfigValue("EgoSensor", "FixationDispersionDeg", FixationParams.DispersionThresholdDeg);
+    ReadConfigValue("EgoSensor", "MinFixationMs", FixationParams.MinFixationMs);
+    ReadConfigValue("EgoSensor", "MaxGazeGapMs", FixationParams.MaxGapMs);
+    Fixations.Init(FixationParams);
+    ReadConfigValue("EgoSensor", "StreamBatchTicks", StreamBatchTicks);
+    ReadConfigValue("EgoSensor", "StreamBatchMs", StreamBatchMs);
+    StreamBatchTicks = FMath::Max(1, StreamBatchTicks);
+    FString StreamFields = "all";
+    ReadConfigValue("EgoSensor", "StreamFields", StreamFields);
+    SetStreamFields(StreamFields);
+    ReadConfigValue("EgoSensor", "SharedMemoryName", SharedMemoryName);
+    ReadConfigValue("EgoSensor", "SharedMemorySlots", SharedMemorySlots);
+    ReadConfigValue("EgoSensor", "SharedMemorySlotSize", SharedMemorySlotSize);
 
     // variables corresponding to the action of screencapture during replay
     ReadConfigValue("Replayer", "RecordAllShaders", bRecordAllShaders);
@@ -55,8 +90,17 @@ void AEgoSensor::ReadConfigVariables()
     ReadConfigValue("Replayer", "LinearGamma", bFrameCapForceLinearGamma);
     ReadConfigValue("Replayer", "FrameWidth", FrameCapWidth);
     ReadConfigValue("Replayer", "FrameHeight", FrameCapHeight);
-    ReadConfigValue("Replayer", "FrameDir", FrameCapLocation);
+    ReadConfigValue("Replayer", "FrameDir", FrameCapDir);
     ReadConfigValue("Replayer", "FrameName", FrameCapFilename);
+    ReadConfigValue("Replayer", "FrameReadbacks", FrameReadbacksInFlight);
+    FString FrameSink = "images";
+    ReadConfigValue("Replayer", "FrameSink", FrameSink);
+    bFrameCapVideo = FrameSink.Equals("video", ESearchCase::IgnoreCase);
+    ReadConfigValue("Replayer", "VideoEncoder", VideoParams.Encoder);
+    ReadConfigValue("Replayer", "VideoFrameRate", VideoParams.FrameRate);
+    ReadConfigValue("Replayer", "VideoQuality", VideoParams.Quality);
+    ReadConfigValue("Replayer", "VideoLossless", VideoParams.bLosslessAll);
+    ReadConfigValue("Replayer", "ResumeCapture", bResumeCapture);
 
 #if USE_FOVEATED_RENDER
     // foveated rendering variables
@@ -74,6 +118,7 @@ void AEgoSensor::BeginPlay()
 
     // Initialize the eye tracker hardware
     InitEyeTracker();
+    StartEyeSampler();
 
 #if USE_FOVEATED_RENDER
     // Initialize VRS plugin (using our VRS fork!)
@@ -89,7 +134,13 @@ void AEgoSensor::BeginDestroy()
 {
     Super::BeginDestroy();
 
+    StopEyeSampler(); // before the eye tracker goes away
     DestroyEyeTracker();
+    FrameReadbacks.Flush(); // the captures still in flight
+    Video.Close();          // after them, finishes the videos
+    if (Manifest.IsValid())
+        Manifest->Flush(); // the images still being written complete it later (or are captured again on resume)
+    Manifest.Reset();
 
     LOG("EgoSensor has been destroyed");
 }
@@ -99,20 +150,23 @@ void AEgoSensor::ManualTick(float DeltaSeconds)
     if (!bIsReplaying) // only update the sensor with local values if not replaying
     {
         const float Timestamp = int64_t(1000.f * UGameplayStatics::GetRealTimeSeconds(World));
-        /// TODO: query the eye tracker hardware asynchronously (not limited to UE4 tick)
-        TickEyeTracker();   // query the eye-tracker hardware for current data
-        ComputeFocusInfo(); // compute gaze focus data
+        TickEyeTracker();   // collect the eye-tracker samples since the last tick
         ComputeEgoVars();   // get all necessary ego-vehicle data
+        ComputeFocusInfo(); // compute gaze focus data (of this tick's gaze and camera pose)
 
         // Update the internal sensor data that gets handed off to Carla (for recording/replaying/PythonAPI)
-        GetData()->Update(Timestamp,                  // TimestampCarla (ms)
-                          EyeSensorData,              // EyeTrackerData
-                          EgoVars,                    // EgoVehicleVariables
-                          FocusInfoData,              // FocusData
-                          Vehicle->GetVehicleInputs() // User inputs
+        GetNextData().Update(Timestamp,                  // TimestampCarla (ms)
+                             EyeSensorData,              // EyeTrackerData
+                             EgoVars,                    // EgoVehicleVariables
+                             GetFocusInfo(),             // FocusData
+                             Vehicle->GetVehicleInputs() // User inputs
         );
+        GetNextData().UpdateAttention(std::vector<DReyeVR::ActorAttention>(Attention));
+        PublishData(); // everything else reads this tick's snapshot from here on
         TickFoveatedRender();
     }
+    if (bCreatedDirectory)
+        FrameReadbacks.Poll(); // write the captures whose readback completed since
     TickCount++;
 }
 
@@ -184,12 +238,12 @@ void AEgoSensor::DestroyEyeTracker()
 #endif
 }
 
-void AEgoSensor::TickEyeTracker()
+void AEgoSensor::SampleEyeTracker(DReyeVR::EyeTracker &Sample, int64_t Sequence)
 {
-    /// TODO: move this function to an async thread to obtain 120hz data capture
-    auto Combined = &(EyeSensorData.Combined);
-    auto Left = &(EyeSensorData.Left);
-    auto Right = &(EyeSensorData.Right);
+    /// NOTE: this runs on the sampler thread when EyeSampleRateHz > 0 (see RunEyeSampler)
+    auto Combined = &(Sample.Combined);
+    auto Left = &(Sample.Left);
+    auto Right = &(Sample.Right);
 #if USE_SRANIPAL_PLUGIN
     if (bSRanipalEnabled)
     {
@@ -219,8 +273,8 @@ void AEgoSensor::TickEyeTracker()
         int EyeDataStatus = SRanipal->GetEyeData_(&EyeData);
         if (EyeDataStatus == ViveSR::Error::WORK)
         {
-            EyeSensorData.TimestampDevice = EyeData.timestamp;
-            EyeSensorData.FrameSequence = EyeData.frame_sequence;
+            Sample.TimestampDevice = EyeData.timestamp;
+            Sample.FrameSequence = EyeData.frame_sequence;
             // Assign Pupil Diameters
             Left->PupilDiameter = EyeData.verbose_data.left.pupil_diameter_mm;
             Right->PupilDiameter = EyeData.verbose_data.right.pupil_diameter_mm;
@@ -228,31 +282,112 @@ void AEgoSensor::TickEyeTracker()
     }
     else
     {
-        ComputeDummyEyeData();
+        ComputeDummyEyeData(Sample, Sequence);
     }
 #else
-    ComputeDummyEyeData();
+    ComputeDummyEyeData(Sample, Sequence);
 #endif
     Combined->Vergence = ComputeVergence(Left->GazeOrigin, Left->GazeDir, Right->GazeOrigin, Right->GazeDir);
+}
+
+void AEgoSensor::TickEyeTracker()
+{
+    std::vector<DReyeVR::EyeTracker> Samples;
+    if (bEyeSamplerRunning)
+    {
+        // drain everything the sampler thread collected since the last tick
+        DReyeVR::EyeTracker Sample;
+        while (EyeSampleQueue.Pop(Sample))
+            Samples.push_back(Sample);
+        // if the sampler has not produced anything new (game running faster than the tracker) keep the last sample
+        if (!Samples.empty())
+            EyeSensorData = Samples.back();
+    }
+    else
+    {
+        SampleEyeTracker(EyeSensorData, TickCount);
+        Samples.push_back(EyeSensorData);
+    }
+    // classify the samples in order, the events are attributed to the sample that completed them (DetectedAt)
+    std::vector<DReyeVR::GazeEvent> Events;
+    if (bDetectFixations)
+    {
+        for (const DReyeVR::EyeTracker &Sample : Samples)
+            Fixations.AddSample(Sample, Events);
+    }
+    GetNextData().UpdateGazeEvents(std::move(Events));
+    GetNextData().UpdateEyeSamples(std::move(Samples));
+}
+
+const DReyeVR::FixationDetector &AEgoSensor::GetFixationDetector() const
+{
+    return Fixations;
+}
+
+void AEgoSensor::StartEyeSampler()
+{
+    if (EyeSampleRateHz <= 0.f || bEyeSamplerRunning)
+        return;
+    bEyeSamplerRunning = true;
+    EyeSamplerThread = std::thread(&AEgoSensor::RunEyeSampler, this);
+    LOG("Sampling the eye tracker asynchronously at %.1fHz", EyeSampleRateHz);
+}
+
+void AEgoSensor::StopEyeSampler()
+{
+    if (!bEyeSamplerRunning)
+        return;
+    bEyeSamplerRunning = false;
+    if (EyeSamplerThread.joinable())
+        EyeSamplerThread.join();
+    if (DroppedEyeSamples > 0)
+        LOG_WARN("Dropped %llu eye tracker samples (game thread fell behind)",
+                 static_cast<unsigned long long>(DroppedEyeSamples.load()));
+}
 
-    // FPlatformProcess::Sleep(0.00833f); // use in async thread to get 120hz
+void AEgoSensor::RunEyeSampler()
+{
+    using Clock = std::chrono::steady_clock;
+    const auto Period =
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / EyeSampleRateHz));
+    auto Next = Clock::now();
+    int64_t Sequence = 0;
+    int64_t LastFrameSequence = -1;
+    DReyeVR::EyeTracker Sample;
+    while (bEyeSamplerRunning)
+    {
+        SampleEyeTracker(Sample, Sequence++);
+        // only keep new frames from the device (polling can be slightly faster than the hardware)
+        if (Sample.FrameSequence != LastFrameSequence)
+        {
+            LastFrameSequence = Sample.FrameSequence;
+            if (!EyeSampleQueue.Push(Sample))
+                DroppedEyeSamples++;
+        }
+        // fixed-rate schedule (no drift), but never try to catch up with a burst after a stall
+        Next += Period;
+        const auto Now = Clock::now();
+        if (Next < Now)
+            Next = Now;
+        std::this_thread::sleep_until(Next);
+    }
 }
 
-void AEgoSensor::ComputeDummyEyeData()
+void AEgoSensor::ComputeDummyEyeData(DReyeVR::EyeTracker &Sample, int64_t Sequence)
 {
     // Function to make "dummy" eye data where the eye gaze just looks around in a CCW circle.
     // Useful for when the eye data is unavailable (Plugin not initialized, on Linux, etc.)
-    auto Combined = &(EyeSensorData.Combined);
-    auto Left = &(EyeSensorData.Left);
-    auto Right = &(EyeSensorData.Right);
+    auto Combined = &(Sample.Combined);
+    auto Left = &(Sample.Left);
+    auto Right = &(Sample.Right);
     // generate dummy values bc no hardware sensor is present
-    EyeSensorData.TimestampDevice = int64_t(
+    Sample.TimestampDevice = int64_t(
         std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - ChronoStartTime)
             .count());
-    EyeSensorData.FrameSequence = TickCount; // get the current tick
+    Sample.FrameSequence = Sequence; // current tick (or sample index when sampling asynchronously)
 
     // generate gaze that rotates in CCW fashion around the camera ray
-    const float TimeNow = EyeSensorData.TimestampDevice / 1000.f;
+    const float TimeNow = Sample.TimestampDevice / 1000.f;
     Combined->GazeDir.X = 5.0;
     Combined->GazeDir.Y = UKismetMathLibrary::Cos(TimeNow);
     Combined->GazeDir.Z = UKismetMathLibrary::Sin(TimeNow);
@@ -275,22 +410,58 @@ void AEgoSensor::ComputeFocusInfo()
     // ECC_Camera: Usually used when tracing from the camera to something.
     // https://docs.unrealengine.com/4.27/en-US/API/Runtime/Engine/Engine/ECollisionChannel/
     // https://zompidev.blogspot.com/2021/08/visibility-vs-camera-trace-channels-in.html
-    ComputeTraceFocusInfo(ECC_Visibility);
+    if (bBoundingBoxFocus)
+    {
+        UpdateActorIndex();
+        ComputeBoxFocusInfo();
+    }
+    else if (bAsyncFocusTrace)
+    {
+        CollectGazeTraces(); // focus of the previous tick's sample
+        IssueGazeTraces(ECC_Visibility);
+    }
+    else
+    {
+        ComputeTraceFocusInfo(ECC_Visibility);
+    }
+    ComputeAttention(ECC_Visibility);
 }
 
-bool AEgoSensor::ComputeGazeTrace(FHitResult &Hit, const ECollisionChannel TraceChannel, float TraceRadius) const
+const DReyeVR::FocusInfo &AEgoSensor::GetFocusInfo(DReyeVR::Gaze Index) const
 {
+    return FocusInfoData[static_cast<int>(Index)];
+}
+
+void AEgoSensor::ComputeGazeRay(DReyeVR::Gaze Index, FVector &Start, FVector &End) const
+{
+    const DReyeVR::EyeData *Gaze = &EyeSensorData.Combined;
+    if (Index == DReyeVR::Gaze::LEFT)
+        Gaze = &EyeSensorData.Left;
+    else if (Index == DReyeVR::Gaze::RIGHT)
+        Gaze = &EyeSensorData.Right;
     const float TraceLen = MaxTraceLenM * 100.f; // convert to m from cm
-    const FRotator &WorldRot = GetData()->GetCameraRotationAbs();
-    const FVector &WorldPos = GetData()->GetCameraLocationAbs();
-    const FVector GazeOrigin = WorldPos + WorldRot.RotateVector(GetData()->GetGazeOrigin());
-    const FVector GazeRay = TraceLen * WorldRot.RotateVector(GetData()->GetGazeDir()).GetSafeNormal();
+    const FRotator &WorldRot = EgoVars.CameraRotationAbs;
+    const FVector &WorldPos = EgoVars.CameraLocationAbs;
+    Start = WorldPos + WorldRot.RotateVector(Gaze->GazeOrigin);
+    End = Start + TraceLen * WorldRot.RotateVector(Gaze->GazeDir).GetSafeNormal();
+}
+
+FCollisionQueryParams AEgoSensor::GetGazeTraceParams() const
+{
     // Create collision information container.
-    FCollisionQueryParams TraceParam;
-    TraceParam = FCollisionQueryParams(FName("TraceParam"), true);
+    FCollisionQueryParams TraceParam = FCollisionQueryParams(FName("TraceParam"), true);
     TraceParam.AddIgnoredActor(Vehicle); // don't collide with the vehicle since that would be useless
     TraceParam.bTraceComplex = true;
     TraceParam.bReturnPhysicalMaterial = false;
+    return TraceParam;
+}
+
+bool AEgoSensor::ComputeGazeTrace(FHitResult &Hit, const ECollisionChannel TraceChannel, float TraceRadius,
+                                  DReyeVR::Gaze Index) const
+{
+    FVector GazeStart, GazeEnd;
+    ComputeGazeRay(Index, GazeStart, GazeEnd);
+    const FCollisionQueryParams TraceParam = GetGazeTraceParams();
     Hit = FHitResult(EForceInit::ForceInit);
     bool bDidHit = false;
 
@@ -300,62 +471,204 @@ bool AEgoSensor::ComputeGazeTrace(FHitResult &Hit, const ECollisionChannel Trace
     ensure(World != nullptr);
     if (TraceRadius == 0.f) // Single ray/line trace
     {
-        bDidHit = World->LineTraceSingleByChannel(Hit, GazeOrigin, GazeOrigin + GazeRay, TraceChannel, TraceParam);
+        bDidHit = World->LineTraceSingleByChannel(Hit, GazeStart, GazeEnd, TraceChannel, TraceParam);
     }
     else // Sphear line trace
     {
         FCollisionShape Sphear = FCollisionShape();
         Sphear.SetSphere(TraceRadius);
-        bDidHit = World->SweepSingleByChannel(Hit, GazeOrigin, GazeOrigin + GazeRay, FQuat(0.f, 0.f, 0.f, 0.f),
-                                              TraceChannel, Sphear, TraceParam);
+        bDidHit =
+            World->SweepSingleByChannel(Hit, GazeStart, GazeEnd, FQuat::Identity, TraceChannel, Sphear, TraceParam);
     }
 
     if (!bDidHit)
     {
         // focus point is just straight ahead to the maximum trace length
         Hit.Actor = nullptr;
-        Hit.Location = GazeOrigin + GazeRay;
-        Hit.Distance = TraceLen;
+        Hit.Location = GazeEnd;
+        Hit.Distance = MaxTraceLenM * 100.f;
     }
 
     if (bDrawDebugFocusTrace)
     {
         DrawDebugSphere(World, Hit.Location, 8.0f, 30, FColor::Blue);
-        DrawDebugLine(World,
-                      GazeOrigin,           // start line
-                      GazeOrigin + GazeRay, // end line
-                      FColor::Purple, false, -1, 0, 1);
+        DrawDebugLine(World, GazeStart, GazeEnd, FColor::Purple, false, -1, 0, 1);
     }
     return bDidHit;
 }
 
 void AEgoSensor::ComputeTraceFocusInfo(const ECollisionChannel TraceChannel, float TraceRadius)
 {
-    FHitResult Hit;
-    bool bDidHit = ComputeGazeTrace(Hit, TraceChannel, TraceRadius);
-    // Update fields
+    for (int i = 0; i < 3; i++)
+    {
+        const DReyeVR::Gaze Index = static_cast<DReyeVR::Gaze>(i);
+        if (Index != DReyeVR::Gaze::COMBINED && !bTraceEachEye)
+            continue;
+        FHitResult Hit;
+        const bool bDidHit = ComputeGazeTrace(Hit, TraceChannel, TraceRadius, Index);
+        UpdateFocusInfo(FocusInfoData[i], Hit, bDidHit, EyeSensorData.TimestampDevice);
+    }
+}
+
+void AEgoSensor::IssueGazeTraces(const ECollisionChannel TraceChannel, float TraceRadius)
+{
+    ensure(World != nullptr);
+    const FCollisionQueryParams TraceParam = GetGazeTraceParams();
+    TraceRadius = FMath::Max(TraceRadius, 0.f); // 0 for a point, >0 for a sphere trace
+    for (int i = 0; i < 3; i++)
+    {
+        const DReyeVR::Gaze Index = static_cast<DReyeVR::Gaze>(i);
+        PendingGazeTrace &Pending = PendingGazeTraces[i];
+        Pending.Handle = FTraceHandle();
+        if (Index != DReyeVR::Gaze::COMBINED && !bTraceEachEye)
+            continue;
+        ComputeGazeRay(Index, Pending.Start, Pending.End);
+        Pending.SampleTimestamp = EyeSensorData.TimestampDevice;
+        // run by the async trace tasks during this frame, the results are available on the next one
+        if (TraceRadius == 0.f)
+        {
+            Pending.Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Pending.Start, Pending.End,
+                                                            TraceChannel, TraceParam);
+        }
+        else
+        {
+            Pending.Handle =
+                World->AsyncSweepByChannel(EAsyncTraceType::Single, Pending.Start, Pending.End, FQuat::Identity,
+                                           TraceChannel, FCollisionShape::MakeSphere(TraceRadius), TraceParam);
+        }
+    }
+}
+
+void AEgoSensor::CollectGazeTraces()
+{
+    ensure(World != nullptr);
+    for (int i = 0; i < 3; i++)
+    {
+        PendingGazeTrace &Pending = PendingGazeTraces[i];
+        FTraceDatum Datum;
+        // the results are only kept for one frame, if they are gone the previous focus is kept
+        if (!Pending.Handle.IsValid() || !World->QueryTraceData(Pending.Handle, Datum))
+            continue;
+        Pending.Handle = FTraceHandle();
+
+        FHitResult Hit(EForceInit::ForceInit);
+        const bool bDidHit = Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit;
+        if (bDidHit)
+        {
+            Hit = Datum.OutHits[0];
+        }
+        else
+        {
+            // focus point is just straight ahead to the maximum trace length
+            Hit.Location = Pending.End;
+            Hit.Distance = MaxTraceLenM * 100.f;
+        }
+        if (bDrawDebugFocusTrace)
+        {
+            DrawDebugSphere(World, Hit.Location, 8.0f, 30, FColor::Blue);
+            DrawDebugLine(World, Pending.Start, Pending.End, FColor::Purple, false, -1, 0, 1);
+        }
+        UpdateFocusInfo(FocusInfoData[i], Hit, bDidHit, Pending.SampleTimestamp);
+    }
+}
+
+void AEgoSensor::UpdateActorIndex()
+{
+    UCarlaEpisode *Episode = UCarlaStatics::GetCurrentEpisode(World);
+    if (Episode == nullptr)
+        return;
+    ActorIndex.BeginUpdate();
+    const FActorRegistry &Registry = Episode->GetActorRegistry();
+    for (auto It = Registry.begin(); It != Registry.end(); ++It)
+    {
+        const FCarlaActor *View = It.Value().Get();
+        if (View == nullptr || View->GetActorId() == 0 || View->GetActorInfo() == nullptr)
+            continue; // the spectator is not looked at
+        const FBoundingBox &Box = View->GetActorInfo()->BoundingBox;
+        if (Box.Extent.IsNearlyZero())
+            continue; // e.g. sensors
+        // the ego vehicle is indexed too, but the gaze starts inside of it so the queries skip it
+        const FTransform Transform = View->GetActorGlobalTransform();
+        ActorIndex.UpdateActor(View->GetActorId(), Transform.GetLocation(), Transform.GetRotation(), Box.Origin,
+                               Box.Extent);
+    }
+    ActorIndex.EndUpdate();
+}
+
+void AEgoSensor::ComputeBoxFocusInfo()
+{
+    for (int i = 0; i < 3; i++)
+    {
+        const DReyeVR::Gaze Index = static_cast<DReyeVR::Gaze>(i);
+        if (Index != DReyeVR::Gaze::COMBINED && !bTraceEachEye)
+            continue;
+        FVector Start, End;
+        ComputeGazeRay(Index, Start, End);
+        DReyeVR::ActorBoxIndex::Hit BoxHit;
+        const bool bDidHit = ActorIndex.Raycast(Start, End, BoxHit);
+        FHitResult Hit(EForceInit::ForceInit);
+        if (bDidHit)
+        {
+            Hit.Actor = GetIndexedActor(BoxHit.Id);
+            Hit.Location = BoxHit.Location;
+            Hit.Normal = BoxHit.Normal;
+            Hit.Distance = BoxHit.Distance;
+        }
+        else
+        {
+            // focus point is just straight ahead to the maximum trace length
+            Hit.Location = End;
+            Hit.Distance = MaxTraceLenM * 100.f;
+        }
+        if (bDrawDebugFocusTrace)
+        {
+            DrawDebugSphere(World, Hit.Location, 8.0f, 30, FColor::Blue);
+            DrawDebugLine(World, Start, End, FColor::Purple, false, -1, 0, 1);
+        }
+        UpdateFocusInfo(FocusInfoData[i], Hit, bDidHit, EyeSensorData.TimestampDevice);
+    }
+}
+
+AActor *AEgoSensor::GetIndexedActor(uint32 Id) const
+{
+    UCarlaEpisode *Episode = UCarlaStatics::GetCurrentEpisode(World);
+    FCarlaActor *View = Episode != nullptr ? Episode->FindCarlaActor(Id) : nullptr;
+    return View != nullptr ? View->GetActor() : nullptr;
+}
+
+// name of the actor with a suffix for the types we care about ("None" if there is no actor)
+static FString GetActorNameTag(AActor *Actor)
+{
     FString ActorName = "None";
-    if (Hit.Actor != nullptr)
+    if (Actor != nullptr)
     {
-        Hit.Actor->GetName(ActorName);
+        Actor->GetName(ActorName);
         FString Suffix = ""; // suffix to the actor "name" (actor type we care about)
-        if (Cast<AWheeledVehicle>(Hit.Actor) != nullptr)
+        if (Cast<AWheeledVehicle>(Actor) != nullptr)
             Suffix = "_Vehicle";
-        else if (Cast<ACharacter>(Hit.Actor) != nullptr)
+        else if (Cast<ACharacter>(Actor) != nullptr)
             Suffix = "_Walker";
-        else if (Cast<ATrafficSignBase>(Hit.Actor) != nullptr)
+        else if (Cast<ATrafficSignBase>(Actor) != nullptr)
             Suffix = "_TrafficLight";
         /// TODO: add more suffixes here.
         ActorName += Suffix;
     }
+    return ActorName;
+}
+
+void AEgoSensor::UpdateFocusInfo(DReyeVR::FocusInfo &Focus, const FHitResult &Hit, bool bDidHit,
+                                 int64_t SampleTimestamp) const
+{
+    const FString ActorName = GetActorNameTag(Hit.GetActor());
 
     // update internal data structure (see DReyeVRData::FocusInfo)
-    FocusInfoData.Actor = Hit.Actor;        // pointer to actor being hit (if any, else nullptr)
-    FocusInfoData.HitPoint = Hit.Location;  // absolute (world) location of hit
-    FocusInfoData.Normal = Hit.Normal;      // normal of hit surface (if hit)
-    FocusInfoData.ActorNameTag = ActorName; // name of the actor being hit (if any, else "None")
-    FocusInfoData.Distance = Hit.Distance;  // distance from ray start
-    FocusInfoData.bDidHit = bDidHit;        // whether or not there was a hit
+    Focus.Actor = Hit.Actor;                 // pointer to actor being hit (if any, else nullptr)
+    Focus.HitPoint = Hit.Location;           // absolute (world) location of hit
+    Focus.Normal = Hit.Normal;               // normal of hit surface (if hit)
+    Focus.ActorNameTag = ActorName;          // name of the actor being hit (if any, else "None")
+    Focus.Distance = Hit.Distance;           // distance from ray start
+    Focus.bDidHit = bDidHit;                 // whether or not there was a hit
+    Focus.SampleTimestamp = SampleTimestamp; // eye tracker sample this focus belongs to
 }
 
 float AEgoSensor::ComputeVergence(const FVector &L0, const FVector &LDir, const FVector &R0, const FVector &RDir) const
@@ -364,6 +677,149 @@ float AEgoSensor::ComputeVergence(const FVector &L0, const FVector &LDir, const
     return ComputeClosestToRayIntersection(L0, LDir, R0, RDir).Size(); // units are cm (default for UE4)
 }
 
+/// ========================================== ///
+/// --------------:ATTENTION:----------------- ///
+/// ========================================== ///
+
+void AEgoSensor::ComputeAttention(const ECollisionChannel TraceChannel)
+{
+    if (Cone.Num() == 0)
+        return;
+    // no cone without a gaze (blinks, tracking loss): the previous attention is kept, as when no trace result is back
+    const bool bGazeValid = EyeSensorData.Combined.GazeValid;
+    if (bAsyncFocusTrace && !bBoundingBoxFocus)
+    {
+        // the traces run off the game thread where the budget can't measure them, so all GazeConeRays are traced
+        CollectConeTraces(); // attention of the previous tick's sample
+        if (bGazeValid)
+            IssueConeTraces(TraceChannel);
+        return;
+    }
+    if (!bGazeValid)
+        return;
+
+    const double StartS = FPlatformTime::Seconds();
+    if (bBoundingBoxFocus)
+        ComputeBoxAttention(); // the index was updated for the focus
+    else
+        TraceConeNow(TraceChannel);
+
+    // use fewer rays when over the budget and more again when well under it (any prefix of the cone is well spread)
+    const double ElapsedMs = 1000.0 * (FPlatformTime::Seconds() - StartS);
+    if (ElapsedMs > GazeConeBudgetMs)
+        ActiveConeRays = FMath::Max(1, ActiveConeRays * 3 / 4);
+    else if (ElapsedMs < 0.5 * GazeConeBudgetMs)
+        ActiveConeRays = FMath::Min(Cone.Num(), ActiveConeRays + FMath::Max(1, ActiveConeRays / 8));
+}
+
+void AEgoSensor::IssueConeTraces(const ECollisionChannel TraceChannel)
+{
+    ensure(World != nullptr);
+    FVector Start, End;
+    ComputeGazeRay(DReyeVR::Gaze::COMBINED, Start, End);
+    const float TraceLen = MaxTraceLenM * 100.f; // convert to m from cm
+    const FCollisionQueryParams TraceParam = GetGazeTraceParams();
+    if (!Cone.ComputeDirections(End - Start, ActiveConeRays))
+        return; // zero gaze
+    ConeTraces.SetNum(ActiveConeRays);
+    for (int i = 0; i < ActiveConeRays; i++)
+    {
+        ConeTraces[i] = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start,
+                                                       Start + TraceLen * Cone.GetDirection(i), TraceChannel,
+                                                       TraceParam);
+    }
+}
+
+void AEgoSensor::CollectConeTraces()
+{
+    ensure(World != nullptr);
+    NewAttention.clear();
+    float TotalWeight = 0.f;
+    for (int i = 0; i < ConeTraces.Num(); i++)
+    {
+        FTraceDatum Datum;
+        // the results are only kept for one frame, the rays whose results are gone do not count
+        if (!World->QueryTraceData(ConeTraces[i], Datum))
+            continue;
+        const float Weight = Cone.GetWeight(i);
+        TotalWeight += Weight;
+        if (Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit)
+            AddConeHit(Datum.OutHits[0].GetActor(), Weight);
+    }
+    ConeTraces.Reset();
+    if (TotalWeight > 0.f) // otherwise keep the previous weights
+        FinishAttention(TotalWeight);
+}
+
+void AEgoSensor::TraceConeNow(const ECollisionChannel TraceChannel)
+{
+    ensure(World != nullptr);
+    FVector Start, End;
+    ComputeGazeRay(DReyeVR::Gaze::COMBINED, Start, End);
+    const float TraceLen = MaxTraceLenM * 100.f; // convert to m from cm
+    const FCollisionQueryParams TraceParam = GetGazeTraceParams();
+    if (!Cone.ComputeDirections(End - Start, ActiveConeRays))
+        return; // zero gaze
+    NewAttention.clear();
+    float TotalWeight = 0.f;
+    for (int i = 0; i < ActiveConeRays; i++)
+    {
+        FHitResult Hit(EForceInit::ForceInit);
+        const float Weight = Cone.GetWeight(i);
+        TotalWeight += Weight;
+        if (World->LineTraceSingleByChannel(Hit, Start, Start + TraceLen * Cone.GetDirection(i), TraceChannel,
+                                            TraceParam))
+            AddConeHit(Hit.GetActor(), Weight);
+    }
+    FinishAttention(TotalWeight);
+}
+
+void AEgoSensor::ComputeBoxAttention()
+{
+    FVector Start, End;
+    ComputeGazeRay(DReyeVR::Gaze::COMBINED, Start, End);
+    const float TraceLen = MaxTraceLenM * 100.f; // convert to m from cm
+    if (!Cone.ComputeDirections(End - Start, ActiveConeRays))
+        return; // zero gaze
+    NewAttention.clear();
+    float TotalWeight = 0.f;
+    for (int i = 0; i < ActiveConeRays; i++)
+    {
+        DReyeVR::ActorBoxIndex::Hit Hit;
+        const float Weight = Cone.GetWeight(i);
+        TotalWeight += Weight;
+        if (ActorIndex.Raycast(Start, Start + TraceLen * Cone.GetDirection(i), Hit))
+            AddConeHit(GetIndexedActor(Hit.Id), Weight);
+    }
+    FinishAttention(TotalWeight);
+}
+
+void AEgoSensor::AddConeHit(AActor *Actor, float Weight)
+{
+    if (Actor == nullptr)
+        return;
+    // only a handful of actors are ever in the cone so a linear search is fine
+    auto It = std::find_if(NewAttention.begin(), NewAttention.end(),
+                           [Actor](const DReyeVR::ActorAttention &A) { return A.Actor.Get() == Actor; });
+    if (It == NewAttention.end())
+    {
+        NewAttention.emplace_back();
+        It = std::prev(NewAttention.end());
+        It->Actor = Actor;
+        It->ActorNameTag = GetActorNameTag(Actor);
+    }
+    It->Weight += Weight;
+}
+
+void AEgoSensor::FinishAttention(float TotalWeight)
+{
+    for (DReyeVR::ActorAttention &A : NewAttention)
+        A.Weight /= TotalWeight; // the rays that hit nothing make up the rest
+    std::sort(NewAttention.begin(), NewAttention.end(),
+              [](const DReyeVR::ActorAttention &A, const DReyeVR::ActorAttention &B) { return A.Weight > B.Weight; });
+    std::swap(Attention, NewAttention);
+}
+
 /// ========================================== ///
 /// ---------------:EGOVARS:------------------ ///
 /// ========================================== ///
@@ -401,53 +857,72 @@ void AEgoSensor::ConstructFrameCapture()
 {
     if (bCaptureFrameData)
     {
-        // Frame capture
-        CaptureRenderTarget = CreateDefaultSubobject<UTextureRenderTarget2D>(TEXT("CaptureRenderTarget_DReyeVR"));
-        CaptureRenderTarget->CompressionSettings = TextureCompressionSettings::TC_Default;
-        CaptureRenderTarget->SRGB = false;
-        CaptureRenderTarget->bAutoGenerateMips = false;
-        CaptureRenderTarget->bGPUSharedFlag = true;
-        CaptureRenderTarget->ClearColor = FLinearColor::Black;
-        CaptureRenderTarget->UpdateResourceImmediate(true);
-        // CaptureRenderTarget->OverrideFormat = EPixelFormat::PF_FloatRGB;
-        CaptureRenderTarget->AddressX = TextureAddress::TA_Clamp;
-        CaptureRenderTarget->AddressY = TextureAddress::TA_Clamp;
-        CaptureRenderTarget->InitCustomFormat(FrameCapWidth, FrameCapHeight, PF_B8G8R8A8, bFrameCapForceLinearGamma);
-        check(CaptureRenderTarget->GetSurfaceWidth() > 0 && CaptureRenderTarget->GetSurfaceHeight() > 0);
+        // one capture (with its own render target & postprocessing) per recorded shader and camera pose, set up once
+        // here so the screenshots never have to swap the shaders (slow) or move the camera between captures
+        if (GetNumberOfShaders() == 0)
+            InitShaderFactory();
+        const int NumShaders = bRecordAllShaders ? GetNumberOfShaders() : 1;
+        const int NumPoses = bRecordAllPoses ? AEgoVehicle::GetCameraPoseNames().size() : 1;
+        for (int i = 0; i < NumShaders; i++)
+        {
+            // apply postprocessing effects
+            const FPostProcessSettings PostProcessing = CreatePostProcessingEffect(i);
+            for (int j = 0; j < NumPoses; j++)
+            {
+                FrameCapView View;
+                View.Shader = i;
+                View.Pose = j;
+                const FString Suffix = FString::Printf(TEXT("_s%d_p%d"), i, j);
 
-        FrameCap = CreateDefaultSubobject<USceneCaptureComponent2D>(TEXT("FrameCap"));
-        FrameCap->SetupAttachment(Camera);
-        FrameCap->PrimitiveRenderMode = ESceneCapturePrimitiveRenderMode::PRM_RenderScenePrimitives;
-        FrameCap->bCaptureOnMovement = false;
-        FrameCap->bCaptureEveryFrame = false;
-        FrameCap->bAlwaysPersistRenderingState = true;
-        FrameCap->CaptureSource = ESceneCaptureSource::SCS_FinalColorLDR;
+                View.RenderTarget = CreateDefaultSubobject<UTextureRenderTarget2D>(
+                    FName(*(FString("CaptureRenderTarget_DReyeVR") + Suffix)));
+                View.RenderTarget->CompressionSettings = TextureCompressionSettings::TC_Default;
+                View.RenderTarget->SRGB = false;
+                View.RenderTarget->bAutoGenerateMips = false;
+                View.RenderTarget->bGPUSharedFlag = true;
+                View.RenderTarget->ClearColor = FLinearColor::Black;
+                View.RenderTarget->UpdateResourceImmediate(true);
+                // View.RenderTarget->OverrideFormat = EPixelFormat::PF_FloatRGB;
+                View.RenderTarget->AddressX = TextureAddress::TA_Clamp;
+                View.RenderTarget->AddressY = TextureAddress::TA_Clamp;
+                View.RenderTarget->InitCustomFormat(FrameCapWidth, FrameCapHeight, PF_B8G8R8A8,
+                                                   bFrameCapForceLinearGamma);
+                check(View.RenderTarget->GetSurfaceWidth() > 0 && View.RenderTarget->GetSurfaceHeight() > 0);
 
-        // apply postprocessing effects
-        FrameCap->PostProcessSettings = CreatePostProcessingEffect(0);
+                View.Capture = CreateDefaultSubobject<USceneCaptureComponent2D>(FName(*(FString("FrameCap") + Suffix)));
+                View.Capture->SetupAttachment(Camera);
+                View.Capture->PrimitiveRenderMode = ESceneCapturePrimitiveRenderMode::PRM_RenderScenePrimitives;
+                View.Capture->bCaptureOnMovement = false;
+                View.Capture->bCaptureEveryFrame = false;
+                View.Capture->bAlwaysPersistRenderingState = true;
+                View.Capture->CaptureSource = ESceneCaptureSource::SCS_FinalColorLDR;
+                View.Capture->PostProcessSettings = PostProcessing;
 
-        FrameCap->Deactivate();
-        FrameCap->TextureTarget = CaptureRenderTarget;
-        FrameCap->UpdateContent();
-        FrameCap->Activate();
-    }
-    if (FrameCap && !bCaptureFrameData)
-    {
-        FrameCap->Deactivate();
+                View.Capture->Deactivate();
+                View.Capture->TextureTarget = View.RenderTarget;
+                View.Capture->UpdateContent();
+                View.Capture->Activate();
+                FrameCapRig.Add(View);
+            }
+        }
     }
 }
 
-void AEgoSensor::InitFrameCapture()
+void AEgoSensor::InitFrameCapture(const FString &Location)
 {
     // creates the directory for the frame capture to take place
     if (bCaptureFrameData)
     {
-        // create out dir
-        /// TODO: add check for absolute paths
-        FrameCapLocation = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir() + FrameCapLocation);
-        // The returned string has the following format: yyyy.mm.dd-hh.mm.ss
-        FString DirName = FDateTime::Now().ToString(); // timestamp directory
-        FrameCapLocation = FPaths::Combine(FrameCapLocation, DirName);
+        if (Location.IsEmpty())
+        {
+            // The returned string has the following format: yyyy.mm.dd-hh.mm.ss
+            FString DirName = FDateTime::Now().ToString(); // timestamp directory
+            FrameCapLocation = FPaths::Combine(GetFrameCapBaseDir(), DirName);
+        }
+        else
+        {
+            FrameCapLocation = Location; // resuming a capture
+        }
 
         // create directory if not present
         LOG("Outputting frame capture data to %s", *FrameCapLocation);
@@ -463,13 +938,122 @@ void AEgoSensor::InitFrameCapture()
 #endif
         }
         bCreatedDirectory = true;
+        FrameReadbacks.Init(FrameReadbacksInFlight);
+        if (bFrameCapVideo)
+            Video.Open(FrameCapLocation, FrameCapFilename, VideoParams);
+    }
+}
+
+FString AEgoSensor::GetFrameCapBaseDir() const
+{
+    // relative to the project unless absolute
+    if (FPaths::IsRelative(FrameCapDir))
+        return FPaths::ConvertRelativePathToFull(FPaths::ProjectDir() + FrameCapDir);
+    return FrameCapDir;
+}
+
+FString AEgoSensor::GetFramePath(const FString &Location, const FString &Name, int Shader, int Pose, size_t FrameIdx,
+                                 bool bJPG)
+{
+    // using 5 digits to reach frame 99999 ~ 30m (assuming ~50fps frame capture)
+    // suffix is denoted as _s(hader)X_p(ose)Y_Z.jpg where X is the shader idx, Y is the pose idx,
+    // Z is tick (the image write queue replaces any other extension with the one of the format)
+    const FString Suffix = FString::Printf(TEXT("_s%d_p%d_%05d%s"), Shader, Pose, int(FrameIdx),
+                                           bJPG ? TEXT(".jpg") : TEXT(".png"));
+    return FPaths::Combine(Location, Name + Suffix);
+}
+
+FString AEgoSensor::GetFramePath(const FString &Location, int Shader, int Pose, size_t FrameIdx) const
+{
+    return GetFramePath(Location, FrameCapFilename, Shader, Pose, FrameIdx, bFileFormatJPG);
+}
+
+void AEgoSensor::WriteFrame(TArray<FColor> &&Pixels, const FIntPoint &Size, const FString &FilePath, bool bJPG,
+                            TSharedPtr<DReyeVR::CaptureManifest> Manifest, size_t FrameIdx)
+{
+    auto OnWritten = [FilePath, Manifest, FrameIdx](bool bSuccess) {
+        if (Manifest.IsValid())
+            Manifest->OutputWritten(FrameIdx, bSuccess, bSuccess ? IFileManager::Get().FileSize(*FilePath) : -1);
+    };
+    WriteFrameToDisk(MoveTemp(Pixels), Size, FilePath, bJPG, MoveTemp(OnWritten));
+}
+
+int64_t AEgoSensor::GetFrameBytesOnDisk(const FString &Location, size_t FrameIdx) const
+{
+    int64_t Bytes = 0;
+    for (const FrameCapView &View : FrameCapRig)
+    {
+        const int64 FileSize = IFileManager::Get().FileSize(*GetFramePath(Location, View.Shader, View.Pose, FrameIdx));
+        if (FileSize < 0)
+            return -1;
+        Bytes += FileSize;
+    }
+    return Bytes;
+}
+
+FString AEgoSensor::GetFrameCaptureConfig() const
+{
+    return FString::Printf(TEXT("FrameName=%s;FrameWidth=%d;FrameHeight=%d;FileFormatJPG=%d;LinearGamma=%d;"
+                                "RecordAllShaders=%d;RecordAllPoses=%d;Views=%d"),
+                           *FrameCapFilename, FrameCapWidth, FrameCapHeight, int(bFileFormatJPG),
+                           int(bFrameCapForceLinearGamma), int(bRecordAllShaders), int(bRecordAllPoses),
+                           FrameCapRig.Num());
+}
+
+FString AEgoSensor::FindResumableCapture(const DReyeVR::CaptureManifest::Header &Header)
+{
+    // the latest capture in FrameCapDir of the same recording & settings (the directories are timestamps)
+    const FString BaseDir = GetFrameCapBaseDir();
+    TArray<FString> Dirs;
+    IFileManager::Get().FindFiles(Dirs, *FPaths::Combine(BaseDir, TEXT("*")), false, true);
+    Dirs.Sort([](const FString &A, const FString &B) { return A > B; }); // newest first
+    for (const FString &Dir : Dirs)
+    {
+        const FString Location = FPaths::Combine(BaseDir, Dir);
+        auto IsOnDisk = [this, &Location](size_t FrameIdx, int64_t Bytes) {
+            return GetFrameBytesOnDisk(Location, FrameIdx) == Bytes;
+        };
+        if (Manifest->Load(FPaths::Combine(Location, TEXT("manifest.csv")), Header, IsOnDisk))
+            return Location;
     }
+    return "";
 }
 
-void AEgoSensor::TakeScreenshot()
+size_t AEgoSensor::BeginFrameCapture(const std::string &RecordingFile, size_t FirstFrameIdx)
+{
+    if (!bCaptureFrameData)
+        return FirstFrameIdx;
+    if (bFrameCapVideo)
+    {
+        // the videos are only playable once they are finished, so there is nothing to resume
+        if (bResumeCapture)
+            LOG_WARN("ResumeCapture needs FrameSink=\"images\", starting a new frame capture");
+        return FirstFrameIdx;
+    }
+
+    DReyeVR::CaptureManifest::Header Header;
+    Header.Recording = UTF8_TO_TCHAR(RecordingFile.c_str());
+    Header.RecordingHash = LexToString(FMD5Hash::HashFile(*Header.Recording));
+    Header.Config = GetFrameCaptureConfig();
+    if (!Manifest.IsValid() || !Manifest->GetHeader().Matches(Header))
+    {
+        // every recording gets its own capture (the frames are numbered within the recording)
+        Manifest = MakeShared<DReyeVR::CaptureManifest>();
+        InitFrameCapture(bResumeCapture ? FindResumableCapture(Header) : FString(""));
+        Manifest->Open(FPaths::Combine(FrameCapLocation, TEXT("manifest.csv")), Header);
+    }
+    const size_t FrameIdx = Manifest->FirstMissing(FirstFrameIdx);
+    if (FrameIdx > FirstFrameIdx)
+        LOG("Resuming the frame capture in %s at frame %d (%d frames done)", *FrameCapLocation, int(FrameIdx),
+            int(Manifest->Num()));
+    return FrameIdx;
+}
+
+void AEgoSensor::TakeScreenshot(uint64_t RecorderFrameId, size_t FrameIdx)
 {
     /// NOTE: this is a slow function that takes multiple high-res screenshots (with different shader params)
-    // of the current scene and writes the images to disk immediately. The intention is to use this function
+    // of the current scene and writes the images to disk once they are read back from the GPU (see
+    // DReyeVR::FrameReadback, only up to FrameReadbacks of them are in flight). The intention is to use this function
     // during synchronized replay with screen capture so that performance is not an issue since the simulator
     // is not necessarily running in real-time.
 
@@ -480,44 +1064,58 @@ void AEgoSensor::TakeScreenshot()
     }
 
     // capture the screenshot to the directory
-    if (bCaptureFrameData && FrameCap && Camera && Vehicle)
+    if (bCaptureFrameData && FrameCapRig.Num() > 0 && Camera && Vehicle)
     {
-        for (int i = 0; i < GetNumberOfShaders(); i++)
+        // numbered by the frame in the recording, so the shards of a sharded replay line up
+        ScreenshotCount = FrameIdx;
+        if (Manifest.IsValid() && Manifest->IsComplete(FrameIdx))
+            return; // already on disk (resumed capture)
+
+        // the camera view (relative to the camera root) is the same in every pose, only the root is elsewhere
+        FMinimalViewInfo DesiredView;
+        Camera->GetCameraView(0, DesiredView);
+        const FTransform CameraRelative = Camera->GetRelativeTransform();
+        for (const FrameCapView &View : FrameCapRig)
+        {
+            // apply the camera view (position & orientation) of this pose, without moving the vehicle camera
+            const FTransform PoseView = CameraRelative * Vehicle->GetCameraRootPoseWorld(View.Pose);
+            DesiredView.Location = PoseView.GetLocation();
+            DesiredView.Rotation = PoseView.Rotator();
+            View.Capture->SetCameraView(DesiredView);
+            View.Capture->CaptureSceneDeferred(); // rendered with all the others just below
+        }
+        // render all the views back to back in one batch of render commands (instead of one CaptureScene per view)
+        USceneCaptureComponent::UpdateDeferredCaptures(World->Scene);
+
+        // save the screenshots once they are read back from the GPU
+        if (Manifest.IsValid())
+            Manifest->BeginFrame(FrameIdx, RecorderFrameId, FrameCapRig.Num());
+        for (const FrameCapView &View : FrameCapRig)
         {
-            // apply the postprocessing effect
-            FrameCap->PostProcessSettings = CreatePostProcessingEffect(i);
-            // loop through all camera poses
-            for (int j = 0; j < Vehicle->GetNumCameraPoses(); j++)
+            const int i = View.Shader;
+            const int j = View.Pose;
+            if (bFrameCapVideo)
             {
-                // set this pose
-                Vehicle->SetCameraRootPose(j);
-
-                // using 5 digits to reach frame 99999 ~ 30m (assuming ~50fps frame capture)
-                // suffix is denoted as _s(hader)X_p(ose)Y_Z.png where X is the shader idx, Y is the pose idx, Z is tick
-                const FString Suffix = FString::Printf(TEXT("_s%d_p%d_%05d.png"), i, j, ScreenshotCount);
-                // apply the camera view (position & orientation)
-                FMinimalViewInfo DesiredView;
-                Camera->GetCameraView(0, DesiredView);
-                FrameCap->SetCameraView(DesiredView); // move camera to the Camera view
-                // capture the scene and save the screenshot to disk
-                FrameCap->CaptureScene(); // also available: CaptureSceneDeferred()
-                SaveFrameToDisk(*CaptureRenderTarget, FPaths::Combine(FrameCapLocation, FrameCapFilename + Suffix),
-                                bFileFormatJPG);
-                if (!bRecordAllPoses)
-                {
-                    // exit after the first camera pose (seated)
-                    break;
-                }
+                // appended to the video of this shader & pose
+                const int64_t Tick = ScreenshotCount;
+                const int64_t TimestampCarla = GetData()->GetTimestampCarla();
+                FrameReadbacks.Enqueue(*View.RenderTarget, [this, i, j, RecorderFrameId, Tick, TimestampCarla](
+                                                               TArray<FColor> &&Pixels, const FIntPoint &Size) {
+                    Video.AddFrame(i, j, MoveTemp(Pixels), Size, RecorderFrameId, Tick, TimestampCarla);
+                });
             }
-            // set camera pose back to 0
-            Vehicle->SetCameraRootPose(0);
-            if (!bRecordAllShaders)
+            else
             {
-                // exit after the first shader (rgb)
-                break;
+                const FString FilePath = GetFramePath(FrameCapLocation, i, j, ScreenshotCount);
+                const bool bJPG = bFileFormatJPG;
+                // the frame goes into the manifest once all of its images are written
+                TSharedPtr<DReyeVR::CaptureManifest> FrameManifest = Manifest;
+                FrameReadbacks.Enqueue(*View.RenderTarget, [FilePath, bJPG, FrameManifest, FrameIdx](
+                                                               TArray<FColor> &&Pixels, const FIntPoint &Size) {
+                    WriteFrame(MoveTemp(Pixels), Size, FilePath, bJPG, FrameManifest, FrameIdx);
+                });
             }
         }
-        ScreenshotCount++; // progress to next frame
     }
 }
 
@@ -1,10 +1,21 @@
 #pragma once
 
+#include "Carla/Sensor/DReyeVRActorIndex.h"     // DReyeVR::ActorBoxIndex
 #include "Carla/Sensor/DReyeVRData.h"           // DReyeVR namespace
+#include "Carla/Sensor/DReyeVRRingBuffer.h"     // DReyeVR::SPSCRing
 #include "Carla/Sensor/DReyeVRSensor.h"         // ADReyeVRSensor
+#include "CaptureManifest.h"                    // DReyeVR::CaptureManifest
 #include "Components/SceneCaptureComponent2D.h" // USceneCaptureComponent2D
+#include "FixationDetector.h"                   // DReyeVR::FixationDetector
+#include "FrameReadback.h"                      // DReyeVR::FrameReadback
+#include "GazeCone.h"                           // DReyeVR::GazeCone
+#include "VideoCapture.h"                       // DReyeVR::VideoCapture
+#include "WorldCollision.h"                     // FTraceHandle
+#include <atomic>                               // std::atomic
 #include <chrono>                               // timing threads
 #include <cstdint>
+#include <thread>                               // std::thread
+#include <vector>
 
 #if USE_SRANIPAL_PLUGIN
 
@@ -43,8 +54,20 @@ class CARLAUE4_API AEgoSensor : public ADReyeVRSensor
     void UpdateData(const DReyeVR::CustomActorData &RecorderData, const double Per) override;
 
     // function where replayer requests a screenshot
-    void TakeScreenshot() override;
-    bool ComputeGazeTrace(FHitResult &Hit, const ECollisionChannel TraceChannel, float TraceRadius = 0.f) const;
+    size_t BeginFrameCapture(const std::string &RecordingFile, size_t FirstFrameIdx) override;
+    void TakeScreenshot(uint64_t RecorderFrameId, size_t FrameIdx) override;
+    // screenshot file of a shader & pose, its extension follows the image format (as the image write queue's does)
+    static FString GetFramePath(const FString &Location, const FString &Name, int Shader, int Pose, size_t FrameIdx,
+                                bool bJPG);
+    // writes a screenshot and adds its size on disk to the frame in Manifest (if any) once it is written
+    static void WriteFrame(TArray<FColor> &&Pixels, const FIntPoint &Size, const FString &FilePath, bool bJPG,
+                           TSharedPtr<DReyeVR::CaptureManifest> Manifest, size_t FrameIdx);
+    bool ComputeGazeTrace(FHitResult &Hit, const ECollisionChannel TraceChannel, float TraceRadius = 0.f,
+                          DReyeVR::Gaze Index = DReyeVR::Gaze::COMBINED) const;
+    // latest focus of each gaze (only the combined one is recorded, the eyes are traced if TraceEachEye)
+    const DReyeVR::FocusInfo &GetFocusInfo(DReyeVR::Gaze Index = DReyeVR::Gaze::COMBINED) const;
+    // current fixation (as of the latest eye tracker sample), for gaze-contingent logic
+    const DReyeVR::FixationDetector &GetFixationDetector() const;
 
   protected:
     void BeginPlay();
@@ -59,12 +82,37 @@ class CARLAUE4_API AEgoSensor : public ADReyeVRSensor
     ////////////////:EYETRACKER:////////////////
     void InitEyeTracker();
     void DestroyEyeTracker();
-    void ComputeDummyEyeData(); // when no hardware sensor is present
-    void TickEyeTracker();      // tick hardware sensor
+    void ComputeDummyEyeData(DReyeVR::EyeTracker &Sample, int64_t Sequence); // when no hardware sensor is present
+    void SampleEyeTracker(DReyeVR::EyeTracker &Sample, int64_t Sequence);    // query hardware sensor
+    void TickEyeTracker();                                                   // collect the samples for this tick
     void ComputeFocusInfo();
     void ComputeTraceFocusInfo(const ECollisionChannel TraceChannel, float TraceRadius = 0.f);
+    void ComputeGazeRay(DReyeVR::Gaze Index, FVector &Start, FVector &End) const; // world space, MaxTraceLenM long
+    FCollisionQueryParams GetGazeTraceParams() const;
+    void UpdateFocusInfo(DReyeVR::FocusInfo &Focus, const FHitResult &Hit, bool bDidHit, int64_t SampleTimestamp) const;
     float MaxTraceLenM = 100.f;        // maximum trace length in m
     bool bDrawDebugFocusTrace = false; // draw the trace ray and hit point or not
+    bool bTraceEachEye = false;        // trace the left and right gazes too (not just the combined one)
+
+    // asynchronous gaze traces: issued on one tick and collected on the next, off the game thread's critical path
+    void IssueGazeTraces(const ECollisionChannel TraceChannel, float TraceRadius = 0.f);
+    void CollectGazeTraces(); // results of the traces issued on the previous tick
+    struct PendingGazeTrace
+    {
+        FTraceHandle Handle;         // invalid if nothing is pending
+        int64_t SampleTimestamp = 0; // TimestampDevice of the eye tracker sample that was traced
+        FVector Start, End;
+    };
+    bool bAsyncFocusTrace = true;               // false to trace synchronously (the focus is then of this tick)
+    PendingGazeTrace PendingGazeTraces[3];      // indexed by DReyeVR::Gaze
+    struct DReyeVR::FocusInfo FocusInfoData[3]; // focus computed from each eye gaze, indexed by DReyeVR::Gaze
+
+    // physics-free focus: the gaze is intersected with the bounding boxes of the actors instead of traced
+    void UpdateActorIndex(); // from the transforms of the actors in the registry
+    void ComputeBoxFocusInfo();
+    class AActor *GetIndexedActor(uint32 Id) const;
+    bool bBoundingBoxFocus = false;    // use the actor bounding boxes (no async traces, the focus is of this tick)
+    DReyeVR::ActorBoxIndex ActorIndex; // by carla actor id
     float ComputeVergence(const FVector &L0, const FVector &LDir, const FVector &R0, const FVector &RDir) const;
 #if USE_SRANIPAL_PLUGIN
     SRanipalEye_Core *SRanipal;               // SRanipalEye_Core.h
@@ -72,24 +120,67 @@ class CARLAUE4_API AEgoSensor : public ADReyeVRSensor
     ViveSR::anipal::Eye::EyeData EyeData;     // SRanipal_Eyes_Enums.h
     bool bSRanipalEnabled;                    // Whether or not the framework has been loaded
 #endif
-    struct DReyeVR::EyeTracker EyeSensorData;                           // data from eye tracker
-    struct DReyeVR::FocusInfo FocusInfoData;                            // data from the focus computed from eye gaze
+    struct DReyeVR::EyeTracker EyeSensorData;                           // data from eye tracker (latest sample)
     std::chrono::time_point<std::chrono::system_clock> ChronoStartTime; // std::chrono time at BeginPlay
 
+    // asynchronous eye tracker sampling (independent of the game tick rate)
+    void StartEyeSampler();
+    void StopEyeSampler();
+    void RunEyeSampler();                        // sampler thread loop
+    float EyeSampleRateHz = 120.f;               // 0 to sample once per tick on the game thread instead
+    std::thread EyeSamplerThread;                // polls the eye tracker at EyeSampleRateHz
+    std::atomic<bool> bEyeSamplerRunning{false}; // sampler thread is (or should keep) running
+    std::atomic<uint64_t> DroppedEyeSamples{0};  // samples lost because the queue was full
+    // samples handed from the sampler thread to the game thread (~2s of headroom at 120Hz)
+    DReyeVR::SPSCRing<DReyeVR::EyeTracker, 256> EyeSampleQueue;
+    // fixations/saccades detected on every sample as it is collected (recorded and streamed as gaze events)
+    bool bDetectFixations = true;
+    DReyeVR::FixationDetector Fixations;
+
+    ////////////////:ATTENTION:////////////////
+    // per-actor attention weights from a cone of rays around the gaze (traced like the focus, async or not)
+    void ComputeAttention(const ECollisionChannel TraceChannel);
+    void IssueConeTraces(const ECollisionChannel TraceChannel);
+    void CollectConeTraces(); // results of the traces issued on the previous tick
+    void TraceConeNow(const ECollisionChannel TraceChannel);
+    void ComputeBoxAttention(); // with the actor bounding boxes (BoundingBoxFocus)
+    void AddConeHit(class AActor *Actor, float Weight);
+    void FinishAttention(float TotalWeight); // normalize the weights and sort them
+    DReyeVR::GazeCone Cone;
+    int GazeConeRays = 0;          // rays in the cone (0 to disable the attention weights)
+    float GazeConeDeg = 5.f;       // half angle of the cone in degrees
+    float GazeConeBudgetMs = 0.5f; // game thread time per tick, the number of rays adapts to it (not with async traces)
+    int ActiveConeRays = 0;        // the first ActiveConeRays samples of the cone are traced
+    TArray<FTraceHandle> ConeTraces;                   // issued on the previous tick, one per cone sample
+    std::vector<DReyeVR::ActorAttention> Attention;    // latest attention weights (largest first)
+    std::vector<DReyeVR::ActorAttention> NewAttention; // being accumulated
+
     ////////////////:EGOVARS:////////////////
     void ComputeEgoVars();
     class AEgoVehicle *Vehicle;           // the DReyeVR EgoVehicle
     struct DReyeVR::EgoVariables EgoVars; // data from vehicle that is getting tracked
 
     ////////////////:FRAMECAPTURE:////////////////
-    void ConstructFrameCapture(); // needs to be called in the constructor
-    void InitFrameCapture();      // needs to be called in BeginPlay
-    size_t ScreenshotCount = 0;
+    void ConstructFrameCapture();                     // needs to be called in the constructor
+    void InitFrameCapture(const FString &Location = ""); // new (timestamped) output directory unless given
+    FString GetFrameCapBaseDir() const;               // absolute FrameCapDir
+    FString GetFramePath(const FString &Location, int Shader, int Pose, size_t FrameIdx) const; // of this capture
+    int64_t GetFrameBytesOnDisk(const FString &Location, size_t FrameIdx) const; // all shaders & poses, -1 if missing
+    FString GetFrameCaptureConfig() const; // settings the outputs depend on (a resumed capture must match them)
+    FString FindResumableCapture(const DReyeVR::CaptureManifest::Header &Header); // loads its manifest
+    size_t ScreenshotCount = 0; // index of the frame being captured in the recording
     class UCameraComponent *Camera; // for frame capture views
-    class UTextureRenderTarget2D *CaptureRenderTarget = nullptr;
-    class USceneCaptureComponent2D *FrameCap = nullptr;
-    FString FrameCapLocation; // relative to game dir
-    FString FrameCapFilename; // gets ${tick}.png suffix
+    struct FrameCapView
+    {
+        class USceneCaptureComponent2D *Capture = nullptr;
+        class UTextureRenderTarget2D *RenderTarget = nullptr;
+        int Shader = 0; // index into the ShaderFactory
+        int Pose = 0;   // index into the EgoVehicle camera poses
+    };
+    TArray<FrameCapView> FrameCapRig; // every recorded shader & pose, captured together on each screenshot
+    FString FrameCapDir;      // relative to game dir (or absolute)
+    FString FrameCapLocation; // output directory of this capture (in FrameCapDir)
+    FString FrameCapFilename; // gets _s{shader}_p{pose}_{tick}.jpg (or .png) suffix
     int FrameCapWidth;
     int FrameCapHeight;
     bool bCaptureFrameData;
@@ -98,6 +189,14 @@ class CARLAUE4_API AEgoSensor : public ADReyeVRSensor
     bool bCreatedDirectory = false;
     bool bFileFormatJPG = true;
     bool bFrameCapForceLinearGamma = true;
+    int FrameReadbacksInFlight = 4;    // captures being read back from the GPU at once (0 to wait for each one)
+    DReyeVR::FrameReadback FrameReadbacks;
+    bool bFrameCapVideo = false; // one video per shader/pose instead of one image file per screenshot
+    DReyeVR::VideoCapture::Params VideoParams;
+    DReyeVR::VideoCapture Video;
+    bool bResumeCapture = false; // continue the latest matching capture (its manifest) rather than starting over
+    // frames on disk, shared with the write callbacks that complete them (which may outlive the sensor)
+    TSharedPtr<DReyeVR::CaptureManifest> Manifest;
 
     ////////////////:FOVEATEDRENDER:////////////////
     void TickFoveatedRender();
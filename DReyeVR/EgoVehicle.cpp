@@ -253,14 +253,7 @@ void AEgoVehicle::ConstructCameraRoot()
     VRCameraRoot->SetRelativeLocation(FVector::ZeroVector);
     VRCameraRoot->SetRelativeRotation(FRotator::ZeroRotator);
 
-    // taking this names directly from the [CameraPose] params in DReyeVRConfig.ini
-    std::vector<FString> CameraPoses = {
-        "DriversSeat",  // 1st
-        "ThirdPerson",  // 2nd
-        "BirdsEyeView", // 3rd
-        "Front",        // 4th
-    };
-    for (FString &Key : CameraPoses)
+    for (const FString &Key : GetCameraPoseNames())
     {
         FVector Location;
         FRotator Rotation;
@@ -295,11 +288,34 @@ void AEgoVehicle::SetCameraRootPose(const FString &CameraPoseName)
     SetCameraRootPose(CameraPoseTransform);
 }
 
+const std::vector<FString> &AEgoVehicle::GetCameraPoseNames()
+{
+    // taking this names directly from the [CameraPose] params in DReyeVRConfig.ini
+    static const std::vector<FString> CameraPoses = {
+        "DriversSeat",  // 1st
+        "ThirdPerson",  // 2nd
+        "BirdsEyeView", // 3rd
+        "Front",        // 4th
+    };
+    return CameraPoses;
+}
+
 size_t AEgoVehicle::GetNumCameraPoses() const
 {
     return CameraTransforms.size();
 }
 
+FTransform AEgoVehicle::GetCameraRootPoseWorld(size_t CameraPoseIdx) const
+{
+    // where the camera root would be (in world space) in this pose, without moving it there
+    CameraPoseIdx = std::min(CameraPoseIdx, CameraTransforms.size() - 1);
+    const FTransform &Pose = CameraTransforms[CameraPoseIdx].second;
+    const FTransform Relative(Pose.Rotator() + CameraPoseOffset.Rotator(),
+                              Pose.GetLocation() + CameraPoseOffset.GetLocation(), VRCameraRoot->GetRelativeScale3D());
+    const USceneComponent *Parent = VRCameraRoot->GetAttachParent();
+    return Parent != nullptr ? Relative * Parent->GetComponentTransform() : Relative;
+}
+
 void AEgoVehicle::SetCameraRootPose(size_t CameraPoseIdx)
 {
     // allow setting the camera root by indexing into CameraTransforms array
@@ -71,6 +71,8 @@ class CARLAUE4_API AEgoVehicle : public ACarlaWheeledVehicle
     void SetCameraRootPose(const FString &PoseName); // index into named FTransform
     void SetCameraRootPose(size_t PoseIdx);          // index into ordered FTransform
     const FTransform &GetCameraRootPose() const;
+    static const std::vector<FString> &GetCameraPoseNames(); // in pose index order
+    FTransform GetCameraRootPoseWorld(size_t PoseIdx) const; // camera root of this pose (world space), not applied
     void NextCameraView();
     void PrevCameraView();
 
@@ -0,0 +1,266 @@
+#include "FixationDetector.h"
+
+namespace DReyeVR
+{
+
+static float AngleDeg(const FVector &A, const FVector &B)
+{
+    // atan2 stays accurate for the tiny angles between consecutive samples, unlike acos of the dot product
+    return FMath::RadiansToDegrees(
+        FMath::Atan2(FVector::CrossProduct(A, B).Size(), FMath::Clamp(FVector::DotProduct(A, B), -1.f, 1.f)));
+}
+
+void FixationDetector::Init(const Params &InParams)
+{
+    Settings = InParams;
+    Settings.MinFixationMs = FMath::Max(Settings.MinFixationMs, 0.f);
+    Settings.MaxGapMs = FMath::Max(Settings.MaxGapMs, 0.f);
+    Reset();
+}
+
+void FixationDetector::Reset()
+{
+    bHasPrev = false;
+    ClearWindow();
+    bInFixation = false;
+    bSaccadeValid = false;
+    SaccadePeakVelocity = 0.f;
+}
+
+void FixationDetector::AddSample(const EyeTracker &Sample, std::vector<GazeEvent> &Out)
+{
+    const int64_t T = Sample.TimestampDevice;
+    const bool bValid = Sample.Combined.GazeValid && !Sample.Combined.GazeDir.IsNearlyZero();
+
+    // a gap (eyes closed, tracking lost, or the stream restarted) breaks the current fixation and the saccade since
+    if (bHasPrev && (T - PrevTimestamp > Settings.MaxGapMs || T < PrevTimestamp))
+    {
+        Interrupt(T, Out);
+        bHasPrev = false;
+    }
+    if (!bValid || (bHasPrev && T == PrevTimestamp)) // invalid or repeated sample
+        return;
+
+    WindowSample S;
+    S.Timestamp = T;
+    S.Dir = Sample.Combined.GazeDir.GetUnsafeNormal();
+    S.Yaw = FMath::RadiansToDegrees(FMath::Atan2(S.Dir.Y, S.Dir.X));
+    S.Pitch = FMath::RadiansToDegrees(FMath::Atan2(S.Dir.Z, FVector2D(S.Dir.X, S.Dir.Y).Size()));
+
+    // angular velocity (deg/s) from the previous valid sample, unknown right after a gap
+    const float Velocity = bHasPrev ? AngleDeg(PrevDir, S.Dir) * 1000.f / (T - PrevTimestamp) : 0.f;
+
+    if (Settings.Algorithm == Method::IVT)
+        AddIVT(S, Velocity, Out);
+    else
+        AddIDT(S, Out);
+
+    if (!bInFixation)
+        SaccadePeakVelocity = FMath::Max(SaccadePeakVelocity, Velocity);
+
+    bHasPrev = true;
+    PrevTimestamp = T;
+    PrevDir = S.Dir;
+}
+
+FVector FixationDetector::GetFixationCentroid() const
+{
+    return bInFixation ? FixationSum.GetSafeNormal() : FVector::ZeroVector;
+}
+
+float FixationDetector::GetFixationDurationMs() const
+{
+    return bInFixation ? float(FixationLast - FixationStart) : 0.f;
+}
+
+void FixationDetector::AddIVT(const WindowSample &S, float Velocity, std::vector<GazeEvent> &Out)
+{
+    if (Velocity > Settings.VelocityThresholdDeg)
+    {
+        if (bInFixation)
+            EndFixation(S.Timestamp, Out);
+        ClearWindow();
+        return;
+    }
+    if (bInFixation)
+    {
+        FixationLast = S.Timestamp;
+        FixationLastDir = S.Dir;
+        FixationSum += S.Dir;
+        FixationMinYaw = FMath::Min(FixationMinYaw, S.Yaw);
+        FixationMaxYaw = FMath::Max(FixationMaxYaw, S.Yaw);
+        FixationMinPitch = FMath::Min(FixationMinPitch, S.Pitch);
+        FixationMaxPitch = FMath::Max(FixationMaxPitch, S.Pitch);
+        return;
+    }
+    PushWindow(S);
+    if (WindowDurationMs() >= Settings.MinFixationMs)
+        StartFixation(S.Timestamp, Out);
+}
+
+void FixationDetector::AddIDT(const WindowSample &S, std::vector<GazeEvent> &Out)
+{
+    if (bInFixation)
+    {
+        const float MinYawS = FMath::Min(FixationMinYaw, S.Yaw), MaxYawS = FMath::Max(FixationMaxYaw, S.Yaw);
+        const float MinPitchS = FMath::Min(FixationMinPitch, S.Pitch);
+        const float MaxPitchS = FMath::Max(FixationMaxPitch, S.Pitch);
+        if ((MaxYawS - MinYawS) + (MaxPitchS - MinPitchS) <= Settings.DispersionThresholdDeg)
+        {
+            FixationLast = S.Timestamp;
+            FixationLastDir = S.Dir;
+            FixationSum += S.Dir;
+            FixationMinYaw = MinYawS;
+            FixationMaxYaw = MaxYawS;
+            FixationMinPitch = MinPitchS;
+            FixationMaxPitch = MaxPitchS;
+            return;
+        }
+        EndFixation(S.Timestamp, Out);
+    }
+    // the candidate is the longest run of the latest samples that is compact enough
+    PushWindow(S);
+    while (WindowDispersion() > Settings.DispersionThresholdDeg)
+        PopWindow();
+    if (WindowDurationMs() >= Settings.MinFixationMs)
+        StartFixation(S.Timestamp, Out);
+}
+
+void FixationDetector::MonotonicQueue::Push(uint64_t InSeq, float InValue, bool bMin)
+{
+    while (Count > 0)
+    {
+        const float Back = Value[(Head + Count - 1) % WindowSize];
+        if (bMin ? Back < InValue : Back > InValue)
+            break;
+        Count--;
+    }
+    const int Tail = (Head + Count) % WindowSize;
+    Seq[Tail] = InSeq;
+    Value[Tail] = InValue;
+    Count++;
+}
+
+void FixationDetector::MonotonicQueue::PopIfFront(uint64_t InSeq)
+{
+    if (Count > 0 && Seq[Head] == InSeq)
+    {
+        Head = (Head + 1) % WindowSize;
+        Count--;
+    }
+}
+
+void FixationDetector::PushWindow(const WindowSample &S)
+{
+    if (WindowNextSeq - WindowFirstSeq == WindowSize)
+        PopWindow();
+    const uint64_t Seq = WindowNextSeq++;
+    Window[Seq % WindowSize] = S;
+    WindowSum += S.Dir;
+    MinYaw.Push(Seq, S.Yaw, true);
+    MaxYaw.Push(Seq, S.Yaw, false);
+    MinPitch.Push(Seq, S.Pitch, true);
+    MaxPitch.Push(Seq, S.Pitch, false);
+}
+
+void FixationDetector::PopWindow()
+{
+    const uint64_t Seq = WindowFirstSeq++;
+    WindowSum -= Window[Seq % WindowSize].Dir;
+    MinYaw.PopIfFront(Seq);
+    MaxYaw.PopIfFront(Seq);
+    MinPitch.PopIfFront(Seq);
+    MaxPitch.PopIfFront(Seq);
+}
+
+void FixationDetector::ClearWindow()
+{
+    WindowFirstSeq = WindowNextSeq;
+    WindowSum = FVector::ZeroVector;
+    MinYaw.Clear();
+    MaxYaw.Clear();
+    MinPitch.Clear();
+    MaxPitch.Clear();
+}
+
+float FixationDetector::WindowDispersion() const
+{
+    if (WindowNextSeq == WindowFirstSeq)
+        return 0.f;
+    return (MaxYaw.Front() - MinYaw.Front()) + (MaxPitch.Front() - MinPitch.Front());
+}
+
+float FixationDetector::WindowDurationMs() const
+{
+    if (WindowNextSeq == WindowFirstSeq)
+        return 0.f;
+    return float(Window[(WindowNextSeq - 1) % WindowSize].Timestamp - Window[WindowFirstSeq % WindowSize].Timestamp);
+}
+
+void FixationDetector::StartFixation(int64_t DetectedAt, std::vector<GazeEvent> &Out)
+{
+    const WindowSample &First = Window[WindowFirstSeq % WindowSize];
+    const WindowSample &Last = Window[(WindowNextSeq - 1) % WindowSize];
+
+    if (bSaccadeValid)
+    {
+        GazeEvent Saccade;
+        Saccade.Type = GazeEventType::Saccade;
+        Saccade.TimestampDevice = SaccadeStart;
+        Saccade.DetectedAt = DetectedAt;
+        Saccade.DurationMs = float(First.Timestamp - SaccadeStart);
+        Saccade.Amplitude = AngleDeg(SaccadeStartDir, First.Dir);
+        Saccade.PeakVelocity = SaccadePeakVelocity;
+        Out.push_back(Saccade);
+    }
+
+    bInFixation = true;
+    FixationStart = First.Timestamp;
+    FixationLast = Last.Timestamp;
+    FixationLastDir = Last.Dir;
+    FixationSum = WindowSum;
+    FixationMinYaw = MinYaw.Front();
+    FixationMaxYaw = MaxYaw.Front();
+    FixationMinPitch = MinPitch.Front();
+    FixationMaxPitch = MaxPitch.Front();
+    bSaccadeValid = false;
+    ClearWindow();
+
+    GazeEvent Start;
+    Start.Type = GazeEventType::FixationStart;
+    Start.TimestampDevice = FixationStart;
+    Start.DetectedAt = DetectedAt;
+    Start.DurationMs = GetFixationDurationMs();
+    Start.Centroid = GetFixationCentroid();
+    Start.Amplitude = (FixationMaxYaw - FixationMinYaw) + (FixationMaxPitch - FixationMinPitch);
+    Out.push_back(Start);
+}
+
+void FixationDetector::EndFixation(int64_t DetectedAt, std::vector<GazeEvent> &Out)
+{
+    GazeEvent End;
+    End.Type = GazeEventType::FixationEnd;
+    End.TimestampDevice = FixationStart;
+    End.DetectedAt = DetectedAt;
+    End.DurationMs = GetFixationDurationMs();
+    End.Centroid = GetFixationCentroid();
+    End.Amplitude = (FixationMaxYaw - FixationMinYaw) + (FixationMaxPitch - FixationMinPitch);
+    Out.push_back(End);
+
+    bInFixation = false;
+    bSaccadeValid = true;
+    SaccadeStart = FixationLast;
+    SaccadeStartDir = FixationLastDir;
+    SaccadePeakVelocity = 0.f;
+}
+
+void FixationDetector::Interrupt(int64_t DetectedAt, std::vector<GazeEvent> &Out)
+{
+    if (bInFixation)
+        EndFixation(DetectedAt, Out);
+    bSaccadeValid = false;
+    SaccadePeakVelocity = 0.f;
+    ClearWindow();
+}
+
+}; // namespace DReyeVR
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Carla/Sensor/DReyeVRData.h" // DReyeVR::EyeTracker, DReyeVR::GazeEvent
+#include "CoreMinimal.h"
+
+#include <cstdint>
+#include <vector>
+
+// Online fixation/saccade classification of the eye tracker samples (as they are collected by AEgoSensor).
+//
+// Both classic algorithms are available, working on the combined gaze direction:
+// - I-VT (velocity threshold): a sample is saccadic if the angular velocity of the gaze from the previous sample is
+//   over VelocityThresholdDeg, and the runs of the other samples are fixations.
+// - I-DT (dispersion threshold): a fixation is a run of samples whose dispersion, (max - min) yaw + (max - min) pitch
+//   in degrees, is under DispersionThresholdDeg.
+// Either way a fixation is only reported once it has lasted MinFixationMs, and the movement between two fixations is
+// reported as a saccade (unless the eyes were closed or lost in between, i.e. no valid sample for more than MaxGapMs).
+//
+// Every sample is O(1) work: a fixation only keeps running sums and bounds, and the window of the fixation candidate
+// (at most MinFixationMs long) is a fixed-size ring with monotonic queues for its sliding min/max.
+
+namespace DReyeVR
+{
+
+class FixationDetector
+{
+  public:
+    enum class Method : uint8_t
+    {
+        IVT,
+        IDT,
+    };
+    struct Params
+    {
+        Method Algorithm = Method::IVT;
+        float VelocityThresholdDeg = 30.f;  // I-VT (deg/s)
+        float DispersionThresholdDeg = 1.f; // I-DT (deg)
+        float MinFixationMs = 100.f;
+        float MaxGapMs = 100.f; // longer runs of invalid samples (blinks, tracking loss) end the fixation
+    };
+
+    void Init(const Params &InParams);
+    void Reset();
+
+    // classifies the next sample (in timestamp order) and appends the events it completes to Out
+    void AddSample(const EyeTracker &Sample, std::vector<GazeEvent> &Out);
+
+    // the current fixation, e.g. for gaze-contingent logic
+    bool IsInFixation() const
+    {
+        return bInFixation;
+    }
+    FVector GetFixationCentroid() const;
+    float GetFixationDurationMs() const;
+
+  private:
+    struct WindowSample
+    {
+        int64_t Timestamp;
+        FVector Dir;
+        float Yaw, Pitch; // degrees
+    };
+    // the fixation candidate, at most MinFixationMs of samples (the oldest are dropped if it ever fills up)
+    static constexpr int WindowSize = 256;
+
+    // sliding extremum of one coordinate of the window: the samples that can still become the min (max), increasing
+    // (decreasing) in value, by their sequence number
+    struct MonotonicQueue
+    {
+        uint64_t Seq[WindowSize];
+        float Value[WindowSize];
+        int Head = 0;
+        int Count = 0;
+        void Clear()
+        {
+            Head = Count = 0;
+        }
+        void Push(uint64_t InSeq, float InValue, bool bMin);
+        void PopIfFront(uint64_t InSeq);
+        float Front() const
+        {
+            return Value[Head];
+        }
+    };
+
+    void AddIVT(const WindowSample &S, float Velocity, std::vector<GazeEvent> &Out);
+    void AddIDT(const WindowSample &S, std::vector<GazeEvent> &Out);
+    void PushWindow(const WindowSample &S);
+    void PopWindow();
+    void ClearWindow();
+    float WindowDispersion() const;
+    float WindowDurationMs() const;
+    void StartFixation(int64_t DetectedAt, std::vector<GazeEvent> &Out);
+    void EndFixation(int64_t DetectedAt, std::vector<GazeEvent> &Out);
+    void Interrupt(int64_t DetectedAt, std::vector<GazeEvent> &Out); // gap in the data
+
+    Params Settings;
+
+    // previous valid sample
+    bool bHasPrev = false;
+    int64_t PrevTimestamp = 0;
+    FVector PrevDir = FVector::ZeroVector;
+
+    // candidate window
+    WindowSample Window[WindowSize];
+    uint64_t WindowFirstSeq = 0; // sequence number of the oldest sample in the window
+    uint64_t WindowNextSeq = 0;
+    FVector WindowSum = FVector::ZeroVector;
+    MonotonicQueue MinYaw, MaxYaw, MinPitch, MaxPitch;
+
+    // current fixation
+    bool bInFixation = false;
+    int64_t FixationStart = 0, FixationLast = 0;
+    FVector FixationSum = FVector::ZeroVector;
+    FVector FixationLastDir = FVector::ZeroVector;
+    float FixationMinYaw = 0.f, FixationMaxYaw = 0.f, FixationMinPitch = 0.f, FixationMaxPitch = 0.f;
+
+    // movement since the last fixation ended
+    bool bSaccadeValid = false; // false if there was no fixation before or the data had a gap since
+    int64_t SaccadeStart = 0;
+    FVector SaccadeStartDir = FVector::ZeroVector;
+    float SaccadePeakVelocity = 0.f;
+};
+
+}; // namespace DReyeVR
@@ -0,0 +1,137 @@
+#include "FrameReadback.h"
+
+#include "DReyeVRUtils.h"                   // ReadFramePixels
+#include "Engine/TextureRenderTarget2D.h"   // UTextureRenderTarget2D
+#include "RenderingThread.h"                // ENQUEUE_RENDER_COMMAND, FlushRenderingCommands
+#include "TextureResource.h"                // FTextureRenderTargetResource
+
+namespace DReyeVR
+{
+
+FrameReadback::~FrameReadback()
+{
+    // the render commands point to this and its slots (a Check can be queued after the last slot was collected)
+    if (InFlight.Num() > 0 || PendingChecks.load(std::memory_order_acquire) > 0)
+        FlushRenderingCommands();
+}
+
+void FrameReadback::Init(int NumInFlight)
+{
+    if (Slots.Num() > 0)
+    {
+        Flush();
+        FlushRenderingCommands(); // nothing refers to the old slots anymore
+        Slots.Empty();
+    }
+    for (int i = 0; i < NumInFlight; i++)
+    {
+        Slots.Add(MakeUnique<Slot>());
+        Slots.Last()->Readback = MakeUnique<FRHIGPUTextureReadback>(TEXT("DReyeVRFrameReadback"));
+    }
+}
+
+void FrameReadback::Enqueue(UTextureRenderTarget2D &RenderTarget, PixelsCallback &&OnPixels)
+{
+    if (Slots.Num() == 0)
+    {
+        TArray<FColor> Pixels;
+        if (ReadFramePixels(RenderTarget, Pixels))
+            OnPixels(MoveTemp(Pixels), FIntPoint(RenderTarget.GetSurfaceWidth(), RenderTarget.GetSurfaceHeight()));
+        return;
+    }
+    FTextureRenderTargetResource *RTResource = RenderTarget.GameThread_GetRenderTargetResource();
+    if (RTResource == nullptr)
+    {
+        LOG_ERROR("Missing render target!");
+        return;
+    }
+
+    // all the staging textures are in flight: wait for the oldest one (the GPU is the bottleneck)
+    Collect();
+    while (InFlight.Num() == Slots.Num())
+    {
+        Check(true);
+        FlushRenderingCommands();
+        Collect();
+    }
+
+    int32 Index = 0;
+    while (Slots[Index]->bInFlight)
+        Index++;
+    Slot *S = Slots[Index].Get();
+    S->bInFlight = true;
+    S->OnPixels = MoveTemp(OnPixels);
+    S->Size = FIntPoint(RenderTarget.GetSurfaceWidth(), RenderTarget.GetSurfaceHeight());
+    InFlight.Add(Index);
+
+    // right after the capture's own render commands, so the next capture can reuse the render target
+    ENQUEUE_RENDER_COMMAND(DReyeVRFrameReadbackCopy)
+    ([S, RTResource](FRHICommandListImmediate &RHICmdList) {
+        S->Readback->EnqueueCopy(RHICmdList, RTResource->GetRenderTargetTexture());
+        S->bCopying = true;
+    });
+    // and pick up the earlier copies that are done by then
+    Check(false);
+}
+
+void FrameReadback::Poll()
+{
+    Collect();
+    if (InFlight.Num() > 0)
+        Check(false);
+}
+
+void FrameReadback::Flush()
+{
+    while (InFlight.Num() > 0)
+    {
+        Check(true);
+        FlushRenderingCommands();
+        Collect();
+    }
+    if (PendingChecks.load(std::memory_order_acquire) > 0)
+        FlushRenderingCommands();
+}
+
+void FrameReadback::Collect()
+{
+    // in capture order, so the frames are written in the order they were taken
+    while (InFlight.Num() > 0 && Slots[InFlight[0]]->bReady.load(std::memory_order_acquire))
+    {
+        Slot &S = *Slots[InFlight[0]];
+        InFlight.RemoveAt(0);
+        S.bReady.store(false, std::memory_order_relaxed);
+        S.bInFlight = false;
+        PixelsCallback OnPixels = MoveTemp(S.OnPixels);
+        OnPixels(MoveTemp(S.Pixels), S.Size);
+    }
+}
+
+void FrameReadback::Check(const bool bWait)
+{
+    PendingChecks.fetch_add(1, std::memory_order_relaxed);
+    ENQUEUE_RENDER_COMMAND(DReyeVRFrameReadbackCheck)
+    ([this, bWait](FRHICommandListImmediate &RHICmdList) {
+        if (bWait)
+            RHICmdList.BlockUntilGPUIdle();
+        for (TUniquePtr<Slot> &S : Slots)
+        {
+            if (!S->bCopying || !S->Readback->IsReady())
+                continue;
+            // the rows of the staging texture can be padded
+            void *Data = nullptr;
+            int32 RowPitch = 0; // in pixels
+            S->Readback->LockTexture(RHICmdList, Data, RowPitch);
+            const FColor *Rows = static_cast<const FColor *>(Data);
+            S->Pixels.SetNumUninitialized(S->Size.X * S->Size.Y);
+            for (int32 Y = 0; Y < S->Size.Y; Y++)
+                FMemory::Memcpy(S->Pixels.GetData() + Y * S->Size.X, Rows + Y * RowPitch, S->Size.X * sizeof(FColor));
+            S->Readback->Unlock();
+            S->bCopying = false;
+            S->bReady.store(true, std::memory_order_release);
+        }
+        PendingChecks.fetch_sub(1, std::memory_order_release);
+    });
+}
+
+}; // namespace DReyeVR
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"    // TArray, FColor, FIntPoint, TFunction
+#include "RHIGPUReadback.h" // FRHIGPUTextureReadback
+
+#include <atomic>
+
+// Pipelined GPU -> CPU readback of the replay frame captures (see AEgoSensor::TakeScreenshot).
+//
+// Reading the pixels of the render target right after every capture (FTextureRenderTargetResource::ReadPixels)
+// flushes the rendering commands and waits for the GPU each time. Instead, every capture is copied into one of a few
+// staging textures on the render thread (in order with the captures, so the single render target can be reused right
+// away) and the copies are picked up once the GPU is done with them, on a later capture or tick, and handed to the
+// frame's sink (the image write queue or a video stream). The game thread only waits when all the staging textures are
+// still in flight.
+
+namespace DReyeVR
+{
+
+class FrameReadback
+{
+  public:
+    ~FrameReadback();
+
+    // NumInFlight staging textures (0 to read the pixels back synchronously)
+    void Init(int NumInFlight);
+
+    // after the scene was captured into RenderTarget: OnPixels gets its pixels once they are back (on the game thread,
+    // in capture order)
+    using PixelsCallback = TFunction<void(TArray<FColor> &&Pixels, const FIntPoint &Size)>;
+    void Enqueue(class UTextureRenderTarget2D &RenderTarget, PixelsCallback &&OnPixels);
+    // hands the completed readbacks to their callbacks (never waits)
+    void Poll();
+    // waits for all the readbacks in flight (and the render commands that still refer to this)
+    void Flush();
+
+  private:
+    struct Slot
+    {
+        TUniquePtr<FRHIGPUTextureReadback> Readback;
+        FIntPoint Size = FIntPoint::ZeroValue;
+        // game thread
+        bool bInFlight = false;
+        PixelsCallback OnPixels;
+        // render thread, until bReady is set (then the game thread takes the pixels)
+        bool bCopying = false;
+        TArray<FColor> Pixels;
+        std::atomic<bool> bReady{false};
+    };
+
+    void Collect(); // game thread: hands over the ready slots, oldest first
+    void Check(bool bWait); // enqueues a render command that reads back the copies that are done (or all, if bWait)
+
+    TArray<TUniquePtr<Slot>> Slots;      // stable addresses for the render commands
+    TArray<int32> InFlight;              // indices of the slots in flight, oldest first
+    std::atomic<int32> PendingChecks{0}; // Check render commands not run yet (they can outlive InFlight)
+};
+
+}; // namespace DReyeVR
@@ -0,0 +1,91 @@
+#include "GazeCone.h"
+
+#include "Math/RandomStream.h" // FRandomStream
+
+namespace DReyeVR
+{
+
+void GazeCone::Init(int InNumRays, float HalfAngleDeg, int32 Seed)
+{
+    NumRays = FMath::Max(InNumRays, 0);
+    const int Padded = Align(NumRays, 4);
+    OffsetX.Init(0.f, Padded);
+    OffsetY.Init(0.f, Padded);
+    DirX.Init(0.f, Padded);
+    DirY.Init(0.f, Padded);
+    DirZ.Init(0.f, Padded);
+    Weights.Init(0.f, NumRays);
+    if (NumRays == 0)
+        return;
+
+    // best-candidate Poisson disc on the unit disc (the candidate farthest from all the previous samples is kept)
+    constexpr int NumCandidates = 32;
+    FRandomStream Random(Seed);
+    TArray<FVector2D> Points;
+    Points.Reserve(NumRays);
+    Points.Add(FVector2D::ZeroVector); // the gaze ray itself
+    while (Points.Num() < NumRays)
+    {
+        FVector2D Best = FVector2D::ZeroVector;
+        float BestDistSq = -1.f;
+        for (int c = 0; c < NumCandidates; c++)
+        {
+            // uniform on the disc
+            const float R = FMath::Sqrt(Random.GetFraction());
+            const float Theta = 2.f * PI * Random.GetFraction();
+            const FVector2D Candidate(R * FMath::Cos(Theta), R * FMath::Sin(Theta));
+            float DistSq = TNumericLimits<float>::Max();
+            for (const FVector2D &Point : Points)
+                DistSq = FMath::Min(DistSq, FVector2D::DistSquared(Point, Candidate));
+            if (DistSq > BestDistSq)
+            {
+                BestDistSq = DistSq;
+                Best = Candidate;
+            }
+        }
+        Points.Add(Best);
+    }
+
+    const float Scale = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(HalfAngleDeg, 0.f, 89.f)));
+    for (int i = 0; i < NumRays; i++)
+    {
+        OffsetX[i] = Scale * Points[i].X;
+        OffsetY[i] = Scale * Points[i].Y;
+        // gaussian falloff with a sigma of half the cone: exp(-r^2 / (2 * 0.5^2))
+        Weights[i] = FMath::Exp(-2.f * Points[i].SizeSquared());
+    }
+}
+
+bool GazeCone::ComputeDirections(const FVector &GazeDir, int Count)
+{
+    // a zero gaze has no perpendicular axes and the reciprocal length of every ray would be infinite (NaN directions)
+    if (GazeDir.IsNearlyZero())
+        return false;
+
+    // Dir = Gaze + X * U + Y * V (normalized) where U and V are perpendicular to the gaze
+    const FVector G = GazeDir.GetSafeNormal();
+    FVector U, V;
+    G.FindBestAxisVectors(U, V);
+    const VectorRegister Gx = VectorSetFloat1(G.X), Gy = VectorSetFloat1(G.Y), Gz = VectorSetFloat1(G.Z);
+    const VectorRegister Ux = VectorSetFloat1(U.X), Uy = VectorSetFloat1(U.Y), Uz = VectorSetFloat1(U.Z);
+    const VectorRegister Vx = VectorSetFloat1(V.X), Vy = VectorSetFloat1(V.Y), Vz = VectorSetFloat1(V.Z);
+
+    Count = FMath::Clamp(Count, 0, NumRays);
+    // the arrays are padded to a multiple of 4 (the padding has no offset so it is just the gaze)
+    for (int i = 0; i < Count; i += 4)
+    {
+        const VectorRegister X = VectorLoadAligned(OffsetX.GetData() + i);
+        const VectorRegister Y = VectorLoadAligned(OffsetY.GetData() + i);
+        const VectorRegister Dx = VectorMultiplyAdd(Y, Vx, VectorMultiplyAdd(X, Ux, Gx));
+        const VectorRegister Dy = VectorMultiplyAdd(Y, Vy, VectorMultiplyAdd(X, Uy, Gy));
+        const VectorRegister Dz = VectorMultiplyAdd(Y, Vz, VectorMultiplyAdd(X, Uz, Gz));
+        const VectorRegister LenSq = VectorMultiplyAdd(Dz, Dz, VectorMultiplyAdd(Dy, Dy, VectorMultiply(Dx, Dx)));
+        const VectorRegister InvLen = VectorReciprocalSqrtAccurate(LenSq);
+        VectorStoreAligned(VectorMultiply(Dx, InvLen), DirX.GetData() + i);
+        VectorStoreAligned(VectorMultiply(Dy, InvLen), DirY.GetData() + i);
+        VectorStoreAligned(VectorMultiply(Dz, InvLen), DirZ.GetData() + i);
+    }
+    return true;
+}
+
+}; // namespace DReyeVR
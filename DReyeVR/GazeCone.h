@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h" // FVector, TArray, VectorRegister
+
+// Foveal gaze cone sampling (for the per-actor attention weights, see AEgoSensor::ComputeAttention).
+//
+// The cone is covered by a fixed pattern of offsets on a Poisson disc, generated once with Mitchell's best-candidate
+// algorithm and starting with the gaze ray itself. Every prefix of such a pattern is also well spread, so the sampler
+// can use fewer rays to stay within its time budget without leaving holes in the cone. Each sample also has a foveal
+// weight (a gaussian falloff with its angle from the gaze) so the center of the cone counts more than its edge.
+//
+// The ray directions are computed in SoA layout, 4 rays at a time with the UE4 vector intrinsics.
+
+namespace DReyeVR
+{
+
+class GazeCone
+{
+  public:
+    // NumRays samples within HalfAngleDeg of the gaze
+    void Init(int NumRays, float HalfAngleDeg, int32 Seed = 0);
+
+    int Num() const
+    {
+        return NumRays;
+    }
+    float GetWeight(int Index) const
+    {
+        return Weights[Index];
+    }
+
+    // world-space unit directions of the first Count samples around GazeDir (which need not be normalized), false
+    // (and the directions are left as they were) if GazeDir is (nearly) zero, e.g. from an invalid gaze sample
+    bool ComputeDirections(const FVector &GazeDir, int Count);
+    FVector GetDirection(int Index) const
+    {
+        return FVector(DirX[Index], DirY[Index], DirZ[Index]);
+    }
+
+  private:
+    using AlignedFloats = TArray<float, TAlignedHeapAllocator<16>>;
+
+    int NumRays = 0;
+    // offsets on the disc (scaled by the tangent of the half angle) and the computed directions, each padded to a
+    // multiple of 4 elements
+    AlignedFloats OffsetX, OffsetY;
+    AlignedFloats DirX, DirY, DirZ;
+    TArray<float> Weights;
+};
+
+}; // namespace DReyeVR
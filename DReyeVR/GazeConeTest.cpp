@@ -0,0 +1,40 @@
+#include "GazeCone.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Run with "Automation RunTests DReyeVR.GazeCone" (editor console or -ExecCmds)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDReyeVRGazeConeZeroGazeTest, "DReyeVR.GazeCone.ZeroGaze",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDReyeVRGazeConeZeroGazeTest::RunTest(const FString &Parameters)
+{
+    // not a multiple of 4, so the padding rays are computed too
+    DReyeVR::GazeCone Cone;
+    Cone.Init(30, 5.f);
+
+    // an invalid sample before any valid one
+    TestFalse(TEXT("Zero gaze has no cone"), Cone.ComputeDirections(FVector::ZeroVector, Cone.Num()));
+    for (int i = 0; i < Cone.Num(); i++)
+        TestFalse(TEXT("Direction is not NaN"), Cone.GetDirection(i).ContainsNaN());
+
+    // an invalid sample after a valid one keeps its directions
+    const FVector Gaze(1.f, 2.f, 0.5f);
+    TestTrue(TEXT("Gaze has a cone"), Cone.ComputeDirections(Gaze, Cone.Num()));
+    TestFalse(TEXT("Zero gaze has no cone"), Cone.ComputeDirections(FVector::ZeroVector, Cone.Num()));
+    TestFalse(TEXT("Nearly zero gaze has no cone"), Cone.ComputeDirections(FVector(1e-6f, 0.f, 0.f), Cone.Num()));
+    const float MaxAngle = FMath::DegreesToRadians(5.f) + KINDA_SMALL_NUMBER;
+    for (int i = 0; i < Cone.Num(); i++)
+    {
+        const FVector Dir = Cone.GetDirection(i);
+        TestFalse(TEXT("Direction is not NaN"), Dir.ContainsNaN());
+        TestTrue(TEXT("Direction is normalized"), Dir.IsNormalized());
+        TestTrue(TEXT("Direction is in the cone"),
+                 FMath::Acos(FMath::Clamp(Dir | Gaze.GetSafeNormal(), -1.f, 1.f)) <= MaxAngle);
+    }
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,144 @@
+#include "VideoCapture.h"
+
+#include "Misc/Paths.h" // FPaths
+
+#if PLATFORM_WINDOWS
+#define DREYEVR_POPEN _popen
+#define DREYEVR_PCLOSE _pclose
+#define DREYEVR_POPEN_MODE "wb"
+#else
+#define DREYEVR_POPEN popen
+#define DREYEVR_PCLOSE pclose
+#define DREYEVR_POPEN_MODE "w"
+#endif
+
+namespace DReyeVR
+{
+
+VideoCapture::~VideoCapture()
+{
+    Close();
+}
+
+void VideoCapture::Open(const FString &InDir, const FString &InBaseName, const Params &InParams)
+{
+    Close();
+    Dir = InDir;
+    BaseName = InBaseName;
+    Settings = InParams;
+    bStopping = false;
+    bOpen = true;
+    Writer = std::thread(&VideoCapture::Run, this);
+}
+
+void VideoCapture::AddFrame(int Shader, int Pose, TArray<FColor> &&Pixels, const FIntPoint &Size,
+                            uint64_t RecorderFrameId, int64_t Tick, int64_t TimestampCarla)
+{
+    if (!bOpen)
+        return;
+    std::unique_lock<std::mutex> Lock(Mutex);
+    // the encoders are the bottleneck: wait for them instead of piling up frames
+    QueueChanged.wait(Lock, [this] { return Queue.size() < MaxQueued; });
+    Queue.push_back(Frame{Shader, Pose, MoveTemp(Pixels), Size, RecorderFrameId, Tick, TimestampCarla});
+    QueueChanged.notify_all();
+}
+
+void VideoCapture::Close()
+{
+    if (!bOpen)
+        return;
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        bStopping = true;
+    }
+    QueueChanged.notify_all();
+    if (Writer.joinable())
+        Writer.join();
+    bOpen = false;
+}
+
+void VideoCapture::Run()
+{
+    while (true)
+    {
+        Frame F;
+        {
+            std::unique_lock<std::mutex> Lock(Mutex);
+            QueueChanged.wait(Lock, [this] { return !Queue.empty() || bStopping; });
+            if (Queue.empty())
+                break; // stopping, and everything was written
+            F = MoveTemp(Queue.front());
+            Queue.pop_front();
+        }
+        QueueChanged.notify_all();
+        Write(F);
+    }
+    for (auto &It : Streams)
+        CloseStream(It.second);
+    Streams.clear();
+}
+
+void VideoCapture::Write(Frame &F)
+{
+    Stream &S = Streams[std::make_pair(F.Shader, F.Pose)];
+    if (S.bFailed || (S.Pipe == nullptr && !OpenStream(S, F)))
+        return;
+    if (F.Size != S.Size)
+    {
+        LOG_ERROR("Frame capture size changed (%dx%d -> %dx%d), dropping the frame", S.Size.X, S.Size.Y, F.Size.X,
+                  F.Size.Y);
+        return;
+    }
+    const size_t Bytes = F.Pixels.Num() * sizeof(FColor);
+    if (fwrite(F.Pixels.GetData(), 1, Bytes, S.Pipe) != Bytes)
+    {
+        LOG_ERROR("Video encoder for shader %d pose %d stopped accepting frames", F.Shader, F.Pose);
+        CloseStream(S);
+        S.bFailed = true;
+        return;
+    }
+    S.Index << S.NumFrames++ << "," << F.RecorderFrameId << "," << F.Tick << "," << F.TimestampCarla << "\n";
+}
+
+bool VideoCapture::OpenStream(Stream &S, const Frame &F)
+{
+    // depth/segmentation/... values are data, not images: never compress them lossily
+    const bool bLossless = Settings.bLosslessAll || F.Shader != 0;
+    const FString Name = FString::Printf(TEXT("%s_s%d_p%d"), *BaseName, F.Shader, F.Pose);
+    const FString VideoPath = FPaths::Combine(Dir, Name + (bLossless ? TEXT(".mkv") : TEXT(".mp4")));
+    const FString Codec = bLossless ? FString(TEXT("-c:v ffv1 -level 3 -pix_fmt bgr0"))
+                                    : FString::Printf(TEXT("-c:v libx264 -preset veryfast -crf %d -pix_fmt yuv420p"),
+                                                      FMath::Clamp(Settings.Quality, 0, 51));
+    const FString Command = FString::Printf(
+        TEXT("\"%s\" -hide_banner -loglevel error -y -f rawvideo -pix_fmt bgra -s %dx%d -r %g -i - %s \"%s\""),
+        *Settings.Encoder, F.Size.X, F.Size.Y, Settings.FrameRate, *Codec, *VideoPath);
+
+    S.Pipe = DREYEVR_POPEN(TCHAR_TO_UTF8(*Command), DREYEVR_POPEN_MODE);
+    if (S.Pipe == nullptr)
+    {
+        LOG_ERROR("Unable to start the video encoder: %s", *Command);
+        S.bFailed = true;
+        return false;
+    }
+    S.Size = F.Size;
+    S.Index.open(TCHAR_TO_UTF8(*FPaths::Combine(Dir, Name + TEXT(".csv"))));
+    S.Index << "video_frame,recorder_frame,tick,timestamp_carla\n";
+    LOG("Encoding the frame capture to %s", *VideoPath);
+    return true;
+}
+
+void VideoCapture::CloseStream(Stream &S)
+{
+    if (S.Pipe != nullptr)
+    {
+        // the encoder finishes the file once its input is closed
+        const int Status = DREYEVR_PCLOSE(S.Pipe);
+        if (Status != 0)
+            LOG_ERROR("Video encoder exited with status %d", Status);
+        S.Pipe = nullptr;
+    }
+    if (S.Index.is_open())
+        S.Index.close();
+}
+
+}; // namespace DReyeVR
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CoreMinimal.h" // FString, TArray, FColor, FIntPoint
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio> // FILE
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// Video sink for the replay frame capture (see AEgoSensor::TakeScreenshot with FrameSink="video").
+//
+// Instead of one image file per shader/pose/tick, the frames of every (shader, pose) are streamed into their own video,
+// encoded by a local ffmpeg process that reads the raw BGRA frames from a pipe: H.264 (libx264) for the RGB shader and
+// FFV1 (lossless) for the others, e.g. depth and semantic segmentation whose pixel values must survive as-is (or for
+// every stream with VideoLossless). Each video has a sidecar CSV mapping its frame index to the recorder frame id, the
+// capture tick and the CARLA timestamp of the replayed frame.
+//
+// The frames are handed over to a writer thread (at most MaxQueued of them, after which AddFrame waits) so the game
+// thread never blocks on the encoders.
+
+namespace DReyeVR
+{
+
+class VideoCapture
+{
+  public:
+    struct Params
+    {
+        FString Encoder = "ffmpeg"; // executable, in the PATH or an absolute path
+        float FrameRate = 30.f;     // nominal, the sidecar has the actual timestamps
+        int Quality = 18;           // x264 CRF (0-51, lower is better)
+        bool bLosslessAll = false;  // FFV1 for the RGB stream too
+    };
+    ~VideoCapture();
+
+    void Open(const FString &Dir, const FString &BaseName, const Params &InParams);
+    bool IsOpen() const
+    {
+        return bOpen;
+    }
+    void AddFrame(int Shader, int Pose, TArray<FColor> &&Pixels, const FIntPoint &Size, uint64_t RecorderFrameId,
+                  int64_t Tick, int64_t TimestampCarla);
+    // finishes every video (waits for the encoders)
+    void Close();
+
+  private:
+    struct Frame
+    {
+        int Shader, Pose;
+        TArray<FColor> Pixels;
+        FIntPoint Size;
+        uint64_t RecorderFrameId;
+        int64_t Tick;
+        int64_t TimestampCarla;
+    };
+    struct Stream // writer thread only
+    {
+        FILE *Pipe = nullptr; // stdin of the encoder
+        FIntPoint Size;
+        std::ofstream Index; // sidecar
+        uint64_t NumFrames = 0;
+        bool bFailed = false;
+    };
+    static constexpr size_t MaxQueued = 8;
+
+    void Run(); // writer thread
+    void Write(Frame &F);
+    bool OpenStream(Stream &S, const Frame &F);
+    void CloseStream(Stream &S);
+
+    FString Dir, BaseName;
+    Params Settings;
+    bool bOpen = false;
+
+    std::thread Writer;
+    std::mutex Mutex;
+    std::condition_variable QueueChanged;
+    std::deque<Frame> Queue;
+    bool bStopping = false;
+
+    std::map<std::pair<int, int>, Stream> Streams; // by (shader, pose)
+};
+
+}; // namespace DReyeVR
@@ -0,0 +1,206 @@
+#include "carla/sensor/DReyeVRSharedMemory.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace carla
+{
+    namespace sensor
+    {
+        DReyeVRSharedMemory::~DReyeVRSharedMemory()
+        {
+            Unmap();
+        }
+
+        bool DReyeVRSharedMemory::Map(const std::string &SegmentName, size_t Size, bool bWrite)
+        {
+            Name = SegmentName;
+            bOwner = bWrite;
+#ifdef _WIN32
+            HANDLE Mapping = nullptr;
+            if (bWrite)
+            {
+                const uint64_t Size64 = Size;
+                Mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, DWORD(Size64 >> 32),
+                                             DWORD(Size64 & 0xffffffff), Name.c_str());
+            }
+            else
+            {
+                Mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, Name.c_str());
+            }
+            if (Mapping == nullptr)
+                return false;
+            void *View = MapViewOfFile(Mapping, bWrite ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, Size);
+            if (View == nullptr)
+            {
+                CloseHandle(Mapping);
+                return false;
+            }
+            if (Size == 0)
+            {
+                // readers map the whole segment
+                MEMORY_BASIC_INFORMATION Info;
+                VirtualQuery(View, &Info, sizeof(Info));
+                Size = Info.RegionSize;
+            }
+            Handle = Mapping;
+            Memory = static_cast<unsigned char *>(View);
+#else
+            const std::string Path = "/" + Name;
+            const int Fd = bWrite ? shm_open(Path.c_str(), O_CREAT | O_RDWR, 0644) : shm_open(Path.c_str(), O_RDONLY, 0);
+            if (Fd < 0)
+                return false;
+            if (bWrite && ftruncate(Fd, static_cast<off_t>(Size)) != 0)
+            {
+                close(Fd);
+                shm_unlink(Path.c_str());
+                return false;
+            }
+            if (!bWrite)
+            {
+                struct stat Info;
+                if (fstat(Fd, &Info) != 0)
+                {
+                    close(Fd);
+                    return false;
+                }
+                Size = static_cast<size_t>(Info.st_size);
+            }
+            void *View = mmap(nullptr, Size, bWrite ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, Fd, 0);
+            close(Fd); // the mapping stays valid
+            if (View == MAP_FAILED)
+            {
+                if (bWrite)
+                    shm_unlink(Path.c_str());
+                return false;
+            }
+            Memory = static_cast<unsigned char *>(View);
+#endif
+            MappedSize = Size;
+            return true;
+        }
+
+        void DReyeVRSharedMemory::Unmap()
+        {
+            if (Memory == nullptr)
+                return;
+#ifdef _WIN32
+            UnmapViewOfFile(Memory);
+            CloseHandle(static_cast<HANDLE>(Handle));
+            Handle = nullptr;
+#else
+            munmap(Memory, MappedSize);
+            if (bOwner)
+                shm_unlink(("/" + Name).c_str());
+#endif
+            Memory = nullptr;
+            MappedSize = 0;
+        }
+
+        DReyeVRSharedMemoryWriter::DReyeVRSharedMemoryWriter(const std::string &SegmentName, uint32_t NumSlots,
+                                                             uint32_t SlotSize)
+        {
+            if (NumSlots == 0 || SlotSize == 0)
+                return;
+            const size_t Size = sizeof(Header) + size_t(NumSlots) * SlotStride(SlotSize);
+            if (!Map(SegmentName, Size, true))
+                return;
+            std::memset(Memory, 0, Size);
+            Header *H = GetHeader();
+            H->NumSlots = NumSlots;
+            H->SlotSize = SlotSize;
+            H->Head.store(0, std::memory_order_relaxed);
+            H->Dropped.store(0, std::memory_order_relaxed);
+            H->Version = Version;
+            // readers check the magic last
+            std::atomic_thread_fence(std::memory_order_release);
+            H->Magic = Magic;
+        }
+
+        bool DReyeVRSharedMemoryWriter::Publish(const unsigned char *Data, size_t Size)
+        {
+            Header *H = GetHeader();
+            if (H == nullptr)
+                return false;
+            if (Size > H->SlotSize)
+            {
+                H->Dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            const uint64_t Index = H->Head.load(std::memory_order_relaxed);
+            SlotHeader *Slot = GetSlot(Index);
+            Slot->Seq.store(2 * Index + 1, std::memory_order_relaxed); // being written
+            std::atomic_thread_fence(std::memory_order_release);
+            Slot->Size = static_cast<uint32_t>(Size);
+            std::memcpy(reinterpret_cast<unsigned char *>(Slot) + sizeof(SlotHeader), Data, Size);
+            Slot->Seq.store(2 * Index + 2, std::memory_order_release);
+            H->Head.store(Index + 1, std::memory_order_release);
+            return true;
+        }
+
+        DReyeVRSharedMemoryReader::DReyeVRSharedMemoryReader(const std::string &SegmentName)
+        {
+            if (!Map(SegmentName, 0, false))
+                return;
+            const Header *H = GetHeader();
+            if (MappedSize < sizeof(Header) || H->Magic != Magic || H->Version != Version ||
+                MappedSize < sizeof(Header) + size_t(H->NumSlots) * SlotStride(H->SlotSize))
+            {
+                Unmap();
+                return;
+            }
+            Next = H->Head.load(std::memory_order_acquire);
+        }
+
+        bool DReyeVRSharedMemoryReader::Read(std::vector<unsigned char> &Out)
+        {
+            const Header *H = GetHeader();
+            if (H == nullptr)
+                return false;
+            while (true)
+            {
+                const uint64_t Head = H->Head.load(std::memory_order_acquire);
+                if (Next >= Head)
+                    return false;
+                if (Head - Next > H->NumSlots)
+                {
+                    // lapped by the writer
+                    NumLost += Head - Next - H->NumSlots;
+                    Next = Head - H->NumSlots;
+                }
+                const SlotHeader *Slot = GetSlot(Next);
+                const uint64_t Seq = Slot->Seq.load(std::memory_order_acquire);
+                if (Seq == 2 * Next + 2)
+                {
+                    const uint32_t Size = std::min(Slot->Size, H->SlotSize);
+                    Out.resize(Size);
+                    std::memcpy(Out.data(), reinterpret_cast<const unsigned char *>(Slot) + sizeof(SlotHeader), Size);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (Slot->Seq.load(std::memory_order_relaxed) == Seq)
+                    {
+                        Next++;
+                        return true;
+                    }
+                }
+                // overwritten (or being overwritten) by a newer message
+                NumLost++;
+                Next++;
+            }
+        }
+    } // namespace sensor
+} // namespace carla
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Local (same machine) transport for the DReyeVR sensor messages: a named shared-memory ring of fixed-size slots that
+// the sensor publishes every message into (the same bytes as the stream message, see DReyeVRSerializer.h) and that any
+// number of reader processes poll without going through the socket stack.
+//
+// Each slot is a seqlock: the writer makes its sequence odd while writing and even (2 * message index + 2) when done,
+// and readers retry/skip a slot whose sequence changed while they were copying it. The writer never waits for readers,
+// a reader that falls more than NumSlots messages behind loses the oldest ones (see GetNumLost).
+// The layout is mirrored by PythonAPI/examples/DReyeVR_shared_memory.py, bump Version when changing it.
+
+namespace carla
+{
+namespace sensor
+{
+
+class DReyeVRSharedMemory
+{
+  public:
+    static constexpr uint32_t Magic = 0x52565244; // "DRVR"
+    static constexpr uint32_t Version = 1;
+
+    struct alignas(64) Header
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t NumSlots;
+        uint32_t SlotSize;              // max message size
+        std::atomic<uint64_t> Head;     // number of messages published
+        std::atomic<uint64_t> Dropped;  // messages larger than SlotSize (not published)
+    };
+
+    struct alignas(16) SlotHeader
+    {
+        std::atomic<uint64_t> Seq;
+        uint32_t Size;
+        uint32_t Reserved;
+    };
+
+    static size_t SlotStride(uint32_t SlotSize)
+    {
+        return (sizeof(SlotHeader) + SlotSize + 63) & ~size_t(63);
+    }
+
+    DReyeVRSharedMemory(const DReyeVRSharedMemory &) = delete;
+    DReyeVRSharedMemory &operator=(const DReyeVRSharedMemory &) = delete;
+
+  protected:
+    DReyeVRSharedMemory() = default;
+    ~DReyeVRSharedMemory();
+
+    // creates (bWrite) or opens the segment, returns false on failure
+    bool Map(const std::string &Name, size_t Size, bool bWrite);
+    void Unmap();
+
+    Header *GetHeader() const
+    {
+        return reinterpret_cast<Header *>(Memory);
+    }
+    SlotHeader *GetSlot(uint64_t Index) const
+    {
+        const Header *H = GetHeader();
+        return reinterpret_cast<SlotHeader *>(Memory + sizeof(Header) + (Index % H->NumSlots) * SlotStride(H->SlotSize));
+    }
+
+    std::string Name;
+    unsigned char *Memory = nullptr;
+    size_t MappedSize = 0;
+    bool bOwner = false;
+    void *Handle = nullptr; // file mapping handle (windows only)
+};
+
+// server side (single producer)
+class DReyeVRSharedMemoryWriter : public DReyeVRSharedMemory
+{
+  public:
+    // creates the named segment (removed again when the writer is destroyed), check IsOpen
+    DReyeVRSharedMemoryWriter(const std::string &Name, uint32_t NumSlots, uint32_t SlotSize);
+
+    bool IsOpen() const
+    {
+        return Memory != nullptr;
+    }
+
+    // returns false (and counts the message as dropped) if the message does not fit in a slot
+    bool Publish(const unsigned char *Data, size_t Size);
+};
+
+// client side (any number of them, each with its own position)
+class DReyeVRSharedMemoryReader : public DReyeVRSharedMemory
+{
+  public:
+    // opens an existing segment (from its latest message on), check IsOpen
+    explicit DReyeVRSharedMemoryReader(const std::string &Name);
+
+    bool IsOpen() const
+    {
+        return Memory != nullptr;
+    }
+
+    // copies the next message to Out, returns false if there is no new message yet
+    bool Read(std::vector<unsigned char> &Out);
+
+    // messages that were overwritten before this reader got to them
+    uint64_t GetNumLost() const
+    {
+        return NumLost;
+    }
+
+  private:
+    uint64_t Next = 0;
+    uint64_t NumLost = 0;
+};
+
+} // namespace sensor
+} // namespace carla
@@ -1,10 +1,15 @@
 #pragma once
 
+#include "carla/Exception.h"
+#include "carla/geom/Vector2D.h"
 #include "carla/geom/Vector3D.h"
 #include "carla/sensor/SensorData.h"
 #include "carla/sensor/s11n/DReyeVRSerializer.h"
 
 #include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace carla
 {
@@ -15,150 +20,223 @@ namespace data
 class DReyeVREvent : public SensorData
 {
     friend s11n::DReyeVRSerializer;
+    using Serializer = s11n::DReyeVRSerializer;
 
   protected:
-    explicit DReyeVREvent(const RawData &data) : SensorData(data)
+    // the message is kept as received and the getters read the fixed-layout records in place
+    explicit DReyeVREvent(RawData &&data) : SensorData(data), Raw(std::move(data))
     {
-        InternalData = s11n::DReyeVRSerializer::DeserializeRawData(data);
     }
 
   public:
+    // an event holds every sample of a batch (several ticks when the sensor batches its stream), the getters below
+    // return the fields of the latest one
+    size_t GetNumSamples() const
+    {
+        return Serializer::View(Raw)->NumSamples;
+    }
+    // the records only hold the field groups of this mask (see the stream_fields attribute of the sensor), the getters
+    // of the other groups throw
+    uint32_t GetFieldMask() const
+    {
+        return Serializer::View(Raw)->FieldMask;
+    }
+    bool HasFields(uint32_t Mask) const
+    {
+        return (GetFieldMask() & Mask) == Mask;
+    }
+    const unsigned char *GetRecords() const
+    {
+        return Serializer::Records(Raw);
+    }
+    size_t GetRecordSize() const
+    {
+        return Serializer::RecordSize(GetFieldMask());
+    }
+
     int64_t GetTimestampCarla() const
     {
-        return InternalData.TimestampCarla;
+        return Latest<Serializer::TimestampsData>(Serializer::Timestamps).TimestampCarla;
     }
     int64_t GetTimestampDevice() const
     {
-        return InternalData.TimestampDevice;
+        return Latest<Serializer::TimestampsData>(Serializer::Timestamps).TimestampDevice;
     }
     int64_t GetFrameSequence() const
     {
-        return InternalData.FrameSequence;
+        return Latest<Serializer::TimestampsData>(Serializer::Timestamps).FrameSequence;
     }
     const geom::Vector3D &GetGazeDir() const
     {
-        return InternalData.GazeDir;
+        return Latest<Serializer::GazeData>(Serializer::Gaze).GazeDir;
     }
     const geom::Vector3D &GetGazeOrigin() const
     {
-        return InternalData.GazeOrigin;
+        return Latest<Serializer::GazeData>(Serializer::Gaze).GazeOrigin;
     }
     bool GetGazeValid() const
     {
-        return InternalData.GazeValid;
+        return Latest<Serializer::GazeData>(Serializer::Gaze).GazeValid;
     }
     float GetGazeVergence() const
     {
-        return InternalData.GazeVergence;
+        return Latest<Serializer::GazeData>(Serializer::Gaze).GazeVergence;
     }
     const geom::Vector3D &GetCameraLocation() const
     {
-        return InternalData.CameraLocation;
+        return Latest<Serializer::CameraData>(Serializer::Camera).CameraLocation;
     }
     const geom::Vector3D &GetCameraRotation() const
     {
-        return InternalData.CameraRotation;
+        return Latest<Serializer::CameraData>(Serializer::Camera).CameraRotation;
     }
     const geom::Vector3D &GetLGazeDir() const
     {
-        return InternalData.LGazeDir;
+        return Latest<Serializer::EyeData>(Serializer::LeftEye).GazeDir;
     }
     const geom::Vector3D &GetLGazeOrigin() const
     {
-        return InternalData.LGazeOrigin;
+        return Latest<Serializer::EyeData>(Serializer::LeftEye).GazeOrigin;
     }
     bool GetLGazeValid() const
     {
-        return InternalData.LGazeValid;
+        return Latest<Serializer::EyeData>(Serializer::LeftEye).GazeValid;
     }
     const geom::Vector3D &GetRGazeDir() const
     {
-        return InternalData.RGazeDir;
+        return Latest<Serializer::EyeData>(Serializer::RightEye).GazeDir;
     }
     const geom::Vector3D &GetRGazeOrigin() const
     {
-        return InternalData.RGazeOrigin;
+        return Latest<Serializer::EyeData>(Serializer::RightEye).GazeOrigin;
     }
     bool GetRGazeValid() const
     {
-        return InternalData.RGazeValid;
+        return Latest<Serializer::EyeData>(Serializer::RightEye).GazeValid;
     }
     float GetLEyeOpenness() const
     {
-        return InternalData.LEyeOpenness;
+        return Latest<Serializer::EyeData>(Serializer::LeftEye).EyeOpenness;
     }
     bool GetLEyeOpenValid() const
     {
-        return InternalData.LEyeOpenValid;
+        return Latest<Serializer::EyeData>(Serializer::LeftEye).EyeOpenValid;
     }
     float GetREyeOpenness() const
     {
-        return InternalData.REyeOpenness;
+        return Latest<Serializer::EyeData>(Serializer::RightEye).EyeOpenness;
     }
     bool GetREyeOpenValid() const
     {
-        return InternalData.REyeOpenValid;
+        return Latest<Serializer::EyeData>(Serializer::RightEye).EyeOpenValid;
     }
     const geom::Vector2D &GetLPupilPos() const
     {
-        return InternalData.LPupilPos;
+        return Latest<Serializer::EyeData>(Serializer::LeftEye).PupilPos;
     }
     bool GetLPupilPosValid() const
     {
-        return InternalData.LPupilPosValid;
+        return Latest<Serializer::EyeData>(Serializer::LeftEye).PupilPosValid;
     }
     const geom::Vector2D &GetRPupilPos() const
     {
-        return InternalData.RPupilPos;
+        return Latest<Serializer::EyeData>(Serializer::RightEye).PupilPos;
     }
     bool GetRPupilPosValid() const
     {
-        return InternalData.RPupilPosValid;
+        return Latest<Serializer::EyeData>(Serializer::RightEye).PupilPosValid;
     }
     float GetLPupilDiam() const
     {
-        return InternalData.LPupilDiameter;
+        return Latest<Serializer::EyeData>(Serializer::LeftEye).PupilDiameter;
     }
     float GetRPupilDiam() const
     {
-        return InternalData.RPupilDiameter;
+        return Latest<Serializer::EyeData>(Serializer::RightEye).PupilDiameter;
     }
-    const std::string &GetFocusActorName() const
+    std::string GetFocusActorName() const
     {
-        return InternalData.FocusActorName;
+        return Serializer::LookupString(Latest<Serializer::FocusData>(Serializer::Focus).FocusActorName);
     }
     const geom::Vector3D &GetFocusActorPoint() const
     {
-        return InternalData.FocusActorPoint;
+        return Latest<Serializer::FocusData>(Serializer::Focus).FocusActorPoint;
     }
     float GetFocusActorDist() const
     {
-        return InternalData.FocusActorDist;
+        return Latest<Serializer::FocusData>(Serializer::Focus).FocusActorDist;
     }
     float GetThrottle() const
     {
-        return InternalData.Throttle;
+        return Latest<Serializer::InputsData>(Serializer::Inputs).Throttle;
     }
     float GetSteering() const
     {
-        return InternalData.Steering;
+        return Latest<Serializer::InputsData>(Serializer::Inputs).Steering;
     }
     float GetBrake() const
     {
-        return InternalData.Brake;
+        return Latest<Serializer::InputsData>(Serializer::Inputs).Brake;
     }
     bool GetToggledReverse() const
     {
-        return InternalData.ToggledReverse;
+        return Latest<Serializer::InputsData>(Serializer::Inputs).ToggledReverse;
     }
     bool GetHandbrake() const
     {
-        return InternalData.HoldHandbrake;
+        return Latest<Serializer::InputsData>(Serializer::Inputs).HoldHandbrake;
+    }
+    // the actors in the gaze cone (Index < MaxAttentionActors), largest weight first and 0 for the unused entries
+    std::string GetAttentionActorName(size_t Index) const
+    {
+        return Serializer::LookupString(Latest<Serializer::AttentionData>(Serializer::Attention).ActorName[Index]);
+    }
+    float GetAttentionWeight(size_t Index) const
+    {
+        return Latest<Serializer::AttentionData>(Serializer::Attention).Weight[Index];
+    }
+
+    // the fixations/saccades detected in all the samples of this event (not only the latest one), oldest first
+    struct GazeEvent
+    {
+        uint8_t Type; // 1: fixation start, 2: fixation end, 3: saccade (DReyeVR::GazeEventType)
+        int64_t TimestampDevice;
+        float DurationMs;
+        geom::Vector3D Centroid;
+        float Amplitude;
+        float PeakVelocity;
+    };
+    std::vector<GazeEvent> GetGazeEvents() const
+    {
+        std::vector<GazeEvent> Events;
+        for (size_t i = 0; i < GetNumSamples(); i++)
+        {
+            const auto &Group = Sample<Serializer::GazeEventsData>(Serializer::GazeEvents, i);
+            for (size_t j = 0; j < Serializer::MaxGazeEvents && Group.Type[j] != 0; j++)
+                Events.push_back({Group.Type[j], Group.TimestampDevice[j], Group.DurationMs[j], Group.Centroid[j],
+                                  Group.Amplitude[j], Group.PeakVelocity[j]});
+        }
+        return Events;
     }
 
   private:
-    carla::sensor::s11n::DReyeVRSerializer::Data InternalData;
+    // a group of a sample, in place (validated and non-empty by DReyeVRSerializer::Deserialize)
+    template <typename GroupT> const GroupT &Sample(Serializer::Field Group, size_t Index) const
+    {
+        const uint32_t Mask = GetFieldMask();
+        if ((Mask & Group) == 0)
+            throw_exception(std::runtime_error("this DReyeVR sensor does not stream the requested fields, see its "
+                                               "stream_fields attribute"));
+        const unsigned char *Record = GetRecords() + Index * Serializer::RecordSize(Mask);
+        return *reinterpret_cast<const GroupT *>(Record + Serializer::GroupOffset(Mask, Group));
+    }
+    template <typename GroupT> const GroupT &Latest(Serializer::Field Group) const
+    {
+        return Sample<GroupT>(Group, GetNumSamples() - 1);
+    }
+
+    RawData Raw;
 };
 } // namespace data
 } // namespace sensor
-} // namespace carla
\ No newline at end of file
+} // namespace carla
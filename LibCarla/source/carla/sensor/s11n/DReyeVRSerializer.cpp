@@ -1,16 +1,232 @@
 #include "carla/sensor/s11n/DReyeVRSerializer.h"
+#include "carla/Exception.h"
 #include "carla/sensor/data/DReyeVREvent.h"
 
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace carla
 {
     namespace sensor
     {
         namespace s11n
         {
+            namespace
+            {
+                // the whole table is appended every this many messages (for the clients that subscribed late)
+                constexpr uint64_t FullTablePeriod = 256;
+
+                struct ServerStrings
+                {
+                    std::mutex Mutex;
+                    std::unordered_map<std::string, uint32_t> Ids;
+                    std::vector<std::string> Names; // indexed by id
+                };
+
+                struct ClientStrings
+                {
+                    std::mutex Mutex;
+                    std::unordered_map<uint32_t, std::string> Names;
+                };
+
+                ServerStrings &GetServerStrings()
+                {
+                    static ServerStrings Strings;
+                    return Strings;
+                }
+
+                ClientStrings &GetClientStrings()
+                {
+                    static ClientStrings Strings;
+                    return Strings;
+                }
+            } // namespace
+
+            uint32_t DReyeVRSerializer::ParseFieldMask(const std::string &Fields)
+            {
+                static const std::unordered_map<std::string, uint32_t> Names = {
+                    {"all", AllFields},       {"timestamps", Timestamps}, {"camera", Camera},
+                    {"gaze", Gaze},           {"left_eye", LeftEye},      {"right_eye", RightEye},
+                    {"focus", Focus},         {"inputs", Inputs},         {"attention", Attention},
+                    {"gaze_events", GazeEvents},
+                };
+                uint32_t Mask = Timestamps;
+                size_t Begin = 0;
+                while (Begin <= Fields.size())
+                {
+                    size_t End = Fields.find(',', Begin);
+                    if (End == std::string::npos)
+                        End = Fields.size();
+                    // trim the whitespace around the name
+                    size_t First = Fields.find_first_not_of(" \t", Begin);
+                    size_t Last = Fields.find_last_not_of(" \t", End == 0 ? 0 : End - 1);
+                    if (First != std::string::npos && First < End && Last >= First)
+                    {
+                        auto It = Names.find(Fields.substr(First, Last - First + 1));
+                        if (It != Names.end())
+                            Mask |= It->second;
+                    }
+                    Begin = End + 1;
+                }
+                return Mask;
+            }
+
+            Buffer DReyeVRSerializer::Serialize(StreamState &Stream, const std::vector<Data> &Samples,
+                                                const std::vector<std::string> &FocusActorNames, uint32_t FieldMask,
+                                                const std::vector<std::string> &AttentionActorNames)
+            {
+                FieldMask = (FieldMask & AllFields) | Timestamps;
+                const size_t RecSize = RecordSize(FieldMask);
+                const bool bWithFocus = (FieldMask & Focus) != 0;
+                const bool bWithAttention = (FieldMask & Attention) != 0;
+                const bool bWithNames = bWithFocus || bWithAttention;
+
+                ServerStrings &Strings = GetServerStrings();
+                std::unique_lock<std::mutex> Lock(Strings.Mutex, std::defer_lock);
+                size_t First = 0, Last = 0; // string table entries to append
+                std::vector<uint32_t> Ids, AttentionIds;
+                if (bWithNames)
+                {
+                    Lock.lock();
+                    // the names this stream has not sent yet (or all of them every so often) go after the records
+                    First = (Stream.NumMessages++ % FullTablePeriod == 0) ? 0 : Stream.NumSent;
+                    auto Intern = [&Strings](const std::vector<std::string> &Names, size_t i) {
+                        const std::string &Name = i < Names.size() ? Names[i] : std::string();
+                        auto It = Strings.Ids.find(Name);
+                        if (It == Strings.Ids.end())
+                        {
+                            It = Strings.Ids.emplace(Name, static_cast<uint32_t>(Strings.Names.size())).first;
+                            Strings.Names.push_back(Name);
+                        }
+                        return It->second;
+                    };
+                    if (bWithFocus)
+                    {
+                        Ids.resize(Samples.size());
+                        for (size_t i = 0; i < Samples.size(); i++)
+                            Ids[i] = Intern(FocusActorNames, i); // intern the focus actor name
+                    }
+                    if (bWithAttention)
+                    {
+                        AttentionIds.resize(Samples.size() * MaxAttentionActors);
+                        for (size_t i = 0; i < AttentionIds.size(); i++)
+                            AttentionIds[i] = Intern(AttentionActorNames, i);
+                    }
+                    Last = Strings.Names.size();
+                }
+                size_t Size = sizeof(Header) + Samples.size() * RecSize;
+                for (size_t i = First; i < Last; i++)
+                    Size += sizeof(StringEntry) + std::min<size_t>(Strings.Names[i].size(), UINT16_MAX);
+
+                Header Head{};
+                Head.Version = Version;
+                Head.NumSamples = static_cast<uint32_t>(Samples.size());
+                Head.NumStrings = static_cast<uint32_t>(Last - First);
+                Head.FieldMask = FieldMask;
+
+                Buffer Message(static_cast<Buffer::size_type>(Size));
+                unsigned char *Out = Message.data();
+                std::memcpy(Out, &Head, sizeof(Header));
+                Out += sizeof(Header);
+                for (size_t i = 0; i < Samples.size(); i++)
+                {
+                    // only the selected groups, in the order of their bits
+                    const Data &Sample = Samples[i];
+                    const std::pair<Field, const void *> Groups[] = {
+                        {Timestamps, &Sample.Timestamps}, {Camera, &Sample.Camera}, {Gaze, &Sample.Gaze},
+                        {LeftEye, &Sample.LEye},          {RightEye, &Sample.REye}, {Focus, &Sample.Focus},
+                        {Inputs, &Sample.Inputs},         {Attention, &Sample.Attention},
+                        {GazeEvents, &Sample.GazeEvents},
+                    };
+                    for (const auto &Group : Groups)
+                    {
+                        if ((FieldMask & Group.first) == 0)
+                            continue;
+                        if (Group.first == Focus)
+                        {
+                            FocusData Focused = Sample.Focus;
+                            Focused.FocusActorName = Ids[i];
+                            std::memcpy(Out, &Focused, sizeof(FocusData));
+                        }
+                        else if (Group.first == Attention)
+                        {
+                            AttentionData Attended = Sample.Attention;
+                            std::memcpy(Attended.ActorName, &AttentionIds[i * MaxAttentionActors],
+                                        sizeof(Attended.ActorName));
+                            std::memcpy(Out, &Attended, sizeof(AttentionData));
+                        }
+                        else
+                        {
+                            std::memcpy(Out, Group.second, GroupSize(Group.first));
+                        }
+                        Out += GroupSize(Group.first);
+                    }
+                }
+                for (size_t i = First; i < Last; i++)
+                {
+                    const std::string &Name = Strings.Names[i];
+                    const StringEntry Entry{static_cast<uint32_t>(i),
+                                            static_cast<uint16_t>(std::min<size_t>(Name.size(), UINT16_MAX))};
+                    std::memcpy(Out, &Entry, sizeof(StringEntry));
+                    Out += sizeof(StringEntry);
+                    std::memcpy(Out, Name.data(), Entry.Length);
+                    Out += Entry.Length;
+                }
+                if (bWithNames)
+                    Stream.NumSent = Last;
+                return Message;
+            }
+
+            std::string DReyeVRSerializer::LookupString(uint32_t Id)
+            {
+                ClientStrings &Strings = GetClientStrings();
+                std::lock_guard<std::mutex> Lock(Strings.Mutex);
+                auto It = Strings.Names.find(Id);
+                return It != Strings.Names.end() ? It->second : std::string();
+            }
+
+            const DReyeVRSerializer::Header *DReyeVRSerializer::Read(const unsigned char *Begin, size_t Size)
+            {
+                const Header *Msg = View(Begin, Size);
+                if (Msg == nullptr)
+                {
+                    throw_exception(std::runtime_error("DReyeVR sensor message is truncated or has an unsupported "
+                                                       "version, make sure the client and the server are built "
+                                                       "from the same DReyeVR version"));
+                }
+
+                // only the string table entries are read here, the records are read in place
+                if (Msg->NumStrings > 0)
+                {
+                    ClientStrings &Strings = GetClientStrings();
+                    std::lock_guard<std::mutex> Lock(Strings.Mutex);
+                    const unsigned char *In =
+                        Begin + sizeof(Header) + size_t(Msg->NumSamples) * RecordSize(Msg->FieldMask);
+                    const unsigned char *End = Begin + Size;
+                    for (uint32_t i = 0; i < Msg->NumStrings && In + sizeof(StringEntry) <= End; i++)
+                    {
+                        StringEntry Entry;
+                        std::memcpy(&Entry, In, sizeof(StringEntry));
+                        In += sizeof(StringEntry);
+                        if (In + Entry.Length > End)
+                            break;
+                        Strings.Names[Entry.Id].assign(reinterpret_cast<const char *>(In), Entry.Length);
+                        In += Entry.Length;
+                    }
+                }
+                return Msg;
+            }
+
             SharedPtr<SensorData> DReyeVRSerializer::Deserialize(RawData &&data)
             {
+                Read(data.begin(), data.size());
                 return SharedPtr<SensorData>(new data::DReyeVREvent(std::move(data)));
             }
         } // namespace s11n
     }     // namespace sensor
-} // namespace carla
\ No newline at end of file
+} // namespace carla
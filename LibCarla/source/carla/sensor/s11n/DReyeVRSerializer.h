@@ -1,4 +1,3 @@
-
 #pragma once
 
 #include "carla/Buffer.h"
@@ -9,6 +8,9 @@
 
 #include <cstdint>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace carla
 {
@@ -21,76 +23,240 @@ namespace s11n
 class DReyeVRSerializer
 {
   public:
-    struct Data
+    // bump this whenever the layout of Data changes (clients refuse messages of other versions)
+    static constexpr uint32_t Version = 6;
+
+    // Fixed-layout wire format: a message is a Header followed by NumSamples contiguous records (one per sample,
+    // several ticks worth of them when the sensor batches its stream) which are sent as-is and read in place from the
+    // RawData buffer by the clients (also as a numpy structured array, see PythonAPI/.../SensorData.cpp).
+    // A record only holds the field groups of the sensor's mask (see the stream_fields attribute) in the order of their
+    // bits, so the consumers that only need e.g. the gaze do not pay for the rest.
+    // The focus (and attention) actor names are interned into a string table (shared by all the DReyeVR sensors of the
+    // server) and only their ids are sent. The (id, name) entries that the clients of a stream may not have seen yet
+    // are appended after the records, i.e. the names added to the table since the last message of that stream (see
+    // StreamState), plus the whole table every so often for late subscribers.
+    struct Header
+    {
+        uint32_t Version;
+        uint32_t NumSamples;
+        uint32_t NumStrings; // number of string table entries after the records
+        uint32_t FieldMask;  // groups in each record (also keeps the records 8-byte aligned)
+    };
+
+    // field groups (the timestamps are always sent)
+    enum Field : uint32_t
+    {
+        Timestamps = 1 << 0,
+        Camera = 1 << 1,
+        Gaze = 1 << 2,
+        LeftEye = 1 << 3,
+        RightEye = 1 << 4,
+        Focus = 1 << 5,
+        Inputs = 1 << 6,
+        Attention = 1 << 7,
+        GazeEvents = 1 << 8,
+        AllFields = (1 << 9) - 1,
+    };
+
+    // number of actors (with the largest weights) sent from the gaze cone attention
+    static constexpr size_t MaxAttentionActors = 4;
+    // fixation/saccade events completed by a single eye sample (the detector never emits more)
+    static constexpr size_t MaxGazeEvents = 3;
+
+    /// NOTE: this is missing some fields that can totally be added, but you get the idea.
+    // Step 1: add new field field here in one of the groups (or in a new group with its own Field bit, keeping the
+    //         fields naturally aligned) and bump the Version
+    // Step 2: go to LibCarla/source/carla/sensor/data/DReyeVREvent.h and add a const getter
+    // Step 3: go to PythonAPI/carla/source/libcarla/SensorData.cpp and add the getter to the list of available
+    //         attributes just like the others, and the field to the numpy dtype (GetDReyeVRSampleDtype)
+    struct alignas(8) TimestampsData
     {
-        /// TODO: refactor this struct to contain smaller structs similar to DReyeVR::AggregateData
-        /// NOTE: this is missing some fields that can totally be added, but you get the idea.
-        // Step 1: add new field field here in Data struct
-        // Step 2: add new field in MSGPACK_DEFINE_ARRAY) in the SAME ORDER
-        // Step 3: go to LibCarla/source/carla/sensor/data/DReyeVREvent.h and add a const getter
-        // Step 4: go to PythonAPI/carla/source/libcarla/SensorData.cpp and add the getter to the list of available attributes just like the others
         int64_t TimestampCarla;
         int64_t TimestampDevice;
         int64_t FrameSequence;
-        // camera
+    };
+    struct alignas(8) CameraData
+    {
         geom::Vector3D CameraLocation;
         geom::Vector3D CameraRotation;
-        // combined gaze
+    };
+    struct alignas(8) GazeData // combined gaze
+    {
         geom::Vector3D GazeDir;
         geom::Vector3D GazeOrigin;
-        bool GazeValid;
         float GazeVergence;
-        // left gaze/eye
-        geom::Vector3D LGazeDir;
-        geom::Vector3D LGazeOrigin;
-        bool LGazeValid;
-        float LEyeOpenness;
-        bool LEyeOpenValid;
-        geom::Vector2D LPupilPos;
-        bool LPupilPosValid;
-        float LPupilDiameter;
-        // right gaze/eye
-        geom::Vector3D RGazeDir;
-        geom::Vector3D RGazeOrigin;
-        bool RGazeValid;
-        float REyeOpenness;
-        bool REyeOpenValid;
-        geom::Vector2D RPupilPos;
-        bool RPupilPosValid;
-        float RPupilDiameter;
-        // focus 
-        std::string FocusActorName;
+        bool GazeValid;
+    };
+    struct alignas(8) EyeData // left or right gaze/eye
+    {
+        geom::Vector3D GazeDir;
+        geom::Vector3D GazeOrigin;
+        float EyeOpenness;
+        geom::Vector2D PupilPos;
+        float PupilDiameter;
+        bool GazeValid;
+        bool EyeOpenValid;
+        bool PupilPosValid;
+    };
+    struct alignas(8) FocusData
+    {
         geom::Vector3D FocusActorPoint;
         float FocusActorDist;
-        // inputs
+        uint32_t FocusActorName; // id in the string table
+    };
+    struct alignas(8) InputsData
+    {
         float Throttle;
         float Steering;
         float Brake;
         bool ToggledReverse;
         bool HoldHandbrake;
+    };
+    struct alignas(8) AttentionData // the actors in the gaze cone, largest weight first
+    {
+        uint32_t ActorName[MaxAttentionActors]; // ids in the string table
+        float Weight[MaxAttentionActors];       // 0 for the unused entries
+    };
+    struct alignas(8) GazeEventsData // fixations/saccades completed by this sample (see DReyeVR::GazeEvent)
+    {
+        int64_t TimestampDevice[MaxGazeEvents]; // start of the event
+        geom::Vector3D Centroid[MaxGazeEvents];
+        float DurationMs[MaxGazeEvents];
+        float Amplitude[MaxGazeEvents];
+        float PeakVelocity[MaxGazeEvents];
+        uint8_t Type[MaxGazeEvents]; // DReyeVR::GazeEventType, 0 for the unused entries
+    };
 
-        MSGPACK_DEFINE_ARRAY(TimestampCarla, TimestampDevice, FrameSequence, // timings
-                             CameraLocation, CameraRotation,                 // camera
-                             GazeDir, GazeOrigin, GazeValid, GazeVergence,   // combined gaze
-                             LGazeDir, LGazeOrigin, LGazeValid, LEyeOpenness, LEyeOpenValid, LPupilPos, LPupilPosValid, LPupilDiameter, // left gaze/eye
-                             RGazeDir, RGazeOrigin, RGazeValid, REyeOpenness, REyeOpenValid, RPupilPos, RPupilPosValid, RPupilDiameter, // right gaze/eye
-                             FocusActorName, FocusActorPoint, FocusActorDist,         // focus info
-                             Throttle, Steering, Brake, ToggledReverse, HoldHandbrake // user inputs
-        )
+    // every group of a sample (what the server fills in, the records only hold the groups of the mask)
+    struct Data
+    {
+        TimestampsData Timestamps;
+        CameraData Camera;
+        GazeData Gaze;
+        EyeData LEye;
+        EyeData REye;
+        FocusData Focus;
+        InputsData Inputs;
+        AttentionData Attention;
+        GazeEventsData GazeEvents;
+    };
+    static_assert(std::is_trivially_copyable<Data>::value, "DReyeVR wire format must be trivially copyable");
+
+    // string table entry that follows the records (the name follows the entry)
+#pragma pack(push, 1)
+    struct StringEntry
+    {
+        uint32_t Id;
+        uint16_t Length;
     };
+#pragma pack(pop)
+
+    static size_t GroupSize(Field Group)
+    {
+        switch (Group)
+        {
+        case Timestamps:
+            return sizeof(TimestampsData);
+        case Camera:
+            return sizeof(CameraData);
+        case Gaze:
+            return sizeof(GazeData);
+        case LeftEye:
+        case RightEye:
+            return sizeof(EyeData);
+        case Focus:
+            return sizeof(FocusData);
+        case Inputs:
+            return sizeof(InputsData);
+        case Attention:
+            return sizeof(AttentionData);
+        case GazeEvents:
+            return sizeof(GazeEventsData);
+        default:
+            return 0;
+        }
+    }
 
-    static Data DeserializeRawData(const RawData &message)
+    // offset of a group in the records of FieldMask (only meaningful if the group is in the mask)
+    static size_t GroupOffset(uint32_t FieldMask, uint32_t Group)
     {
-        return MsgPack::UnPack<Data>(message.begin(), message.size());
+        size_t Offset = 0;
+        for (uint32_t Bit = Timestamps; Bit < Group && Bit <= AllFields; Bit <<= 1)
+            if (FieldMask & Bit)
+                Offset += GroupSize(Field(Bit));
+        return Offset;
     }
 
-    template <typename SensorT> static Buffer Serialize(const SensorT &, struct Data &&DataIn)
+    // size of the records of FieldMask
+    static size_t RecordSize(uint32_t FieldMask)
     {
-        return MsgPack::Pack(DataIn);
+        return GroupOffset(FieldMask, AllFields + 1);
     }
+
+    // comma separated group names ("timestamps,camera,gaze,left_eye,right_eye,focus,inputs,attention,gaze_events" or
+    // "all") to a mask, unknown names are ignored and the timestamps are always included
+    static uint32_t ParseFieldMask(const std::string &Fields);
+
+    // client side: the header of a message, in place (nullptr if the message is not of this version or is truncated)
+    // NOTE: the server never sends an empty batch
+    static const Header *View(const unsigned char *Begin, size_t Size)
+    {
+        if (Size < sizeof(Header))
+            return nullptr;
+        const Header *Msg = reinterpret_cast<const Header *>(Begin);
+        if (Msg->Version != Version || Msg->NumSamples == 0 || (Msg->FieldMask & Timestamps) == 0 ||
+            Size < sizeof(Header) + size_t(Msg->NumSamples) * RecordSize(Msg->FieldMask))
+            return nullptr;
+        return Msg;
+    }
+    static const Header *View(const RawData &message)
+    {
+        return View(message.begin(), message.size());
+    }
+
+    // client side: the records of a (validated) message, in place
+    static const unsigned char *Records(const RawData &message)
+    {
+        return message.begin() + sizeof(Header);
+    }
+
+    // client side: validates a message (throws if it is not of this version or is truncated) and stores its string
+    // table entries, this is what Deserialize does before wrapping the message in a DReyeVREvent
+    static const Header *Read(const unsigned char *Begin, size_t Size);
+
+    // client side: name of an interned string id
+    static std::string LookupString(uint32_t Id);
+
+    // server side: how much of the (shared) string table a stream has sent, every sensor keeps its own
+    struct StreamState
+    {
+        size_t NumSent = 0;       // names that have already been appended to a message of the stream
+        uint64_t NumMessages = 0; // messages with names, for the periodic full table
+    };
+
+    // server side: the groups of FieldMask are sent as-is except for the FocusActorName ids which are filled in here
+    // from the (parallel) FocusActorNames, and the attention ActorName ids from AttentionActorNames (MaxAttentionActors
+    // per sample)
+    template <typename SensorT>
+    static Buffer Serialize(const SensorT &, StreamState &Stream, const std::vector<Data> &Samples,
+                            const std::vector<std::string> &FocusActorNames, uint32_t FieldMask,
+                            const std::vector<std::string> &AttentionActorNames = {})
+    {
+        return Serialize(Stream, Samples, FocusActorNames, FieldMask, AttentionActorNames);
+    }
+    static Buffer Serialize(StreamState &Stream, const std::vector<Data> &Samples,
+                            const std::vector<std::string> &FocusActorNames, uint32_t FieldMask,
+                            const std::vector<std::string> &AttentionActorNames = {});
+
+    // server side: an already serialized message (e.g. one that was also published to the shared memory)
+    template <typename SensorT> static Buffer Serialize(const SensorT &, Buffer &&Message)
+    {
+        return std::move(Message);
+    }
+
     static SharedPtr<SensorData> Deserialize(RawData &&data);
 };
 
 } // namespace s11n
 } // namespace sensor
-} // namespace carla
\ No newline at end of file
+} // namespace carla
@@ -0,0 +1,316 @@
+// Benchmarks of the DReyeVR sensor stream: pack/unpack throughput of the DReyeVRSerializer messages and end-to-end
+// latency/jitter over the low level streaming Server/Client on loopback.
+//
+// Run with --gtest_filter=benchmark_dreyevr* (like the other benchmarks these are excluded from the regular checks).
+// If DREYEVR_BENCHMARK_BASELINE points to a baseline file the results are compared against it and any metric that is
+// worse by more than DREYEVR_BENCHMARK_TOLERANCE (default 0.25, i.e. 25%) fails the test. Set
+// DREYEVR_BENCHMARK_UPDATE_BASELINE=1 to (re)write the baseline with the results of this run instead. Baselines are
+// machine specific, record one on the machine that runs the comparison.
+
+#include "test.h"
+
+#include <carla/ThreadGroup.h>
+#include <carla/sensor/s11n/DReyeVRSerializer.h>
+#include <carla/streaming/detail/tcp/Client.h>
+#include <carla/streaming/detail/tcp/Server.h>
+#include <carla/streaming/low_level/Client.h>
+#include <carla/streaming/low_level/Server.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+using Serializer = carla::sensor::s11n::DReyeVRSerializer;
+
+namespace {
+
+  // metric name -> value, and whether a larger value is better
+  struct Results {
+    std::map<std::string, std::pair<double, bool>> metrics;
+
+    void Add(const std::string &name, double value, bool higher_is_better) {
+      metrics[name] = {value, higher_is_better};
+      std::cout << "  " << name << ": " << value << '\n';
+    }
+  };
+
+  // the results of every benchmark of this run, compared against (or written to) the baseline at the end
+  Results &GetResults() {
+    static Results results;
+    return results;
+  }
+
+  struct Percentiles {
+    double p50, p90, p99, max, jitter; // jitter: standard deviation
+  };
+
+  Percentiles ComputePercentiles(std::vector<double> values) {
+    Percentiles out{};
+    if (values.empty()) {
+      return out;
+    }
+    std::sort(values.begin(), values.end());
+    auto at = [&](double q) {
+      return values[std::min(values.size() - 1u, static_cast<size_t>(q * static_cast<double>(values.size())))];
+    };
+    out.p50 = at(0.50);
+    out.p90 = at(0.90);
+    out.p99 = at(0.99);
+    out.max = values.back();
+    double mean = 0.0;
+    for (auto v : values) {
+      mean += v;
+    }
+    mean /= static_cast<double>(values.size());
+    double var = 0.0;
+    for (auto v : values) {
+      var += (v - mean) * (v - mean);
+    }
+    out.jitter = std::sqrt(var / static_cast<double>(values.size()));
+    return out;
+  }
+
+  int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  // samples with every field filled in (different names so the string table is exercised too)
+  std::vector<Serializer::Data> MakeSamples(size_t count, std::vector<std::string> &names) {
+    std::vector<Serializer::Data> samples(count);
+    names.resize(count);
+    for (size_t i = 0u; i < count; ++i) {
+      auto &s = samples[i];
+      const float f = static_cast<float>(i);
+      s.Timestamps = {static_cast<int64_t>(i), static_cast<int64_t>(i) * 2, static_cast<int64_t>(i)};
+      s.Camera.CameraLocation = {f, f + 1.0f, f + 2.0f};
+      s.Gaze.GazeDir = {1.0f, 0.0f, 0.0f};
+      s.Gaze.GazeValid = true;
+      s.LEye.PupilDiameter = 3.0f;
+      s.REye.PupilDiameter = 3.1f;
+      s.Focus.FocusActorDist = f;
+      s.Inputs.Throttle = 0.5f;
+      names[i] = "vehicle." + std::to_string(i % 16u);
+    }
+    return samples;
+  }
+
+  // what a client does with a message: validate it, read its strings, and touch every record
+  double ReadMessage(const unsigned char *data, size_t size) {
+    const Serializer::Header *msg = Serializer::Read(data, size);
+    const size_t record_size = Serializer::RecordSize(msg->FieldMask);
+    const size_t ts_offset = Serializer::GroupOffset(msg->FieldMask, Serializer::Timestamps);
+    const unsigned char *records = data + sizeof(Serializer::Header);
+    double sum = 0.0;
+    for (uint32_t i = 0u; i < msg->NumSamples; ++i) {
+      Serializer::TimestampsData ts;
+      std::memcpy(&ts, records + i * record_size + ts_offset, sizeof(ts));
+      sum += static_cast<double>(ts.FrameSequence + 1);
+    }
+    return sum;
+  }
+
+  // "name value" per line
+  std::map<std::string, double> LoadBaseline(const std::string &path) {
+    std::map<std::string, double> baseline;
+    std::ifstream file(path);
+    std::string name;
+    double value;
+    while (file >> name >> value) {
+      baseline[name] = value;
+    }
+    return baseline;
+  }
+
+  const char *GetEnv(const char *name) {
+    const char *value = std::getenv(name);
+    return (value != nullptr && value[0] != '\0') ? value : nullptr;
+  }
+
+} // namespace
+
+// This is required for low level to properly stop the threads in case of
+// exception/assert.
+class dreyevr_io_context_running {
+public:
+
+  boost::asio::io_context service;
+
+  explicit dreyevr_io_context_running(size_t threads = 2u)
+    : _work_to_do(service) {
+    _threads.CreateThreads(threads, [this]() { service.run(); });
+  }
+
+  ~dreyevr_io_context_running() {
+    service.stop();
+  }
+
+private:
+
+  boost::asio::io_context::work _work_to_do;
+
+  carla::ThreadGroup _threads;
+};
+
+static void BenchmarkPackUnpack(size_t batch, uint32_t mask, const std::string &label) {
+  constexpr auto iterations = 20000u;
+  std::vector<std::string> names;
+  const auto samples = MakeSamples(batch, names);
+
+  // pack
+  size_t bytes = 0u;
+  std::vector<carla::Buffer> messages;
+  messages.reserve(iterations);
+  Serializer::StreamState stream_strings;
+  auto begin = std::chrono::steady_clock::now();
+  for (auto i = 0u; i < iterations; ++i) {
+    messages.emplace_back(Serializer::Serialize(stream_strings, samples, names, mask));
+    bytes += messages.back().size();
+  }
+  const double pack_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  // unpack
+  double checksum = 0.0;
+  begin = std::chrono::steady_clock::now();
+  for (const auto &message : messages) {
+    checksum += ReadMessage(message.data(), message.size());
+  }
+  const double unpack_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+  ASSERT_GT(checksum, 0.0);
+
+  const double num_samples = static_cast<double>(iterations) * static_cast<double>(batch);
+  std::cout << label << " (" << bytes / iterations << " bytes/message)\n";
+  GetResults().Add(label + ".pack_samples_per_s", num_samples / pack_s, true);
+  GetResults().Add(label + ".pack_mb_per_s", static_cast<double>(bytes) / pack_s / 1e6, true);
+  GetResults().Add(label + ".unpack_samples_per_s", num_samples / unpack_s, true);
+}
+
+TEST(benchmark_dreyevr, pack_unpack) {
+  BenchmarkPackUnpack(1u, Serializer::AllFields, "pack_unpack.all.batch1");
+  BenchmarkPackUnpack(16u, Serializer::AllFields, "pack_unpack.all.batch16");
+  BenchmarkPackUnpack(16u, Serializer::ParseFieldMask("gaze"), "pack_unpack.gaze.batch16");
+}
+
+static void BenchmarkLatency(size_t number_of_clients) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+
+  constexpr auto number_of_messages = 1000u;
+  constexpr auto warmup_messages = 50u;
+  const std::string label = "latency.clients" + std::to_string(number_of_clients);
+
+  dreyevr_io_context_running io(std::max<size_t>(2u, std::min<size_t>(number_of_clients, 8u)));
+
+  low_level::Server<tcp::Server> srv(io.service, TESTING_PORT);
+  srv.SetTimeout(1s);
+  auto stream = srv.MakeStream();
+
+  std::mutex mutex;
+  std::vector<double> latencies_us;
+  latencies_us.reserve(number_of_clients * number_of_messages);
+  std::atomic_size_t received{0u};
+
+  std::vector<std::unique_ptr<low_level::Client<tcp::Client>>> clients;
+  for (auto i = 0u; i < number_of_clients; ++i) {
+    clients.emplace_back(std::make_unique<low_level::Client<tcp::Client>>());
+    clients.back()->Subscribe(io.service, stream.token(), [&](carla::Buffer message) {
+      const int64_t now = NowNs();
+      Serializer::Read(message.data(), message.size()); // validates, as a client would
+      Serializer::TimestampsData ts;
+      std::memcpy(&ts, message.data() + sizeof(Serializer::Header), sizeof(ts));
+      ++received;
+      if (ts.FrameSequence < static_cast<int64_t>(warmup_messages)) {
+        return;
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      // the send time travels in the device timestamp
+      latencies_us.push_back(static_cast<double>(now - ts.TimestampDevice) / 1e3);
+    });
+  }
+  std::this_thread::sleep_for(100ms); // let the clients connect
+
+  std::vector<std::string> names;
+  auto samples = MakeSamples(1u, names);
+  Serializer::StreamState stream_strings;
+  for (auto i = 0u; i < warmup_messages + number_of_messages; ++i) {
+    std::this_thread::sleep_for(1ms); // ~ eye tracker rate
+    samples[0].Timestamps.FrameSequence = i;
+    samples[0].Timestamps.TimestampDevice = NowNs();
+    stream.Write(Serializer::Serialize(stream_strings, samples, names, Serializer::AllFields));
+  }
+  std::this_thread::sleep_for(100ms);
+
+  const size_t expected = number_of_clients * (warmup_messages + number_of_messages);
+  std::cout << label << " (received " << received << " of " << expected << " messages)\n";
+  ASSERT_GE(received, expected - expected / 100u); // allow for a few messages sent before a client connected
+
+  Percentiles p;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    p = ComputePercentiles(latencies_us);
+  }
+  GetResults().Add(label + ".p50_us", p.p50, false);
+  GetResults().Add(label + ".p90_us", p.p90, false);
+  GetResults().Add(label + ".p99_us", p.p99, false);
+  GetResults().Add(label + ".max_us", p.max, false);
+  GetResults().Add(label + ".jitter_us", p.jitter, false);
+
+  io.service.stop();
+}
+
+TEST(benchmark_dreyevr, latency_1_client) {
+  BenchmarkLatency(1u);
+}
+
+TEST(benchmark_dreyevr, latency_4_clients) {
+  BenchmarkLatency(4u);
+}
+
+TEST(benchmark_dreyevr, latency_16_clients) {
+  BenchmarkLatency(16u);
+}
+
+// runs last (tests run in the order they are defined)
+TEST(benchmark_dreyevr, zz_compare_to_baseline) {
+  const char *path = GetEnv("DREYEVR_BENCHMARK_BASELINE");
+  if (path == nullptr) {
+    std::cout << "no DREYEVR_BENCHMARK_BASELINE set, not checking for regressions\n";
+    return;
+  }
+  const auto &results = GetResults().metrics;
+  if (GetEnv("DREYEVR_BENCHMARK_UPDATE_BASELINE") != nullptr) {
+    std::ofstream file(path);
+    for (const auto &metric : results) {
+      file << metric.first << ' ' << metric.second.first << '\n';
+    }
+    std::cout << "wrote the baseline " << path << '\n';
+    return;
+  }
+  const char *tolerance_str = GetEnv("DREYEVR_BENCHMARK_TOLERANCE");
+  const double tolerance = tolerance_str != nullptr ? std::atof(tolerance_str) : 0.25;
+  const auto baseline = LoadBaseline(path);
+  ASSERT_FALSE(baseline.empty()) << "unable to read the baseline " << path;
+  for (const auto &metric : results) {
+    auto it = baseline.find(metric.first);
+    if (it == baseline.end()) {
+      continue; // new metric, not in the baseline yet
+    }
+    const double value = metric.second.first;
+    const bool higher_is_better = metric.second.second;
+    if (higher_is_better) {
+      EXPECT_GE(value, it->second * (1.0 - tolerance)) << metric.first << " regressed";
+    } else {
+      EXPECT_LE(value, it->second * (1.0 + tolerance)) << metric.first << " regressed";
+    }
+  }
+}
@@ -0,0 +1,67 @@
+// String table of the DReyeVR sensor stream: the focus actor names are interned into a table shared by all the sensors
+// of the server, but every sensor streams to its own clients, so each stream has to deliver every name it references.
+
+#include "test.h"
+
+#include <carla/sensor/s11n/DReyeVRSerializer.h>
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+using Serializer = carla::sensor::s11n::DReyeVRSerializer;
+
+namespace {
+
+  // what the clients of one stream know: the string table entries of the messages they received
+  struct StreamClient {
+    std::map<uint32_t, std::string> names;
+  };
+
+  // receives a message with a single sample and returns the name its focus id resolves to for this stream's clients
+  std::string Receive(StreamClient &client, const carla::Buffer &message) {
+    const Serializer::Header *msg = Serializer::Read(message.data(), message.size());
+    const unsigned char *records = message.data() + sizeof(Serializer::Header);
+    Serializer::FocusData focus;
+    std::memcpy(&focus, records + Serializer::GroupOffset(msg->FieldMask, Serializer::Focus), sizeof(focus));
+    const unsigned char *entry = records + msg->NumSamples * Serializer::RecordSize(msg->FieldMask);
+    for (uint32_t i = 0u; i < msg->NumStrings; ++i) {
+      Serializer::StringEntry header;
+      std::memcpy(&header, entry, sizeof(header));
+      entry += sizeof(header);
+      client.names[header.Id] = std::string(reinterpret_cast<const char *>(entry), header.Length);
+      entry += header.Length;
+    }
+    auto it = client.names.find(focus.FocusActorName);
+    return it != client.names.end() ? it->second : std::string();
+  }
+
+} // namespace
+
+TEST(dreyevr_serializer, interleaved_streams_deliver_every_name) {
+  const uint32_t mask = Serializer::ParseFieldMask("focus");
+  std::vector<Serializer::Data> samples(1u);
+  Serializer::StreamState stream_a, stream_b;
+  StreamClient client_a, client_b;
+
+  // both sensors look at the same new actors (one of them sees each actor first) and at their own ones, in fewer
+  // messages than the full table period so only the per-stream cursors deliver the names
+  for (int i = 0; i < 50; ++i) {
+    const std::string shared = "test_serializer.shared." + std::to_string(i);
+    const std::string own_a = "test_serializer.a." + std::to_string(i);
+    const std::string own_b = "test_serializer.b." + std::to_string(i);
+    if (i % 2 == 0) {
+      ASSERT_EQ(Receive(client_a, Serializer::Serialize(stream_a, samples, {shared}, mask)), shared);
+      ASSERT_EQ(Receive(client_b, Serializer::Serialize(stream_b, samples, {shared}, mask)), shared);
+    } else {
+      ASSERT_EQ(Receive(client_b, Serializer::Serialize(stream_b, samples, {shared}, mask)), shared);
+      ASSERT_EQ(Receive(client_a, Serializer::Serialize(stream_a, samples, {shared}, mask)), shared);
+    }
+    ASSERT_EQ(Receive(client_a, Serializer::Serialize(stream_a, samples, {own_a}, mask)), own_a);
+    ASSERT_EQ(Receive(client_b, Serializer::Serialize(stream_b, samples, {own_b}, mask)), own_b);
+    // and at an actor the other sensor saw before
+    ASSERT_EQ(Receive(client_a, Serializer::Serialize(stream_a, samples, {own_b}, mask)), own_b);
+    ASSERT_EQ(Receive(client_b, Serializer::Serialize(stream_b, samples, {own_a}, mask)), own_a);
+  }
+}
@@ -32,6 +32,9 @@
 #include <vector>
 #include <algorithm>
 #include <thread>
+#include <cstddef>
+#include <string>
+#include <utility>
 
 namespace carla {
 namespace sensor {
@@ -169,19 +172,23 @@ namespace data {
 
   std::ostream &operator<<(std::ostream &out, const DReyeVREvent &event) {
     // what is used when printing the data streamed to the PythonAPI (converting to string)
-    auto &GazeDir = event.GetGazeDir();
-    auto &GazeOrigin = event.GetGazeOrigin();
-    auto &CameraLocn = event.GetCameraLocation();
-    auto &CameraRotn = event.GetCameraRotation();
     const std::string sep = ", ";
     out << "DReyeVR(frame=" << event.GetFrame() << sep
-        << "t=" << event.GetTimestamp() << sep
-        << "GazeDir(" << event.GetGazeValid() << ")={" << GazeDir.x << ", " << GazeDir.y << ", " << GazeDir.z<< "}" << sep
-        << "GazeOrigin={" << GazeOrigin.x << ", " << GazeOrigin.y << ", " << GazeOrigin.z << "}" << sep
-        << "Vergence=" << event.GetGazeVergence() << sep
-        << "CameraLoc={" << CameraLocn.x << ", " << CameraLocn.y << ", " << CameraLocn.z<< "}" << sep
-        << "CameraRot={" << CameraRotn.x << ", " << CameraRotn.y << ", " << CameraRotn.z<< "}" << sep
-        << ')';
+        << "t=" << event.GetTimestamp() << sep;
+    if (event.HasFields(s11n::DReyeVRSerializer::Gaze)) {
+      auto &GazeDir = event.GetGazeDir();
+      auto &GazeOrigin = event.GetGazeOrigin();
+      out << "GazeDir(" << event.GetGazeValid() << ")={" << GazeDir.x << ", " << GazeDir.y << ", " << GazeDir.z<< "}" << sep
+          << "GazeOrigin={" << GazeOrigin.x << ", " << GazeOrigin.y << ", " << GazeOrigin.z << "}" << sep
+          << "Vergence=" << event.GetGazeVergence() << sep;
+    }
+    if (event.HasFields(s11n::DReyeVRSerializer::Camera)) {
+      auto &CameraLocn = event.GetCameraLocation();
+      auto &CameraRotn = event.GetCameraRotation();
+      out << "CameraLoc={" << CameraLocn.x << ", " << CameraLocn.y << ", " << CameraLocn.z<< "}" << sep
+          << "CameraRot={" << CameraRotn.x << ", " << CameraRotn.y << ", " << CameraRotn.z<< "}" << sep;
+    }
+    out << ')';
     return out;
   }
 } // namespace s11n
@@ -207,6 +214,126 @@ static auto GetRawDataAsBuffer(T &self) {
   return boost::python::object(boost::python::handle<>(ptr));
 }
 
+// the records of a DReyeVR event in place, for np.frombuffer(event.raw_samples, dtype=np.dtype(event.sample_dtype))
+static auto GetDReyeVRSamplesAsBuffer(const carla::sensor::data::DReyeVREvent &self) {
+  auto *data = reinterpret_cast<const char *>(self.GetRecords());
+  auto size = static_cast<Py_ssize_t>(self.GetRecordSize() * self.GetNumSamples());
+#if PY_MAJOR_VERSION >= 3
+  auto *ptr = PyMemoryView_FromMemory(const_cast<char *>(data), size, PyBUF_READ);
+#else
+  auto *ptr = PyBuffer_FromMemory(const_cast<char *>(data), size);
+#endif
+  return boost::python::object(boost::python::handle<>(ptr));
+}
+
+// numpy structured dtype (as accepted by np.dtype) of the records of a DReyeVR event, i.e. of the groups in its field
+// mask, with the names of the properties below
+static boost::python::dict GetDReyeVRSampleDtype(const carla::sensor::data::DReyeVREvent &self) {
+  using S = carla::sensor::s11n::DReyeVRSerializer;
+  static_assert(sizeof(bool) == 1 && sizeof(carla::geom::Vector3D) == 3 * sizeof(float) &&
+                sizeof(carla::geom::Vector2D) == 2 * sizeof(float), "unexpected DReyeVR record layout");
+  const uint32_t mask = self.GetFieldMask();
+  boost::python::list names, formats, offsets;
+  size_t base = 0;
+  auto Add = [&](const char *name, const char *format, size_t offset) {
+    names.append(name);
+    formats.append(format);
+    offsets.append(base + offset);
+  };
+  auto Group = [&](S::Field group) {
+    base = S::GroupOffset(mask, group);
+    return (mask & group) != 0;
+  };
+  if (Group(S::Timestamps)) {
+    Add("timestamp_carla", "i8", offsetof(S::TimestampsData, TimestampCarla));
+    Add("timestamp_device", "i8", offsetof(S::TimestampsData, TimestampDevice));
+    Add("framesequence", "i8", offsetof(S::TimestampsData, FrameSequence));
+  }
+  if (Group(S::Camera)) {
+    Add("camera_location", "(3,)f4", offsetof(S::CameraData, CameraLocation));
+    Add("camera_rotation", "(3,)f4", offsetof(S::CameraData, CameraRotation));
+  }
+  if (Group(S::Gaze)) {
+    Add("gaze_dir", "(3,)f4", offsetof(S::GazeData, GazeDir));
+    Add("gaze_origin", "(3,)f4", offsetof(S::GazeData, GazeOrigin));
+    Add("gaze_vergence", "f4", offsetof(S::GazeData, GazeVergence));
+    Add("gaze_valid", "?", offsetof(S::GazeData, GazeValid));
+  }
+  const std::pair<S::Field, std::string> eyes[] = {{S::LeftEye, "left_"}, {S::RightEye, "right_"}};
+  for (const auto &eye : eyes) {
+    if (!Group(eye.first))
+      continue;
+    Add((eye.second + "gaze_dir").c_str(), "(3,)f4", offsetof(S::EyeData, GazeDir));
+    Add((eye.second + "gaze_origin").c_str(), "(3,)f4", offsetof(S::EyeData, GazeOrigin));
+    Add((eye.second + "eye_openness").c_str(), "f4", offsetof(S::EyeData, EyeOpenness));
+    Add((eye.second + "pupil_posn").c_str(), "(2,)f4", offsetof(S::EyeData, PupilPos));
+    Add((eye.second + "pupil_diam").c_str(), "f4", offsetof(S::EyeData, PupilDiameter));
+    Add((eye.second + "gaze_valid").c_str(), "?", offsetof(S::EyeData, GazeValid));
+    Add((eye.second + "eye_openness_valid").c_str(), "?", offsetof(S::EyeData, EyeOpenValid));
+    Add((eye.second + "pupil_posn_valid").c_str(), "?", offsetof(S::EyeData, PupilPosValid));
+  }
+  if (Group(S::Focus)) {
+    Add("focus_actor_pt", "(3,)f4", offsetof(S::FocusData, FocusActorPoint));
+    Add("focus_actor_dist", "f4", offsetof(S::FocusData, FocusActorDist));
+    Add("focus_actor_name", "u4", offsetof(S::FocusData, FocusActorName)); // id, see DReyeVREvent.lookup_string
+  }
+  if (Group(S::Inputs)) {
+    Add("throttle_input", "f4", offsetof(S::InputsData, Throttle));
+    Add("steering_input", "f4", offsetof(S::InputsData, Steering));
+    Add("brake_input", "f4", offsetof(S::InputsData, Brake));
+    Add("current_gear_input", "?", offsetof(S::InputsData, ToggledReverse));
+    Add("handbrake_input", "?", offsetof(S::InputsData, HoldHandbrake));
+  }
+  static_assert(S::MaxAttentionActors == 4, "update the attention formats");
+  if (Group(S::Attention)) {
+    Add("attention_actor_name", "(4,)u4", offsetof(S::AttentionData, ActorName)); // ids, see lookup_string
+    Add("attention_weight", "(4,)f4", offsetof(S::AttentionData, Weight));
+  }
+  static_assert(S::MaxGazeEvents == 3, "update the gaze event formats");
+  if (Group(S::GazeEvents)) {
+    Add("gaze_event_timestamp", "(3,)i8", offsetof(S::GazeEventsData, TimestampDevice));
+    Add("gaze_event_centroid", "(3,3)f4", offsetof(S::GazeEventsData, Centroid));
+    Add("gaze_event_duration", "(3,)f4", offsetof(S::GazeEventsData, DurationMs));
+    Add("gaze_event_amplitude", "(3,)f4", offsetof(S::GazeEventsData, Amplitude));
+    Add("gaze_event_peak_velocity", "(3,)f4", offsetof(S::GazeEventsData, PeakVelocity));
+    Add("gaze_event_type", "(3,)u1", offsetof(S::GazeEventsData, Type)); // 0: unused, see DReyeVR::GazeEventType
+  }
+  boost::python::dict dtype;
+  dtype["names"] = names;
+  dtype["formats"] = formats;
+  dtype["offsets"] = offsets;
+  dtype["itemsize"] = self.GetRecordSize();
+  return dtype;
+}
+
+// (actor name, weight) of the actors in the gaze cone of the latest sample, largest weight first
+static boost::python::list GetDReyeVRAttention(const carla::sensor::data::DReyeVREvent &self) {
+  boost::python::list result;
+  for (size_t i = 0u; i < carla::sensor::s11n::DReyeVRSerializer::MaxAttentionActors; ++i) {
+    const float weight = self.GetAttentionWeight(i);
+    if (weight > 0.0f) {
+      result.append(boost::python::make_tuple(self.GetAttentionActorName(i), weight));
+    }
+  }
+  return result;
+}
+
+// (type, timestamp_device, duration_ms, centroid, amplitude, peak_velocity) of the fixations/saccades detected in all
+// the samples of the event, oldest first
+static boost::python::list GetDReyeVRGazeEvents(const carla::sensor::data::DReyeVREvent &self) {
+  static const char *types[] = {"none", "fixation_start", "fixation_end", "saccade"};
+  boost::python::list result;
+  for (const auto &e : self.GetGazeEvents()) {
+    result.append(boost::python::make_tuple(types[e.Type < 4u ? e.Type : 0u], e.TimestampDevice, e.DurationMs,
+                                            e.Centroid, e.Amplitude, e.PeakVelocity));
+  }
+  return result;
+}
+
+static bool DReyeVRHasFields(const carla::sensor::data::DReyeVREvent &self, const std::string &fields) {
+  return self.HasFields(carla::sensor::s11n::DReyeVRSerializer::ParseFieldMask(fields));
+}
+
 template <typename T>
 static void ConvertImage(T &self, EColorConverter cc) {
   carla::PythonUtil::ReleaseGIL unlock;
@@ -614,6 +741,20 @@ void export_sensor_data() {
       .add_property("brake_input", CALL_RETURNING_COPY(csd::DReyeVREvent, GetBrake))
       .add_property("current_gear_input", CALL_RETURNING_COPY(csd::DReyeVREvent, GetToggledReverse))
       .add_property("handbrake_input", CALL_RETURNING_COPY(csd::DReyeVREvent, GetHandbrake))
+      // attention weights of the gaze cone
+      .add_property("attention", &GetDReyeVRAttention)
+      // fixations/saccades of every sample of the event
+      .add_property("gaze_events", &GetDReyeVRGazeEvents)
+      // every sample of the (batched) event, the properties above are the ones of the latest sample
+      .add_property("num_samples", CALL_RETURNING_COPY(csd::DReyeVREvent, GetNumSamples))
+      .add_property("raw_samples", &GetDReyeVRSamplesAsBuffer)
+      .add_property("sample_dtype", &GetDReyeVRSampleDtype)
+      // field groups streamed by the sensor (see its stream_fields attribute)
+      .add_property("field_mask", CALL_RETURNING_COPY(csd::DReyeVREvent, GetFieldMask))
+      .def("has_fields", &DReyeVRHasFields, (arg("fields")))
+      .def("lookup_string", &cs::s11n::DReyeVRSerializer::LookupString)
+      .staticmethod("lookup_string")
+      .def("__len__", &csd::DReyeVREvent::GetNumSamples)
       .def(self_ns::str(self_ns::self))
   ;
 }
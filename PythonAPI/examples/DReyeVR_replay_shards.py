@@ -0,0 +1,209 @@
+#!/usr/bin/env python
+
+"""Render the frame capture of one recording with several local simulator processes at once.
+
+The recording is split into --shards time ranges of (about) the same length, one headless simulator is launched per
+shard (on its own port, see --port and --port-step) and each one replays only its range in synchronized mode
+(ReplayInterpolation=False, RecordFrames=True) into its own directory. The processes quit once their range is done
+(ExitAfterReplay=True) and their outputs are merged into --out:
+- the screenshots are numbered by the index of their frame in the recording, so they are only moved
+- the videos (FrameSink="video") of each shader & pose are concatenated (with ffmpeg, without re-encoding) and their
+  .csv renumbered
+
+These settings are given to each process on its command line (-DReyeVR:Section/Variable=Value), the rest of the frame
+capture settings (shaders, poses, resolution, sink, ...) are read from DReyeVRConfig.ini as usual."""
+
+import argparse
+import csv
+import glob
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+from typing import Dict, List, Tuple
+
+try:
+    sys.path.append(
+        glob.glob(
+            "../carla/dist/carla-*%d.%d-%s.egg"
+            % (
+                sys.version_info.major,
+                sys.version_info.minor,
+                "win-amd64" if os.name == "nt" else "linux-x86_64",
+            )
+        )[0]
+    )
+except IndexError:
+    pass
+
+import carla
+
+VIDEO_EXTENSIONS = (".mp4", ".mkv")
+FRAME_RE = re.compile(r"_s\d+_p\d+_(\d+)\.\w+$")  # {FrameName}_s{shader}_p{pose}_{frame}.jpg (or .png)
+
+
+def launch_simulator(args: argparse.Namespace, shard: int, out_dir: str) -> subprocess.Popen:
+    cmd = [
+        args.carla,
+        f"-carla-rpc-port={args.port + shard * args.port_step}",
+        "-nosound",
+        "-DReyeVR:Replayer/ReplayInterpolation=False",
+        "-DReyeVR:Replayer/RecordFrames=True",
+        "-DReyeVR:Replayer/ExitAfterReplay=True",
+        f'-DReyeVR:Replayer/FrameDir="{out_dir}"',
+    ]
+    if not args.onscreen:
+        cmd.append("-RenderOffScreen")
+    if args.gpus:
+        gpus = args.gpus.split(",")
+        cmd.append(f"-graphicsadapter={gpus[shard % len(gpus)]}")
+    cmd += args.extra
+    log = open(os.path.join(out_dir, "simulator.log"), "w")
+    return subprocess.Popen(cmd, stdout=log, stderr=subprocess.STDOUT)
+
+
+def connect(args: argparse.Namespace, shard: int, proc: subprocess.Popen) -> carla.Client:
+    client = carla.Client(args.host, args.port + shard * args.port_step)
+    client.set_timeout(5.0)
+    deadline = time.time() + args.startup_timeout
+    while True:
+        if proc.poll() is not None:
+            raise RuntimeError(f"simulator of shard {shard} exited ({proc.returncode}) before accepting connections")
+        try:
+            client.get_server_version()
+            return client
+        except RuntimeError:
+            if time.time() > deadline:
+                raise
+            time.sleep(2.0)
+
+
+def recording_duration(client: carla.Client, recording: str) -> float:
+    info = client.show_recorder_file_info(recording, False)
+    match = re.search(r"Duration: ([0-9.eE+-]+) seconds", info)
+    if match is None:
+        raise RuntimeError(f'unable to read the duration of "{recording}":\n{info}')
+    return float(match.group(1))
+
+
+def capture_dir(shard_dir: str) -> str:
+    # the sensor writes to a timestamped directory inside its FrameDir
+    dirs = [d for d in glob.glob(os.path.join(shard_dir, "*")) if os.path.isdir(d)]
+    if len(dirs) != 1:
+        raise RuntimeError(f'expected one capture directory in "{shard_dir}", found {len(dirs)}')
+    return dirs[0]
+
+
+def merge_videos(videos: Dict[str, List[Tuple[str, str]]], out: str) -> None:
+    for name, parts in videos.items():
+        video_path, csv_path = os.path.join(out, name), os.path.join(out, os.path.splitext(name)[0] + ".csv")
+        list_path = os.path.join(out, name + ".txt")
+        with open(list_path, "w") as f:
+            for video, _ in parts:
+                f.write("file '%s'\n" % os.path.abspath(video).replace("'", "'\\''"))
+        concat = ["ffmpeg", "-y", "-loglevel", "error", "-f", "concat", "-safe", "0", "-i", list_path]
+        subprocess.run(concat + ["-c", "copy", video_path], check=True)
+        os.remove(list_path)
+
+        # the video frames of each part follow those of the previous parts
+        num_frames = 0
+        with open(csv_path, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(["video_frame", "recorder_frame", "tick", "timestamp_carla"])
+            for _, index in parts:
+                with open(index, newline="") as part:
+                    rows = list(csv.DictReader(part))
+                for row in rows:
+                    video_frame = int(row["video_frame"]) + num_frames
+                    writer.writerow([video_frame, row["recorder_frame"], row["tick"], row["timestamp_carla"]])
+                num_frames += len(rows)
+
+
+def merge(shard_dirs: List[str], out: str) -> List[int]:
+    videos: Dict[str, List[Tuple[str, str]]] = {}
+    frames = set()
+    for shard_dir in shard_dirs:
+        src = capture_dir(shard_dir)
+        for path in sorted(glob.glob(os.path.join(src, "*"))):
+            name = os.path.basename(path)
+            ext = os.path.splitext(name)[1]
+            if ext in VIDEO_EXTENSIONS:
+                videos.setdefault(name, []).append((path, os.path.splitext(path)[0] + ".csv"))
+            elif ext != ".csv":
+                match = FRAME_RE.search(name)
+                if match is not None:
+                    frames.add(int(match.group(1)))
+                shutil.move(path, os.path.join(out, name))
+    merge_videos(videos, out)
+    for _, parts in videos.items():
+        for _, index in parts:
+            with open(index, newline="") as f:
+                frames.update(int(row["tick"]) for row in csv.DictReader(f))
+    return sorted(frames)
+
+
+def main():
+    argparser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    argparser.add_argument("-f", "--recorder-filename", required=True, help="recording to capture (as for replay_file)")
+    argparser.add_argument("-c", "--carla", required=True, help="simulator executable (CarlaUE4.sh or CarlaUE4.exe)")
+    argparser.add_argument("-o", "--out", required=True, help="directory of the merged frame capture")
+    argparser.add_argument("-n", "--shards", default=4, type=int, help="simulator processes (default: 4)")
+    argparser.add_argument("--host", default="127.0.0.1", help="IP of the simulators (default: 127.0.0.1)")
+    argparser.add_argument("-p", "--port", default=2000, type=int, help="RPC port of the first shard (default: 2000)")
+    argparser.add_argument(
+        "--port-step", default=4, type=int, help="port distance between the shards (each uses 3 ports, default: 4)"
+    )
+    argparser.add_argument("--gpus", default="", help="comma-separated GPU indices to spread the shards over")
+    argparser.add_argument("--onscreen", action="store_true", help="do not pass -RenderOffScreen")
+    argparser.add_argument(
+        "--startup-timeout", default=300.0, type=float, help="seconds to wait for a simulator to start (default: 300)"
+    )
+    argparser.add_argument("--keep-shards", action="store_true", help="keep the per-shard directories")
+    argparser.add_argument("extra", nargs=argparse.REMAINDER, help="additional simulator arguments (after --)")
+    args = argparser.parse_args()
+    args.extra = [a for a in args.extra if a != "--"]
+
+    out = os.path.abspath(args.out)
+    os.makedirs(out, exist_ok=True)
+    shard_dirs = [os.path.join(out, f"shard_{k:02d}") for k in range(args.shards)]
+    for shard_dir in shard_dirs:
+        os.makedirs(shard_dir, exist_ok=True)
+
+    procs = [launch_simulator(args, k, shard_dirs[k]) for k in range(args.shards)]
+    try:
+        clients = [connect(args, k, proc) for k, proc in enumerate(procs)]
+        duration = recording_duration(clients[0], args.recorder_filename)
+        print(f"Replaying {duration:.2f}s of {args.recorder_filename} in {args.shards} shards")
+
+        # shard k replays the frames starting in [k, k + 1) * duration / shards (the last one up to the end)
+        bounds = [duration * k / args.shards for k in range(args.shards + 1)]
+        for k, client in enumerate(clients):
+            shard_duration = bounds[k + 1] - bounds[k] if k < args.shards - 1 else 0.0
+            print(client.replay_file(args.recorder_filename, bounds[k], shard_duration, 0))
+
+        t_start = time.time()
+        for k, proc in enumerate(procs):
+            proc.wait()
+            print(f"Shard {k} done ({proc.returncode}) after {time.time() - t_start:.1f}s")
+    finally:
+        for proc in procs:
+            if proc.poll() is None:
+                proc.terminate()
+
+    frames = merge(shard_dirs, out)
+    if frames:
+        missing = sorted(set(range(frames[0], frames[-1] + 1)) - set(frames))
+        print(f"Merged frames {frames[0]} to {frames[-1]} into {out}")
+        if missing:
+            print(f"WARNING: {len(missing)} frames are missing, e.g. {missing[:10]}")
+    else:
+        print("WARNING: no frames were captured")
+    if not args.keep_shards:
+        for shard_dir in shard_dirs:
+            shutil.rmtree(shard_dir, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    main()
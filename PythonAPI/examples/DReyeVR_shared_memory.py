@@ -0,0 +1,202 @@
+#!/usr/bin/env python
+
+"""Read the DReyeVR sensor messages from the local shared memory (SharedMemoryName under [EgoSensor] in
+DReyeVRConfig.ini) without going through the carla client/streaming stack.
+
+The layouts below mirror LibCarla/source/carla/sensor/DReyeVRSharedMemory.h (the ring of seqlock slots) and
+LibCarla/source/carla/sensor/s11n/DReyeVRSerializer.h (the messages), update them together."""
+
+import argparse
+import mmap
+import os
+import struct
+import time
+from typing import Dict, Iterator, List, Optional, Tuple
+
+import numpy as np
+
+SHM_MAGIC = 0x52565244  # "DRVR"
+SHM_VERSION = 1
+SHM_HEADER_SIZE = 64  # magic, version, num_slots, slot_size, head (u64 @16), dropped (u64 @24)
+SLOT_HEADER_SIZE = 16  # seq (u64), size (u32)
+
+MSG_VERSION = 6
+MSG_HEADER = struct.Struct("<IIII")  # version, num_samples, num_strings, field_mask
+STRING_ENTRY = struct.Struct("<IH")  # id, length (followed by the name)
+
+# field groups of the records, in the order of their bits: (bit, size, fields as (name, format, offset))
+_EYE_FIELDS = [
+    ("gaze_dir", "(3,)f4", 0),
+    ("gaze_origin", "(3,)f4", 12),
+    ("eye_openness", "f4", 24),
+    ("pupil_posn", "(2,)f4", 28),
+    ("pupil_diam", "f4", 36),
+    ("gaze_valid", "?", 40),
+    ("eye_openness_valid", "?", 41),
+    ("pupil_posn_valid", "?", 42),
+]
+GROUPS: List[Tuple[int, int, List[Tuple[str, str, int]]]] = [
+    (1 << 0, 24, [("timestamp_carla", "i8", 0), ("timestamp_device", "i8", 8), ("framesequence", "i8", 16)]),
+    (1 << 1, 24, [("camera_location", "(3,)f4", 0), ("camera_rotation", "(3,)f4", 12)]),
+    (
+        1 << 2,
+        32,
+        [("gaze_dir", "(3,)f4", 0), ("gaze_origin", "(3,)f4", 12), ("gaze_vergence", "f4", 24), ("gaze_valid", "?", 28)],
+    ),
+    (1 << 3, 48, [("left_" + n, f, o) for n, f, o in _EYE_FIELDS]),
+    (1 << 4, 48, [("right_" + n, f, o) for n, f, o in _EYE_FIELDS]),
+    (1 << 5, 24, [("focus_actor_pt", "(3,)f4", 0), ("focus_actor_dist", "f4", 12), ("focus_actor_name", "u4", 16)]),
+    (
+        1 << 6,
+        16,
+        [
+            ("throttle_input", "f4", 0),
+            ("steering_input", "f4", 4),
+            ("brake_input", "f4", 8),
+            ("current_gear_input", "?", 12),
+            ("handbrake_input", "?", 13),
+        ],
+    ),
+    (1 << 7, 32, [("attention_actor_name", "(4,)u4", 0), ("attention_weight", "(4,)f4", 16)]),
+    (
+        1 << 8,
+        104,
+        [
+            ("gaze_event_timestamp", "(3,)i8", 0),
+            ("gaze_event_centroid", "(3,3)f4", 24),
+            ("gaze_event_duration", "(3,)f4", 60),
+            ("gaze_event_amplitude", "(3,)f4", 72),
+            ("gaze_event_peak_velocity", "(3,)f4", 84),
+            ("gaze_event_type", "(3,)u1", 96),
+        ],
+    ),
+]
+
+_dtypes: Dict[int, np.dtype] = {}
+
+
+def sample_dtype(field_mask: int) -> np.dtype:
+    """numpy structured dtype of the records of a message with this field mask (same as DReyeVREvent.sample_dtype)"""
+    if field_mask not in _dtypes:
+        names, formats, offsets = [], [], []
+        base = 0
+        for bit, size, fields in GROUPS:
+            if field_mask & bit:
+                for name, fmt, offset in fields:
+                    names.append(name)
+                    formats.append(fmt)
+                    offsets.append(base + offset)
+                base += size
+        _dtypes[field_mask] = np.dtype({"names": names, "formats": formats, "offsets": offsets, "itemsize": base})
+    return _dtypes[field_mask]
+
+
+class DReyeVRSharedMemoryReader:
+    def __init__(self, name: str):
+        self.name = name
+        self.buf = self._map(name)
+        magic, version, self.num_slots, self.slot_size = struct.unpack_from("<IIII", self.buf, 0)
+        if magic != SHM_MAGIC or version != SHM_VERSION:
+            raise RuntimeError(f'"{name}" is not a DReyeVR shared memory (of version {SHM_VERSION})')
+        self.stride = (SLOT_HEADER_SIZE + self.slot_size + 63) & ~63
+        self.next = self._head()  # from the latest message on
+        self.num_lost = 0
+        self.strings: Dict[int, str] = {}  # interned focus actor names
+
+    @staticmethod
+    def _map(name: str) -> mmap.mmap:
+        if os.name == "nt":
+            # map the header first to get the size of the whole segment
+            header = mmap.mmap(-1, SHM_HEADER_SIZE, tagname=name, access=mmap.ACCESS_READ)
+            num_slots, slot_size = struct.unpack_from("<II", header, 8)
+            header.close()
+            size = SHM_HEADER_SIZE + num_slots * ((SLOT_HEADER_SIZE + slot_size + 63) & ~63)
+            return mmap.mmap(-1, size, tagname=name, access=mmap.ACCESS_READ)
+        with open(os.path.join("/dev/shm", name), "rb") as f:
+            return mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+
+    def _head(self) -> int:
+        return struct.unpack_from("<Q", self.buf, 16)[0]
+
+    def dropped(self) -> int:
+        # messages that were too large for the slots (see SharedMemorySlotSize)
+        return struct.unpack_from("<Q", self.buf, 24)[0]
+
+    def read_message(self) -> Optional[bytes]:
+        """The next raw message (or None if there is no new one yet)"""
+        while True:
+            head = self._head()
+            if self.next >= head:
+                return None
+            if head - self.next > self.num_slots:
+                # lapped by the writer
+                self.num_lost += head - self.next - self.num_slots
+                self.next = head - self.num_slots
+            slot = SHM_HEADER_SIZE + (self.next % self.num_slots) * self.stride
+            seq, size = struct.unpack_from("<QI", self.buf, slot)
+            if seq == 2 * self.next + 2:
+                data = self.buf[slot + SLOT_HEADER_SIZE : slot + SLOT_HEADER_SIZE + min(size, self.slot_size)]
+                if struct.unpack_from("<Q", self.buf, slot)[0] == seq:
+                    self.next += 1
+                    return data
+            # overwritten (or being overwritten) by a newer message
+            self.num_lost += 1
+            self.next += 1
+
+    def read(self) -> Optional[np.ndarray]:
+        """Every sample of the next message as a numpy structured array (or None if there is no new one yet)"""
+        data = self.read_message()
+        if data is None:
+            return None
+        version, num_samples, num_strings, field_mask = MSG_HEADER.unpack_from(data, 0)
+        if version != MSG_VERSION:
+            raise RuntimeError(f"DReyeVR message of version {version} (expected {MSG_VERSION})")
+        dtype = sample_dtype(field_mask)
+        samples = np.frombuffer(data, dtype=dtype, count=num_samples, offset=MSG_HEADER.size)
+        offset = MSG_HEADER.size + num_samples * dtype.itemsize
+        for _ in range(num_strings):
+            string_id, length = STRING_ENTRY.unpack_from(data, offset)
+            offset += STRING_ENTRY.size
+            self.strings[string_id] = data[offset : offset + length].decode("utf-8", errors="replace")
+            offset += length
+        return samples
+
+    def __iter__(self) -> Iterator[np.ndarray]:
+        # polls for new messages forever
+        while True:
+            samples = self.read()
+            if samples is None:
+                time.sleep(0)  # yield, the messages come at the tick (or eye tracker) rate
+                continue
+            yield samples
+
+    def lookup_string(self, string_id: int) -> str:
+        return self.strings.get(string_id, "")
+
+    def close(self) -> None:
+        self.buf.close()
+
+
+def main():
+    argparser = argparse.ArgumentParser(description=__doc__)
+    argparser.add_argument(
+        "-n",
+        "--name",
+        default="dreyevr",
+        help="name of the shared memory (SharedMemoryName in DReyeVRConfig.ini) (default: dreyevr)",
+    )
+    args = argparser.parse_args()
+
+    reader = DReyeVRSharedMemoryReader(args.name)
+    for samples in reader:
+        for sample in samples:
+            print({key: sample[key] for key in samples.dtype.names})
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        print("\ndone.")
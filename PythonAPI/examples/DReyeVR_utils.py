@@ -48,10 +48,25 @@ def find_ego_sensor(world: carla.libcarla.World) -> Optional[carla.libcarla.Sens
     return sensor
 
 
+_sample_dtypes: Dict[int, np.dtype] = {}  # by field mask
+
+
+def samples_as_numpy(event: carla.libcarla.DReyeVREvent) -> np.ndarray:
+    """Every sample of a (possibly batched) DReyeVR event as a numpy structured array, without copying.
+    The array is a view over the event's buffer, so keep the event alive while using it (or copy the array).
+    Only the fields streamed by the sensor (see its stream_fields attribute) are in the array"""
+    mask: int = event.field_mask
+    if mask not in _sample_dtypes:
+        _sample_dtypes[mask] = np.dtype(event.sample_dtype)
+    return np.frombuffer(event.raw_samples, dtype=_sample_dtypes[mask])
+
+
 class DReyeVRSensor:
     def __init__(self, world: carla.libcarla.World):
         self.ego_sensor: carla.sensor.dreyevrsensor = find_ego_sensor(world)
         self.data: Dict[str, Any] = {}
+        self.event: Optional[carla.libcarla.DReyeVREvent] = None
+        self.samples: Optional[np.ndarray] = None  # every sample of the latest event
         print("initialized DReyeVRSensor PythonAPI client")
 
     def preprocess(self, obj: Any) -> Any:
@@ -67,10 +82,27 @@ class DReyeVRSensor:
         return obj
 
     def update(self, data) -> None:
-        # update local variables
-        elements: List[str] = [key for key in dir(data) if "__" not in key]
-        for key in elements:
-            self.data[key] = self.preprocess(getattr(data, key))
+        # update local variables (one numpy view per event, not one getter call per field)
+        self.event = data  # keeps the buffer behind self.samples alive
+        self.samples = samples_as_numpy(data)
+        latest = self.samples[-1]
+        self.data = {key: latest[key] for key in self.samples.dtype.names}
+        if data.has_fields("focus"):
+            self.data["focus_actor_name"] = data.focus_actor_name
+        if data.has_fields("attention"):
+            self.data["attention"] = data.attention  # [(actor name, weight)] of the gaze cone
+        if data.has_fields("gaze_events"):
+            self.data["gaze_events"] = data.gaze_events  # fixations/saccades of every sample of the event
+        self.data["timestamp_stream"] = data.timestamp_stream
+        self.data["frame"] = data.frame
+        self.data["num_samples"] = len(self.samples)
+
+    def focus_actor_names(self) -> List[str]:
+        # names of the focus actors of every sample of the latest event
+        assert self.samples is not None
+        ids, inverse = np.unique(self.samples["focus_actor_name"], return_inverse=True)
+        names = [carla.libcarla.DReyeVREvent.lookup_string(int(i)) for i in ids]
+        return [names[i] for i in inverse]
 
     @classmethod
     def spawn(cls, world: carla.libcarla.World):
@@ -125,3 +157,26 @@ class DReyeVRSensor:
         FinalRay = ptM - oM  # Combined ray between midpoints of endpoints
         # returns the magnitude of the vector (length)
         return np.linalg.norm(FinalRay) / 100.0
+
+
+def load_columnar_recording(path: str, mmap: bool = True) -> Dict[str, Dict[str, np.ndarray]]:
+    """Load the output of the ExportRecording console command (a directory per table with one .npy per column)"""
+    tables: Dict[str, Dict[str, np.ndarray]] = {}
+    for table in sorted(os.listdir(path)):
+        table_dir = os.path.join(path, table)
+        if not os.path.isdir(table_dir):
+            continue
+        columns: Dict[str, np.ndarray] = {}
+        files = sorted(glob.glob(os.path.join(table_dir, "*.npy")))
+        for f in files:
+            name = os.path.splitext(os.path.basename(f))[0]
+            if name.endswith("_names"):
+                continue  # string dictionary, resolved below
+            columns[name] = np.load(f, mmap_mode="r" if mmap else None)
+            names_file = os.path.join(table_dir, f"{name}_names.npy")
+            if os.path.exists(names_file):
+                # dictionary-encoded strings: look up the codes in the (small) names array
+                names = np.load(names_file).astype(str)
+                columns[name] = names[columns[name]] if len(names) > 0 else columns[name]
+        tables[table] = columns
+    return tables